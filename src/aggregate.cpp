@@ -0,0 +1,289 @@
+#include "global.h"
+
+/**
+ * @brief Folds one value into the running state of an aggregate function.
+ *
+ * @param state
+ * @param aggregate
+ * @param value
+ */
+void accumulate(AggregateState &state, Aggregate aggregate, int value)
+{
+    if (state.count == 0)
+        state.result = (aggregate == COUNT) ? 0 : value;
+    else if (aggregate == MIN)
+        state.result = min(state.result, (long long)value);
+    else if (aggregate == MAX)
+        state.result = max(state.result, (long long)value);
+    else if (aggregate == SUM || aggregate == AVG)
+        state.result += value;
+    state.count++;
+}
+
+/**
+ * @brief Folds a partial aggregate state (e.g. of the same group from another
+ * run) into into.
+ *
+ * @param into
+ * @param state
+ * @param aggregate
+ */
+void mergeAggregateState(AggregateState &into, const AggregateState &state, Aggregate aggregate)
+{
+    if (state.count == 0)
+        return;
+    if (into.count == 0)
+        into.result = state.result;
+    else if (aggregate == MIN)
+        into.result = min(into.result, state.result);
+    else if (aggregate == MAX)
+        into.result = max(into.result, state.result);
+    else if (aggregate == SUM || aggregate == AVG)
+        into.result += state.result;
+    into.count += state.count;
+}
+
+/**
+ * @brief Returns the final value of an aggregate once all rows of the group have
+ * been accumulated. AVG uses integer division like the rest of the system.
+ *
+ * @param state
+ * @param aggregate
+ * @return long long
+ */
+long long finalizeAggregate(const AggregateState &state, Aggregate aggregate)
+{
+    if (aggregate == COUNT)
+        return state.count;
+    if (aggregate == AVG)
+        return state.count ? state.result / state.count : 0;
+    return state.result;
+}
+
+/**
+ * @brief Tables only hold ints, so a finalized aggregate that doesn't fit (a
+ * SUM over a large group) saturates at the int range when it is written out.
+ *
+ * @param value
+ * @return int
+ */
+int narrowAggregate(long long value)
+{
+    if (value > INT_MAX)
+        return INT_MAX;
+    if (value < INT_MIN)
+        return INT_MIN;
+    return (int)value;
+}
+
+/**
+ * @brief Pages only hold ints, so a partial state written to disk is split
+ * into the high and low halves of its result and count.
+ *
+ * @param state
+ * @param columns PACKED_STATE_WIDTH ints
+ */
+void packAggregateState(const AggregateState &state, int *columns)
+{
+    columns[0] = (int)(state.result >> 32);
+    columns[1] = (int)(uint)state.result;
+    columns[2] = (int)(state.count >> 32);
+    columns[3] = (int)(uint)state.count;
+}
+
+AggregateState unpackAggregateState(const int *columns)
+{
+    AggregateState state;
+    state.result = (long long)(((unsigned long long)(uint)columns[0] << 32) | (uint)columns[1]);
+    state.count = (long long)(((unsigned long long)(uint)columns[2] << 32) | (uint)columns[3]);
+    return state;
+}
+
+/**
+ * @brief Mixes the bits of a composite grouping key (murmur3 finaliser per
+ * column). The seed lets every level of recursive partitioning use an
+ * independent hash function.
+ *
+ * @param key
+ * @param keyWidth
+ * @param seed
+ * @return uint
+ */
+uint hashGroupKey(const int *key, uint keyWidth, uint seed)
+{
+    uint hash = seed * 0x9e3779b9u;
+    for (uint column = 0; column < keyWidth; column++)
+    {
+        hash ^= (uint)key[column];
+        hash ^= hash >> 16;
+        hash *= 0x85ebca6bu;
+        hash ^= hash >> 13;
+        hash *= 0xc2b2ae35u;
+        hash ^= hash >> 16;
+    }
+    return hash;
+}
+
+/**
+ * @brief Number of partitions hash aggregation spills to. Hash aggregation
+ * gets the same SORT_BUFFER_BLOCKS blocks of memory as sort aggregation, one
+ * of which holds the page being written of every partition.
+ *
+ * @return uint
+ */
+uint getHashPartitionCount()
+{
+    return max(2u, SORT_BUFFER_BLOCKS / 2);
+}
+
+/**
+ * @brief Number of groups whose keys and accumulators fit in the blocks of the
+ * sort buffer not taken by the pages of the spill partitions.
+ *
+ * @param keyWidth
+ * @param stateWidth
+ * @return uint
+ */
+uint maxGroupsInBuffer(uint keyWidth, uint stateWidth)
+{
+    uint blocks = SORT_BUFFER_BLOCKS > getHashPartitionCount() ? SORT_BUFFER_BLOCKS - getHashPartitionCount() : 1;
+    uint budget = (uint)(blocks * BLOCK_SIZE * 1000);
+    uint entrySize = keyWidth * sizeof(int) + stateWidth * sizeof(AggregateState) + 1;
+    return max(1u, budget / entrySize);
+}
+
+GroupHashTable::GroupHashTable(uint maxGroups, uint keyWidth, uint stateWidth, uint seed)
+{
+    logger.log("GroupHashTable::GroupHashTable");
+    this->maxGroups = maxGroups;
+    this->keyWidth = keyWidth;
+    this->stateWidth = stateWidth;
+    this->seed = seed;
+    this->allocate(maxGroups);
+}
+
+/**
+ * @brief Sizes the slot arrays so that groupCount groups stay below a 3/4 load
+ * factor. Existing groups are rehashed into the new slots.
+ *
+ * @param groupCount
+ */
+void GroupHashTable::allocate(uint groupCount)
+{
+    vector<int> oldKeys;
+    vector<AggregateState> oldStates;
+    vector<bool> oldOccupied;
+    oldKeys.swap(this->keys);
+    oldStates.swap(this->states);
+    oldOccupied.swap(this->occupied);
+
+    uint capacity = 2;
+    while (capacity < groupCount + groupCount / 3 + 1)
+        capacity <<= 1;
+    this->mask = capacity - 1;
+    this->keys.assign(capacity * this->keyWidth, 0);
+    this->states.assign(capacity * this->stateWidth, AggregateState());
+    this->occupied.assign(capacity, false);
+    this->groupCount = 0;
+    for (uint slot = 0; slot < oldOccupied.size(); slot++)
+    {
+        if (!oldOccupied[slot])
+            continue;
+        AggregateState *states = this->insert(&oldKeys[slot * this->keyWidth]);
+        copy(oldStates.begin() + slot * this->stateWidth, oldStates.begin() + (slot + 1) * this->stateWidth, states);
+    }
+}
+
+/**
+ * @brief Probes for key and returns the slot holding it, or the empty slot
+ * where it would be inserted.
+ *
+ * @param key
+ * @return uint
+ */
+uint GroupHashTable::findSlot(const int *key)
+{
+    uint slot = hashGroupKey(key, this->keyWidth, this->seed) & this->mask;
+    while (this->occupied[slot])
+    {
+        if (equal(key, key + this->keyWidth, this->keys.begin() + slot * this->keyWidth))
+            return slot;
+        slot = (slot + 1) & this->mask;
+    }
+    return slot;
+}
+
+/**
+ * @brief Looks up the accumulators of a group.
+ *
+ * @param key keyWidth grouping values
+ * @return AggregateState* stateWidth states, nullptr if the group is not in
+ * the table
+ */
+AggregateState *GroupHashTable::find(const int *key)
+{
+    uint slot = this->findSlot(key);
+    if (!this->occupied[slot])
+        return nullptr;
+    return &this->states[slot * this->stateWidth];
+}
+
+/**
+ * @brief Adds a new, empty group. The caller must check find() first and
+ * should check isFull() if it wants to stay within the buffer budget.
+ *
+ * @param key keyWidth grouping values
+ * @return AggregateState* stateWidth states
+ */
+AggregateState *GroupHashTable::insert(const int *key)
+{
+    if (this->groupCount >= this->maxGroups)
+    {
+        this->maxGroups *= 2;
+        this->allocate(this->maxGroups);
+    }
+    uint slot = this->findSlot(key);
+    this->occupied[slot] = true;
+    copy(key, key + this->keyWidth, this->keys.begin() + slot * this->keyWidth);
+    this->groupCount++;
+    return &this->states[slot * this->stateWidth];
+}
+
+bool GroupHashTable::isFull()
+{
+    return this->groupCount >= this->maxGroups;
+}
+
+uint GroupHashTable::size()
+{
+    return this->groupCount;
+}
+
+/**
+ * @brief Returns the occupied slots ordered by grouping key, so the groups
+ * held in memory are emitted in key order.
+ *
+ * @return vector<uint>
+ */
+vector<uint> GroupHashTable::getSortedSlots()
+{
+    vector<uint> slots;
+    slots.reserve(this->groupCount);
+    for (uint slot = 0; slot <= this->mask; slot++)
+        if (this->occupied[slot])
+            slots.push_back(slot);
+    sort(slots.begin(), slots.end(), [this](uint a, uint b)
+         { return lexicographical_compare(this->keys.begin() + a * this->keyWidth, this->keys.begin() + (a + 1) * this->keyWidth,
+                                          this->keys.begin() + b * this->keyWidth, this->keys.begin() + (b + 1) * this->keyWidth); });
+    return slots;
+}
+
+const int *GroupHashTable::getKey(uint slot)
+{
+    return &this->keys[slot * this->keyWidth];
+}
+
+AggregateState *GroupHashTable::getStates(uint slot)
+{
+    return &this->states[slot * this->stateWidth];
+}
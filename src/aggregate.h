@@ -0,0 +1,63 @@
+/**
+ * @brief Running state of one aggregate function over a group. Both the
+ * sort-based and the hash-based GROUP BY keep one of these per aggregate and
+ * fold rows into it with accumulate(). Sums and counts are 64-bit so that SUM
+ * and AVG over large groups don't overflow before they are finalized.
+ *
+ */
+struct AggregateState
+{
+    long long result = 0;
+    long long count = 0;
+};
+
+void accumulate(AggregateState &state, Aggregate aggregate, int value);
+void mergeAggregateState(AggregateState &into, const AggregateState &state, Aggregate aggregate);
+long long finalizeAggregate(const AggregateState &state, Aggregate aggregate);
+int narrowAggregate(long long value);
+
+// Number of int columns a partial AggregateState occupies in a page
+const int PACKED_STATE_WIDTH = 4;
+void packAggregateState(const AggregateState &state, int *columns);
+AggregateState unpackAggregateState(const int *columns);
+
+/**
+ * @brief The GroupHashTable is a compact open-addressing (linear probing) hash
+ * table from a composite grouping key to the AggregateStates of its group. Keys
+ * (keyWidth ints) and states (stateWidth AggregateStates) of all groups are
+ * stored in two flat arrays indexed by slot. It is used by the hash aggregation
+ * path of GROUP BY. isFull() reports when the number of groups it was sized for
+ * is reached, so the caller can bound its memory by the buffer budget and spill
+ * rows of new groups to disk partitions instead. Inserting into a full table
+ * still works (the table doubles), which is only done when spilling is no
+ * longer possible.
+ *
+ */
+class GroupHashTable
+{
+    vector<int> keys;
+    vector<AggregateState> states;
+    vector<bool> occupied;
+    uint keyWidth = 1;
+    uint stateWidth = 1;
+    uint mask = 0;
+    uint seed = 0;
+    uint groupCount = 0;
+    uint maxGroups = 0;
+    void allocate(uint groupCount);
+    uint findSlot(const int *key);
+
+public:
+    GroupHashTable(uint maxGroups, uint keyWidth, uint stateWidth, uint seed);
+    AggregateState *find(const int *key);
+    AggregateState *insert(const int *key);
+    bool isFull();
+    uint size();
+    vector<uint> getSortedSlots();
+    const int *getKey(uint slot);
+    AggregateState *getStates(uint slot);
+};
+
+uint hashGroupKey(const int *key, uint keyWidth, uint seed);
+uint getHashPartitionCount();
+uint maxGroupsInBuffer(uint keyWidth, uint stateWidth);
@@ -0,0 +1,336 @@
+#include <bits/stdc++.h>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+/**
+ * @brief Runs the benchmark workloads and compares them with a baseline.
+ *
+ * benchRunner [--repeat N] [--tolerance X] [--update-baseline]
+ *
+ * Run from src. The data of bench/datasets.txt is generated with
+ * bench/dataGenerator into ../data/bench/datasets. Every workload
+ * bench/workloads/NAME.ra is then run --repeat times (default 3) by a fresh
+ * server, fed the file on its standard input. The server runs in a sandbox,
+ * ../data/bench/work, whose ../data is ../data/bench/data, a fresh copy of the
+ * datasets, so the tables and checkpoint of ../data are left alone. The
+ * external sort of the server is limited to SORT_THREADS threads, as its block
+ * I/O depends on the thread count, so that the I/O of the baseline holds on
+ * any machine. Its block I/O is read from the buffer metrics it dumps when it
+ * quits. If there is a
+ * bench/workloads/NAME.expected, its lines must appear in that order in the
+ * output of the workload; every one that doesn't counts as an error.
+ *
+ * The median wall time and the I/O of every workload are written to
+ * ../data/bench/results.json and compared with bench/baseline.json: a
+ * workload regresses if it is more than --tolerance (default 0.5) slower, or
+ * reads or writes more than 5% more pages. The exit status is 1 if any
+ * workload regressed or printed an error. --update-baseline makes the results
+ * the new baseline instead.
+ *
+ * Build and run with `make bench`; `make bench-baseline` updates the baseline.
+ */
+
+static const string BENCH_DIRECTORY = "bench";
+static const string SANDBOX_DIRECTORY = "../data/bench";
+static const double IO_TOLERANCE = 0.05;
+// Threads of the external sort in every workload, whatever the cores
+static const uint SORT_THREADS = 1;
+// Differences in wall time below this are noise, whatever the ratio
+static const double TIME_SLACK_MILLISECONDS = 25;
+
+struct WorkloadResult
+{
+    string name;
+    double wallMilliseconds = 0;
+    long long pagesRead = 0;
+    long long pagesWritten = 0;
+    long long bytesRead = 0;
+    long long bytesWritten = 0;
+    long long hits = 0;
+    long long errors = 0;
+};
+
+static bool runCommand(const string &command)
+{
+    return system(command.c_str()) == 0;
+}
+
+static string quote(const fs::path &path)
+{
+    return "'" + path.string() + "'";
+}
+
+/**
+ * @brief Generates every dataset of datasets.txt into directory.
+ *
+ */
+static bool generateDatasets(const fs::path &directory)
+{
+    ifstream fin(BENCH_DIRECTORY + "/datasets.txt");
+    if (!fin.is_open())
+    {
+        cerr << "Error: Could not open " << BENCH_DIRECTORY << "/datasets.txt" << endl;
+        return false;
+    }
+    fs::remove_all(directory);
+    fs::create_directories(directory);
+    string line;
+    while (getline(fin, line))
+    {
+        stringstream ss(line);
+        string name, options, option;
+        if (!(ss >> name) || name[0] == '#')
+            continue;
+        while (ss >> option)
+            options += " " + option;
+        cout << "Generating " << name << options << endl;
+        if (!runCommand(quote(fs::absolute(BENCH_DIRECTORY + "/dataGenerator")) + " " + quote(directory / (name + ".csv")) + options))
+        {
+            cerr << "Error: Could not generate " << name << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Reads the counters of the buffer metrics a server dumped when it quit.
+ *
+ */
+static void readMetrics(const fs::path &fileName, WorkloadResult &result)
+{
+    ifstream fin(fileName);
+    string name;
+    long long value;
+    while (fin >> name)
+    {
+        if (name[0] == '#' || !(fin >> value))
+        {
+            fin.clear();
+            fin.ignore(numeric_limits<streamsize>::max(), '\n');
+            continue;
+        }
+        if (name == "simplera_buffer_misses_total")
+            result.pagesRead = value;
+        else if (name == "simplera_buffer_pages_written_total")
+            result.pagesWritten = value;
+        else if (name == "simplera_buffer_bytes_read_total")
+            result.bytesRead = value;
+        else if (name == "simplera_buffer_bytes_written_total")
+            result.bytesWritten = value;
+        else if (name == "simplera_buffer_hits_total")
+            result.hits = value;
+    }
+}
+
+/**
+ * @brief Counts the lines of expected, ignoring empty ones, that are not found
+ * in the same order among the lines of output.
+ *
+ */
+static long long countMissingLines(const fs::path &expected, const fs::path &output)
+{
+    ifstream expectedIn(expected), outputIn(output);
+    vector<string> outputLines;
+    string line;
+    while (getline(outputIn, line))
+        outputLines.push_back(line);
+    long long missing = 0;
+    auto next = outputLines.begin();
+    while (getline(expectedIn, line))
+    {
+        if (line.empty())
+            continue;
+        auto found = find(next, outputLines.end(), line);
+        if (found == outputLines.end())
+            missing++;
+        else
+            next = found + 1;
+    }
+    return missing;
+}
+
+/**
+ * @brief Runs a workload once in a fresh sandbox.
+ *
+ */
+static WorkloadResult runWorkload(const fs::path &workload, const fs::path &datasets)
+{
+    fs::path dataDirectory = fs::path(SANDBOX_DIRECTORY) / "data";
+    fs::path workDirectory = fs::path(SANDBOX_DIRECTORY) / "work";
+    fs::remove_all(dataDirectory);
+    fs::remove_all(workDirectory);
+    fs::create_directories(dataDirectory / "temp");
+    fs::create_directories(workDirectory);
+    for (const auto &entry : fs::directory_iterator(datasets))
+        fs::copy_file(entry.path(), dataDirectory / entry.path().filename());
+
+    WorkloadResult result;
+    result.name = workload.stem().string();
+    fs::path output = fs::absolute(fs::path(SANDBOX_DIRECTORY) / (result.name + ".out"));
+    string command = "cd " + quote(workDirectory) + " && SIMPLERA_SORT_THREADS=" + to_string(SORT_THREADS) + " " + quote(fs::absolute("server")) + " < " + quote(fs::absolute(workload)) +
+                     " > " + quote(output) + " 2>&1";
+    auto start = chrono::steady_clock::now();
+    bool succeeded = runCommand(command);
+    result.wallMilliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    readMetrics(dataDirectory / "buffer_metrics.prom", result);
+
+    ifstream fin(output);
+    string line;
+    while (getline(fin, line))
+        if (line.find("ERROR") != string::npos || line.find("Error") != string::npos)
+            result.errors++;
+    if (!succeeded)
+        result.errors++;
+    fs::path expected = fs::path(workload).replace_extension(".expected");
+    if (fs::exists(expected))
+        result.errors += countMissingLines(expected, output);
+    return result;
+}
+
+static void writeResults(const string &fileName, const vector<WorkloadResult> &results)
+{
+    ofstream fout(fileName, ios::trunc);
+    fout << "{\"workloads\": [" << endl;
+    for (size_t counter = 0; counter < results.size(); counter++)
+    {
+        const WorkloadResult &result = results[counter];
+        fout << "{\"name\": \"" << result.name << "\", \"wallMilliseconds\": " << fixed << setprecision(1) << result.wallMilliseconds
+             << ", \"pagesRead\": " << result.pagesRead << ", \"pagesWritten\": " << result.pagesWritten
+             << ", \"bytesRead\": " << result.bytesRead << ", \"bytesWritten\": " << result.bytesWritten
+             << ", \"hits\": " << result.hits << ", \"errors\": " << result.errors << "}" << (counter + 1 < results.size() ? "," : "") << endl;
+    }
+    fout << "]}" << endl;
+}
+
+static double getField(const string &line, const string &key)
+{
+    size_t position = line.find("\"" + key + "\": ");
+    return position == string::npos ? 0 : atof(line.c_str() + position + key.size() + 4);
+}
+
+/**
+ * @brief Reads results written by writeResults, one workload per line.
+ *
+ */
+static map<string, WorkloadResult> readResults(const string &fileName)
+{
+    map<string, WorkloadResult> results;
+    ifstream fin(fileName);
+    string line;
+    while (getline(fin, line))
+    {
+        size_t position = line.find("{\"name\": \"");
+        if (position == string::npos)
+            continue;
+        WorkloadResult result;
+        result.name = line.substr(position + 10, line.find('"', position + 10) - position - 10);
+        result.wallMilliseconds = getField(line, "wallMilliseconds");
+        result.pagesRead = getField(line, "pagesRead");
+        result.pagesWritten = getField(line, "pagesWritten");
+        result.bytesRead = getField(line, "bytesRead");
+        result.bytesWritten = getField(line, "bytesWritten");
+        result.hits = getField(line, "hits");
+        results[result.name] = result;
+    }
+    return results;
+}
+
+static bool isIORegression(long long pages, long long baselinePages)
+{
+    return pages > baselinePages * (1 + IO_TOLERANCE) + 1;
+}
+
+int main(int argc, char *argv[])
+{
+    int repeat = 3;
+    double tolerance = 0.5;
+    bool updateBaseline = false;
+    for (int argument = 1; argument < argc; argument++)
+    {
+        string option = argv[argument];
+        if (option == "--repeat" && argument + 1 < argc)
+            repeat = max(1, atoi(argv[++argument]));
+        else if (option == "--tolerance" && argument + 1 < argc)
+            tolerance = atof(argv[++argument]);
+        else if (option == "--update-baseline")
+            updateBaseline = true;
+        else
+        {
+            cerr << "Usage: benchRunner [--repeat N] [--tolerance X] [--update-baseline]" << endl;
+            return 2;
+        }
+    }
+    if (!fs::exists("server"))
+    {
+        cerr << "Error: Run from src after building the server" << endl;
+        return 2;
+    }
+
+    fs::path datasets = fs::path(SANDBOX_DIRECTORY) / "datasets";
+    if (!generateDatasets(datasets))
+        return 1;
+    vector<fs::path> workloads;
+    for (const auto &entry : fs::directory_iterator(BENCH_DIRECTORY + "/workloads"))
+        if (entry.path().extension() == ".ra")
+            workloads.push_back(entry.path());
+    sort(workloads.begin(), workloads.end());
+
+    vector<WorkloadResult> results;
+    for (const fs::path &workload : workloads)
+    {
+        vector<WorkloadResult> runs;
+        for (int run = 0; run < repeat; run++)
+            runs.push_back(runWorkload(workload, datasets));
+        sort(runs.begin(), runs.end(), [](const WorkloadResult &a, const WorkloadResult &b) { return a.wallMilliseconds < b.wallMilliseconds; });
+        WorkloadResult median = runs[runs.size() / 2];
+        for (const WorkloadResult &run : runs)
+            median.errors = max(median.errors, run.errors);
+        results.push_back(median);
+    }
+    string resultsFileName = SANDBOX_DIRECTORY + "/results.json";
+    string baselineFileName = BENCH_DIRECTORY + "/baseline.json";
+    writeResults(resultsFileName, results);
+    if (updateBaseline)
+        writeResults(baselineFileName, results);
+
+    map<string, WorkloadResult> baseline = readResults(baselineFileName);
+    bool failed = false;
+    cout << endl << left << setw(10) << "Workload" << right << setw(11) << "Time (ms)" << setw(11) << "Baseline" << setw(9) << "Change"
+         << setw(13) << "Pages read" << setw(11) << "Baseline" << setw(15) << "Pages written" << setw(11) << "Baseline" << "  Status" << endl;
+    for (const WorkloadResult &result : results)
+    {
+        string status = "ok";
+        auto it = baseline.find(result.name);
+        cout << left << setw(10) << result.name << right << fixed << setprecision(1) << setw(11) << result.wallMilliseconds;
+        if (it == baseline.end())
+        {
+            cout << setw(11) << "-" << setw(9) << "-" << setw(13) << result.pagesRead << setw(11) << "-" << setw(15) << result.pagesWritten << setw(11) << "-";
+            status = "no baseline";
+        }
+        else
+        {
+            const WorkloadResult &expected = it->second;
+            double change = expected.wallMilliseconds > 0 ? 100 * (result.wallMilliseconds / expected.wallMilliseconds - 1) : 0;
+            cout << setw(11) << expected.wallMilliseconds << setw(8) << showpos << change << noshowpos << "%" << setw(13) << result.pagesRead
+                 << setw(11) << expected.pagesRead << setw(15) << result.pagesWritten << setw(11) << expected.pagesWritten;
+            if (result.wallMilliseconds > expected.wallMilliseconds * (1 + tolerance) &&
+                result.wallMilliseconds - expected.wallMilliseconds > TIME_SLACK_MILLISECONDS)
+                status = "SLOWER";
+            if (isIORegression(result.pagesRead, expected.pagesRead) || isIORegression(result.pagesWritten, expected.pagesWritten))
+                status = status == "ok" ? "MORE I/O" : status + ", MORE I/O";
+            failed |= status != "ok";
+        }
+        if (result.errors)
+        {
+            status = (status == "ok" ? "" : status + ", ") + to_string(result.errors) + " ERRORS (see " + SANDBOX_DIRECTORY + "/" + result.name + ".out)";
+            failed = true;
+        }
+        cout << "  " << status << endl;
+    }
+    cout << endl << "Results written to " << resultsFileName << endl;
+    if (updateBaseline)
+        cout << "Baseline updated" << endl;
+    return failed ? 1 : 0;
+}
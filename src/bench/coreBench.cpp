@@ -0,0 +1,220 @@
+#include "global.h"
+
+/**
+ * @brief Micro-benchmarks of the core structures, run directly instead of
+ * through the parser:
+ *
+ * - BufferManager::getPage when the page is in the pool (hit) and when every
+ *   request has to read it from disk (miss, cycling through more pages than
+ *   the pool holds)
+ * - BPlusTree::insert and BPlusTree::search at several orders, for sequential,
+ *   uniform and skewed (few distinct, zipf-like) keys
+ * - Cursor::getNext over a whole table
+ * - constructing (reading) and writing a Page of every layout, bypassing the
+ *   pool
+ *
+ * Every operation, or batch of operations for the cheap ones, is timed on its
+ * own, so the report has the mean and the 50th, 90th and 99th percentile and
+ * the maximum in ns per operation; page I/O also reports MB/s. The tables are
+ * made in a sandbox, ../data/bench/micro, like the workloads of benchRunner.
+ *
+ * Build and run with `make core-bench`.
+ */
+
+float BLOCK_SIZE = 1;
+uint BLOCK_COUNT = 2;
+uint PRINT_COUNT = 20;
+uint SORT_THREAD_COUNT = max(1u, thread::hardware_concurrency());
+uint SORT_BUFFER_BLOCKS = 16;
+uint METRICS_DUMP_INTERVAL = 0;
+Logger logger;
+vector<string> tokenizedQuery;
+ParsedQuery parsedQuery;
+TableCatalogue tableCatalogue;
+MatrixCatalogue matrixCatalogue;
+BufferManager bufferManager;
+QueryProfiler queryProfiler;
+QueryTracer queryTracer;
+
+static const string SANDBOX_DIRECTORY = "../data/bench/micro";
+static const uint TABLE_ROWS = 20000;
+static const uint TABLE_COLUMNS = 4;
+static const uint TREE_KEYS = 100000;
+
+/**
+ * @brief ns per operation of every timed sample.
+ *
+ */
+struct Samples
+{
+    vector<double> nanos;
+    long long bytes = 0;
+};
+
+static double percentile(const vector<double> &sorted, double fraction)
+{
+    return sorted[min(sorted.size() - 1, (size_t)(fraction * sorted.size()))];
+}
+
+static void report(const string &name, Samples samples, uint operationsPerSample = 1)
+{
+    vector<double> &nanos = samples.nanos;
+    sort(nanos.begin(), nanos.end());
+    double total = accumulate(nanos.begin(), nanos.end(), 0.0);
+    double mean = total / nanos.size();
+    printf("%-44s %9zu %10.1f %10.1f %10.1f %10.1f %11.1f", name.c_str(), nanos.size() * operationsPerSample, mean,
+           percentile(nanos, 0.5), percentile(nanos, 0.9), percentile(nanos, 0.99), nanos.back());
+    if (samples.bytes)
+        printf(" %9.1f", samples.bytes / (total * operationsPerSample) * 1e9 / 1e6);
+    printf("\n");
+}
+
+/**
+ * @brief Times operation count times, batch calls at a time.
+ *
+ */
+static Samples measure(uint count, uint batch, const function<void(uint)> &operation)
+{
+    Samples samples;
+    for (uint sample = 0; sample < count; sample++)
+    {
+        auto start = chrono::steady_clock::now();
+        for (uint call = 0; call < batch; call++)
+            operation(sample * batch + call);
+        auto end = chrono::steady_clock::now();
+        samples.nanos.push_back(chrono::duration<double, nano>(end - start).count() / batch);
+    }
+    return samples;
+}
+
+static Table *makeTable(const string &tableName, PageLayout layout, mt19937 &random)
+{
+    ofstream fout("../data/" + tableName + ".csv", ios::trunc);
+    for (uint column = 0; column < TABLE_COLUMNS; column++)
+        fout << (column ? "," : "") << "c" << column;
+    fout << "\n";
+    uniform_int_distribution<int> values(0, 999);
+    for (uint row = 0; row < TABLE_ROWS; row++)
+    {
+        for (uint column = 0; column < TABLE_COLUMNS; column++)
+            fout << (column ? "," : "") << values(random);
+        fout << "\n";
+    }
+    fout.close();
+    Table *table = new Table(tableName);
+    table->pageLayout = layout;
+    if (!table->load())
+    {
+        fprintf(stderr, "Error: Could not load %s\n", tableName.c_str());
+        exit(1);
+    }
+    tableCatalogue.insertTable(table);
+    return table;
+}
+
+static void benchmarkBufferManager(Table *table)
+{
+    bufferManager.getPage(table->tableName, 0);
+    report("BufferManager::getPage hit", measure(200000, 1, [&](uint) { bufferManager.getPage(table->tableName, 0); }));
+    // More pages than the pool holds in FIFO order, so none is ever pooled
+    uint pageCount = max(table->blockCount, BLOCK_COUNT + 1);
+    report("BufferManager::getPage miss", measure(5000, 1, [&](uint call) { bufferManager.getPage(table->tableName, call % pageCount); }));
+}
+
+static vector<int> makeKeys(const string &distribution, mt19937 &random)
+{
+    vector<int> keys(TREE_KEYS);
+    if (distribution == "sequential")
+        iota(keys.begin(), keys.end(), 0);
+    else if (distribution == "uniform")
+        for (int &key : keys)
+            key = uniform_int_distribution<int>(0, INT_MAX)(random);
+    else
+    {
+        // About 1 / rank of the keys are rank, for 1000 ranks
+        vector<double> weights(1000);
+        for (uint rank = 0; rank < weights.size(); rank++)
+            weights[rank] = 1.0 / (rank + 1);
+        discrete_distribution<int> ranks(weights.begin(), weights.end());
+        for (int &key : keys)
+            key = ranks(random);
+    }
+    return keys;
+}
+
+static void benchmarkBPlusTree(mt19937 &random)
+{
+    for (const string distribution : {"sequential", "uniform", "skewed"})
+    {
+        vector<int> keys = makeKeys(distribution, random);
+        for (int order : {4, 16, 64, 256})
+        {
+            BPlusTree tree(order, "MB_TREE", "c0");
+            report("BPlusTree::insert order " + to_string(order) + " " + distribution,
+                   measure(TREE_KEYS / 16, 16, [&](uint call) { tree.insert(keys[call], call); }), 16);
+            vector<int> probes(TREE_KEYS / 16 * 16);
+            for (int &probe : probes)
+                probe = keys[uniform_int_distribution<uint>(0, TREE_KEYS - 1)(random)];
+            size_t found = 0;
+            report("BPlusTree::search order " + to_string(order) + " " + distribution,
+                   measure(probes.size() / 16, 16, [&](uint call) { found += tree.search(probes[call], EQUAL).size(); }), 16);
+            if (!found)
+                printf("  (no key found)\n");
+        }
+    }
+}
+
+static void benchmarkCursor(Table *table)
+{
+    Cursor cursor = table->getCursor();
+    report("Cursor::getNext " + string(table->pageLayout == COLUMN_LAYOUT ? "column" : table->pageLayout == COMPRESSED_LAYOUT ? "compressed" : "row") + " layout",
+           measure(table->rowCount, 1, [&](uint) { cursor.getNext(); }));
+}
+
+static void benchmarkPage(Table *table, const string &layoutName)
+{
+    Samples reads = measure(2000, 1, [&](uint call) { Page page(table->tableName, call % table->blockCount); });
+    // bytes of one pass over the table, scaled to every read
+    long long passBytes = 0;
+    for (uint pageIndex = 0; pageIndex < table->blockCount; pageIndex++)
+        passBytes += Page(table->tableName, pageIndex).bytesTransferred;
+    reads.bytes = passBytes * ((double)reads.nanos.size() / table->blockCount);
+    report("Page read " + layoutName, reads);
+
+    Page page(table->tableName, 0);
+    vector<vector<int>> rows = page.getAllRows();
+    Page written(table->tableName, 0, rows, page.getrowcount(), table->pageLayout);
+    Samples writes = measure(2000, 1, [&](uint) { written.writePage(); });
+    writes.bytes = written.bytesTransferred * (long long)writes.nanos.size();
+    report("Page write " + layoutName, writes);
+}
+
+int main()
+{
+    error_code error;
+    filesystem::remove_all(SANDBOX_DIRECTORY, error);
+    filesystem::create_directories(SANDBOX_DIRECTORY + "/data/temp");
+    filesystem::create_directories(SANDBOX_DIRECTORY + "/work");
+    if (chdir((SANDBOX_DIRECTORY + "/work").c_str()) != 0)
+    {
+        fprintf(stderr, "Error: Could not enter %s/work\n", SANDBOX_DIRECTORY.c_str());
+        return 1;
+    }
+
+    mt19937 random(42);
+    Table *rowTable = makeTable("MB_ROW", ROW_LAYOUT, random);
+    Table *columnTable = makeTable("MB_COLUMN", COLUMN_LAYOUT, random);
+    Table *compressedTable = makeTable("MB_COMPRESSED", COMPRESSED_LAYOUT, random);
+
+    printf("%u x %u tables, %u keys per tree, BLOCK_SIZE %.0f KB, BLOCK_COUNT %u\n\n", TABLE_ROWS, TABLE_COLUMNS, TREE_KEYS, BLOCK_SIZE, BLOCK_COUNT);
+    printf("%-44s %9s %10s %10s %10s %10s %11s %9s\n", "benchmark (ns per op)", "ops", "mean", "p50", "p90", "p99", "max", "MB/s");
+    benchmarkBufferManager(rowTable);
+    benchmarkCursor(rowTable);
+    benchmarkCursor(columnTable);
+    benchmarkCursor(compressedTable);
+    benchmarkPage(rowTable, "row");
+    benchmarkPage(columnTable, "column");
+    benchmarkPage(compressedTable, "compressed");
+    benchmarkBPlusTree(random);
+    return 0;
+}
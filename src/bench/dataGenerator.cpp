@@ -0,0 +1,202 @@
+#include <bits/stdc++.h>
+
+using namespace std;
+
+/**
+ * @brief Generates integer tables and matrices for the benchmarks.
+ *
+ * dataGenerator file.csv [option=value ...]
+ *
+ * - rows, columns: size of the table (default 10000 x 4), named c0, c1, ...
+ * - distribution: uniform, normal, zipf or sequential (default uniform) of
+ *   the values of every column, within [min, max] (default [0, 999])
+ * - skew: exponent of the zipf distribution (default 1); the smallest values
+ *   are the most frequent
+ * - sorted: fraction of the rows in ascending order of c0 (default 0); the
+ *   rows are sorted and the remaining fraction of them shuffled among
+ *   themselves, so 1 is sorted and 0 is in no particular order
+ * - matrix: writes an n x n matrix, without a header, for LOAD MATRIX
+ * - seed: of the random values (default 1)
+ *
+ * bench/datasets.txt lists the data the benchmark runner generates with it.
+ */
+
+struct Options
+{
+    long long rows = 10000;
+    int columns = 4;
+    string distribution = "uniform";
+    int minValue = 0;
+    int maxValue = 999;
+    double skew = 1;
+    double sorted = 0;
+    int matrixSize = 0;
+    unsigned seed = 1;
+};
+
+static bool parseOptions(int argc, char *argv[], Options &options)
+{
+    for (int argument = 2; argument < argc; argument++)
+    {
+        string option = argv[argument];
+        size_t position = option.find('=');
+        if (position == string::npos)
+            return false;
+        string key = option.substr(0, position), value = option.substr(position + 1);
+        try
+        {
+            if (key == "rows")
+                options.rows = stoll(value);
+            else if (key == "columns")
+                options.columns = stoi(value);
+            else if (key == "distribution")
+                options.distribution = value;
+            else if (key == "min")
+                options.minValue = stoi(value);
+            else if (key == "max")
+                options.maxValue = stoi(value);
+            else if (key == "skew")
+                options.skew = stod(value);
+            else if (key == "sorted")
+                options.sorted = stod(value);
+            else if (key == "matrix")
+                options.matrixSize = stoi(value);
+            else if (key == "seed")
+                options.seed = stoul(value);
+            else
+                return false;
+        }
+        catch (const exception &)
+        {
+            return false;
+        }
+    }
+    return options.rows >= 0 && options.columns > 0 && options.minValue <= options.maxValue && options.sorted >= 0 &&
+           options.sorted <= 1 && options.matrixSize >= 0 &&
+           (options.distribution == "uniform" || options.distribution == "normal" || options.distribution == "zipf" ||
+            options.distribution == "sequential");
+}
+
+/**
+ * @brief Draws values of one distribution. Zipf draws a rank by binary search
+ * in the cumulative probabilities of all ranks of [min, max].
+ *
+ */
+class ValueGenerator
+{
+    const Options &options;
+    mt19937_64 &random;
+    vector<double> zipfCumulative;
+    long long nextSequential;
+
+public:
+    ValueGenerator(const Options &options, mt19937_64 &random) : options(options), random(random), nextSequential(options.minValue)
+    {
+        if (options.distribution != "zipf")
+            return;
+        long long range = (long long)options.maxValue - options.minValue + 1;
+        zipfCumulative.resize(range);
+        double sum = 0;
+        for (long long rank = 0; rank < range; rank++)
+            zipfCumulative[rank] = sum += 1 / pow(rank + 1, options.skew);
+        for (double &cumulative : zipfCumulative)
+            cumulative /= sum;
+    }
+
+    int next()
+    {
+        if (options.distribution == "uniform")
+            return uniform_int_distribution<int>(options.minValue, options.maxValue)(random);
+        if (options.distribution == "normal")
+        {
+            double mean = ((double)options.minValue + options.maxValue) / 2;
+            double deviation = max(1.0, ((double)options.maxValue - options.minValue) / 6);
+            double value = llround(normal_distribution<double>(mean, deviation)(random));
+            return (int)min((double)options.maxValue, max((double)options.minValue, value));
+        }
+        if (options.distribution == "zipf")
+        {
+            double draw = uniform_real_distribution<double>(0, 1)(random);
+            long long rank = lower_bound(zipfCumulative.begin(), zipfCumulative.end(), draw) - zipfCumulative.begin();
+            return options.minValue + (int)min(rank, (long long)zipfCumulative.size() - 1);
+        }
+        int value = (int)nextSequential;
+        nextSequential = nextSequential == options.maxValue ? options.minValue : nextSequential + 1;
+        return value;
+    }
+};
+
+static void writeMatrix(ofstream &fout, const Options &options, mt19937_64 &random)
+{
+    ValueGenerator generator(options, random);
+    for (int row = 0; row < options.matrixSize; row++)
+    {
+        for (int column = 0; column < options.matrixSize; column++)
+            fout << (column ? ", " : "") << generator.next();
+        fout << "\n";
+    }
+}
+
+static void writeTable(ofstream &fout, const Options &options, mt19937_64 &random)
+{
+    vector<ValueGenerator> generators;
+    for (int column = 0; column < options.columns; column++)
+        generators.emplace_back(options, random);
+    vector<vector<int>> rows(options.rows, vector<int>(options.columns));
+    for (long long row = 0; row < options.rows; row++)
+        for (int column = 0; column < options.columns; column++)
+            rows[row][column] = generators[column].next();
+
+    if (options.sorted > 0)
+    {
+        sort(rows.begin(), rows.end());
+        // Shuffle the rows at a random (1 - sorted) fraction of the positions
+        vector<long long> positions(options.rows);
+        iota(positions.begin(), positions.end(), 0);
+        shuffle(positions.begin(), positions.end(), random);
+        positions.resize(llround((1 - options.sorted) * options.rows));
+        vector<long long> targets = positions;
+        shuffle(targets.begin(), targets.end(), random);
+        vector<vector<int>> moved;
+        for (long long position : positions)
+            moved.push_back(rows[position]);
+        for (size_t counter = 0; counter < targets.size(); counter++)
+            rows[targets[counter]] = moved[counter];
+    }
+    else
+        shuffle(rows.begin(), rows.end(), random);
+
+    for (int column = 0; column < options.columns; column++)
+        fout << (column ? "," : "") << "c" << column;
+    fout << "\n";
+    for (const vector<int> &row : rows)
+    {
+        for (int column = 0; column < options.columns; column++)
+            fout << (column ? "," : "") << row[column];
+        fout << "\n";
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    Options options;
+    if (argc < 2 || !parseOptions(argc, argv, options))
+    {
+        cerr << "Usage: dataGenerator file.csv [rows=N] [columns=N] [distribution=uniform|normal|zipf|sequential]"
+             << " [min=N] [max=N] [skew=X] [sorted=0..1] [matrix=N] [seed=N]" << endl;
+        return 2;
+    }
+    ofstream fout(argv[1], ios::trunc);
+    if (!fout.is_open())
+    {
+        cerr << "Error: Could not open " << argv[1] << endl;
+        return 1;
+    }
+    mt19937_64 random(options.seed);
+    if (options.matrixSize)
+        writeMatrix(fout, options, random);
+    else
+        writeTable(fout, options, random);
+    fout.close();
+    return fout ? 0 : 1;
+}
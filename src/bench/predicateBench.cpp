@@ -0,0 +1,118 @@
+#include "global.h"
+
+/**
+ * @brief Micro-benchmark of predicate evaluation in scans. For every operator
+ * it filters a column against a literal (and against a second column) with
+ *
+ * - dispatch: evaluateBinOp and its switch on the operator for every value,
+ *   the way scans evaluated predicates before ScanFilter
+ * - ScanFilter::select, the branch-free scalar loop
+ * - ScanFilter::match, the loop the compiler vectorizes (1/0 per value)
+ * - the filter kernel getScanFilter picks for every instruction set the CPU
+ *   supports
+ *
+ * and prints the best time per value over a few repetitions. Values are
+ * uniform over [0, 1000), so a literal of 500 selects about half of them,
+ * which is where branches mispredict most.
+ *
+ * Build and run with `make predicate-bench`.
+ */
+
+static const uint VALUE_COUNT = 1 << 22;
+static const int REPETITIONS = 5;
+static const int LITERAL = 500;
+
+// Keeps the compiler from resolving the operator of the dispatch loop
+static volatile int operatorSink;
+
+static double bestNanosPerValue(const function<uint()> &run, uint &selected)
+{
+    double best = 1e18;
+    for (int repetition = 0; repetition < REPETITIONS; repetition++)
+    {
+        auto start = chrono::steady_clock::now();
+        selected = run();
+        auto end = chrono::steady_clock::now();
+        best = min(best, chrono::duration<double, nano>(end - start).count() / VALUE_COUNT);
+    }
+    return best;
+}
+
+static uint dispatchScan(const int *left, const int *right, uint count, BinaryOperator op, uint *selection)
+{
+    uint selected = 0;
+    for (uint position = 0; position < count; position++)
+        if (evaluateBinOp(left[position], right ? right[position] : LITERAL, op))
+            selection[selected++] = position;
+    return selected;
+}
+
+template <BinaryOperator op, typename Operand>
+static void benchmarkOperator(const char *name, const vector<int> &left, const vector<int> &right)
+{
+    vector<uint> selection(VALUE_COUNT);
+    vector<unsigned char> matches(VALUE_COUNT);
+    bool compareColumns = is_same<Operand, Column>::value;
+    const int *rightValues = compareColumns ? right.data() : nullptr;
+    operatorSink = op;
+    BinaryOperator runtimeOperator = (BinaryOperator)operatorSink;
+    uint selected = 0, expected = 0;
+
+    printf("%-3s %-7s", name, compareColumns ? "column" : "literal");
+    double dispatch = bestNanosPerValue([&]()
+                                        { return dispatchScan(left.data(), rightValues, VALUE_COUNT, runtimeOperator, selection.data()); }, expected);
+    printf(" %9.3f", dispatch);
+
+    double select = bestNanosPerValue([&]()
+                                      { return ScanFilter<op, Operand>::select(left.data(), rightValues, LITERAL, 0, VALUE_COUNT, selection.data(), 0); }, selected);
+    printf(" %9.3f", select);
+
+    double match = bestNanosPerValue([&]()
+                                     {
+        ScanFilter<op, Operand>::match(left.data(), rightValues, LITERAL, VALUE_COUNT, matches.data());
+        return (uint)count(matches.begin(), matches.end(), 1); }, selected);
+    printf(" %9.3f", match);
+
+    for (int level = SCALAR_KERNELS; level <= getFilterKernelLevel(); level++)
+    {
+        ScanFilterFunction filter = getScanFilter(op, compareColumns, (FilterKernelLevel)level);
+        double kernel = bestNanosPerValue([&]()
+                                          { return filter(left.data(), rightValues, LITERAL, VALUE_COUNT, selection.data()); }, selected);
+        printf(" %9.3f", kernel);
+        if (selected != expected)
+            printf(" (MISMATCH %u != %u)", selected, expected);
+    }
+    printf("   %.1f%% selected\n", 100.0 * expected / VALUE_COUNT);
+}
+
+template <typename Operand>
+static void benchmarkOperators(const vector<int> &left, const vector<int> &right)
+{
+    benchmarkOperator<LESS_THAN, Operand>("<", left, right);
+    benchmarkOperator<GREATER_THAN, Operand>(">", left, right);
+    benchmarkOperator<LEQ, Operand>("<=", left, right);
+    benchmarkOperator<GEQ, Operand>(">=", left, right);
+    benchmarkOperator<EQUAL, Operand>("==", left, right);
+    benchmarkOperator<NOT_EQUAL, Operand>("!=", left, right);
+}
+
+int main()
+{
+    mt19937 generator(42);
+    uniform_int_distribution<int> distribution(0, 999);
+    vector<int> left(VALUE_COUNT), right(VALUE_COUNT);
+    for (uint position = 0; position < VALUE_COUNT; position++)
+    {
+        left[position] = distribution(generator);
+        right[position] = distribution(generator);
+    }
+
+    printf("%u values, best of %d runs, ns per value\n\n", VALUE_COUNT, REPETITIONS);
+    printf("%-3s %-7s %9s %9s %9s", "op", "operand", "dispatch", "select", "match");
+    for (int level = SCALAR_KERNELS; level <= getFilterKernelLevel(); level++)
+        printf(" %9s", getFilterKernelName((FilterKernelLevel)level).c_str());
+    printf("\n");
+    benchmarkOperators<Literal>(left, right);
+    benchmarkOperators<Column>(left, right);
+    return 0;
+}
@@ -0,0 +1,187 @@
+#include "global.h"
+
+/**
+ * @brief Returns the chunk of the rows with the given high bits, adding it in
+ * key order if there is none. Rows are usually added in ascending order, so
+ * the last chunk is tried first.
+ *
+ */
+CompressedBitmap::Chunk &CompressedBitmap::getChunk(uint key)
+{
+    if (!this->chunks.empty() && this->chunks.back().key == key)
+        return this->chunks.back();
+    auto it = lower_bound(this->chunks.begin(), this->chunks.end(), key, [](const Chunk &chunk, uint key)
+                          { return chunk.key < key; });
+    if (it == this->chunks.end() || it->key != key)
+    {
+        it = this->chunks.insert(it, Chunk());
+        it->key = key;
+    }
+    return *it;
+}
+
+void CompressedBitmap::add(uint row)
+{
+    Chunk &chunk = this->getChunk(row >> 16);
+    uint16_t low = row & 0xFFFF;
+    if (!chunk.bits.empty())
+    {
+        unsigned long long bit = 1ULL << (low & 63);
+        if (!(chunk.bits[low >> 6] & bit))
+        {
+            chunk.bits[low >> 6] |= bit;
+            chunk.cardinality++;
+        }
+        return;
+    }
+    if (chunk.rows.empty() || chunk.rows.back() < low)
+        chunk.rows.push_back(low);
+    else
+    {
+        auto it = lower_bound(chunk.rows.begin(), chunk.rows.end(), low);
+        if (*it == low)
+            return;
+        chunk.rows.insert(it, low);
+    }
+    chunk.cardinality++;
+    if (chunk.rows.size() > ARRAY_LIMIT)
+    {
+        chunk.bits.assign(CHUNK_WORDS, 0);
+        for (uint16_t value : chunk.rows)
+            chunk.bits[value >> 6] |= 1ULL << (value & 63);
+        vector<uint16_t>().swap(chunk.rows);
+    }
+}
+
+bool CompressedBitmap::contains(uint row) const
+{
+    uint key = row >> 16;
+    uint16_t low = row & 0xFFFF;
+    auto it = lower_bound(this->chunks.begin(), this->chunks.end(), key, [](const Chunk &chunk, uint key)
+                          { return chunk.key < key; });
+    if (it == this->chunks.end() || it->key != key)
+        return false;
+    if (!it->bits.empty())
+        return (it->bits[low >> 6] >> (low & 63)) & 1;
+    return binary_search(it->rows.begin(), it->rows.end(), low);
+}
+
+long long CompressedBitmap::cardinality() const
+{
+    long long cardinality = 0;
+    for (const Chunk &chunk : this->chunks)
+        cardinality += chunk.cardinality;
+    return cardinality;
+}
+
+/**
+ * @brief ORs the set into a plain bitset of wordCount 64-bit words (bit i of
+ * the bitset is row i). Rows beyond the bitset are ignored.
+ *
+ * @param words
+ * @param wordCount
+ */
+void CompressedBitmap::orInto(unsigned long long *words, unsigned long long wordCount) const
+{
+    for (const Chunk &chunk : this->chunks)
+    {
+        unsigned long long firstWord = (unsigned long long)chunk.key * CHUNK_WORDS;
+        if (!chunk.bits.empty())
+        {
+            for (uint word = 0; word < CHUNK_WORDS && firstWord + word < wordCount; word++)
+                words[firstWord + word] |= chunk.bits[word];
+            continue;
+        }
+        for (uint16_t low : chunk.rows)
+        {
+            unsigned long long row = ((unsigned long long)chunk.key << 16) | low;
+            if ((row >> 6) < wordCount)
+                words[row >> 6] |= 1ULL << (row & 63);
+        }
+    }
+}
+
+/**
+ * @brief Appends the rows of the set to rowIds in ascending order.
+ *
+ * @param rowIds
+ */
+void CompressedBitmap::appendRows(vector<int> &rowIds) const
+{
+    for (const Chunk &chunk : this->chunks)
+    {
+        uint base = chunk.key << 16;
+        if (chunk.bits.empty())
+        {
+            for (uint16_t low : chunk.rows)
+                rowIds.push_back(base | low);
+            continue;
+        }
+        for (uint word = 0; word < CHUNK_WORDS; word++)
+            for (unsigned long long bits = chunk.bits[word]; bits; bits &= bits - 1)
+                rowIds.push_back(base | (word << 6) | __builtin_ctzll(bits));
+    }
+}
+
+unsigned long long CompressedBitmap::sizeInBytes() const
+{
+    unsigned long long size = sizeof(CompressedBitmap);
+    for (const Chunk &chunk : this->chunks)
+        size += sizeof(Chunk) + chunk.rows.size() * sizeof(uint16_t) + chunk.bits.size() * sizeof(unsigned long long);
+    return size;
+}
+
+void BitmapIndex::add(int value, uint row)
+{
+    this->bitmaps[value].add(row);
+}
+
+/**
+ * @brief Returns the bitmaps of all values v with v op value, in value order.
+ * The rows satisfying the comparison are their union.
+ *
+ * @param op
+ * @param value
+ * @return vector<const CompressedBitmap *>
+ */
+vector<const CompressedBitmap *> BitmapIndex::lookup(BinaryOperator op, int value) const
+{
+    vector<const CompressedBitmap *> result;
+    auto first = this->bitmaps.begin(), last = this->bitmaps.end();
+    switch (op)
+    {
+    case EQUAL:
+        first = this->bitmaps.find(value);
+        if (first != last)
+            last = next(first);
+        break;
+    case LESS_THAN:
+        last = this->bitmaps.lower_bound(value);
+        break;
+    case LEQ:
+        last = this->bitmaps.upper_bound(value);
+        break;
+    case GREATER_THAN:
+        first = this->bitmaps.upper_bound(value);
+        break;
+    case GEQ:
+        first = this->bitmaps.lower_bound(value);
+        break;
+    case NOT_EQUAL:
+        break;
+    default:
+        return result;
+    }
+    for (auto it = first; it != last; it++)
+        if (op != NOT_EQUAL || it->first != value)
+            result.push_back(&it->second);
+    return result;
+}
+
+unsigned long long BitmapIndex::sizeInBytes() const
+{
+    unsigned long long size = sizeof(BitmapIndex);
+    for (const auto &entry : this->bitmaps)
+        size += sizeof(entry) + entry.second.sizeInBytes();
+    return size;
+}
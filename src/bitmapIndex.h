@@ -0,0 +1,66 @@
+#ifndef BITMAPINDEX_H
+#define BITMAPINDEX_H
+
+#include <map>
+#include <vector>
+#include <cstdint>
+#include "enums.h"
+
+using namespace std;
+
+/**
+ * @brief A compressed set of row numbers in the style of Roaring bitmaps. Rows
+ * are split into chunks of 2^16 by their high bits. A chunk keeps the low 16
+ * bits of its rows as a sorted array while it has at most ARRAY_LIMIT of them
+ * and switches to a 2^16 bit bitset (8 KB) beyond that, so a set takes at most
+ * about 2 bytes per row however sparse or dense it is, and a dense chunk is
+ * combined with other bitmaps a 64-bit word at a time.
+ *
+ */
+class CompressedBitmap
+{
+    struct Chunk
+    {
+        uint key = 0;
+        uint cardinality = 0;
+        vector<uint16_t> rows;
+        vector<unsigned long long> bits;
+    };
+    vector<Chunk> chunks;
+
+    Chunk &getChunk(uint key);
+
+public:
+    static const uint ARRAY_LIMIT = 4096;
+    static const uint CHUNK_WORDS = (1 << 16) / 64;
+
+    void add(uint row);
+    bool contains(uint row) const;
+    long long cardinality() const;
+    void orInto(unsigned long long *words, unsigned long long wordCount) const;
+    void appendRows(vector<int> &rowIds) const;
+    unsigned long long sizeInBytes() const;
+};
+
+/**
+ * @brief Bitmap index on one column: a CompressedBitmap of the rows holding
+ * each distinct value, kept in value order. It suits columns with few
+ * distinct values, where equality, IN and range predicates become unions of
+ * a few bitmaps and COUNT per value is the cardinality of one. rowCount is the
+ * number of rows the index covers and tells a stale index apart.
+ *
+ */
+class BitmapIndex
+{
+    map<int, CompressedBitmap> bitmaps;
+
+public:
+    long long rowCount = 0;
+
+    void add(int value, uint row);
+    vector<const CompressedBitmap *> lookup(BinaryOperator op, int value) const;
+    const map<int, CompressedBitmap> &getBitmaps() const { return this->bitmaps; }
+    unsigned long long sizeInBytes() const;
+};
+
+#endif // BITMAPINDEX_H
@@ -0,0 +1,90 @@
+#include "global.h"
+
+/**
+ * @brief Mixes a value into 64 well distributed bits (the finalizer of
+ * splitmix64). The HASH_COUNT bit positions are derived from its two halves
+ * by double hashing.
+ *
+ */
+static inline unsigned long long hashValue(int value)
+{
+    unsigned long long hash = (unsigned long long)(unsigned int)value + 0x9E3779B97F4A7C15ULL;
+    hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBULL;
+    return hash ^ (hash >> 31);
+}
+
+/**
+ * @brief Builds the filters of every column from the first rowCount rows of a
+ * page.
+ *
+ * @param rows
+ * @param rowCount
+ * @param columnCount
+ */
+void PageBloomFilter::build(const vector<vector<int>> &rows, int rowCount, uint columnCount)
+{
+    rowCount = min(rowCount, (int)rows.size());
+    this->wordsPerColumn = rowCount > 0 ? (rowCount * BITS_PER_VALUE + 63) / 64 : 0;
+    this->words.assign(this->wordsPerColumn * columnCount, 0);
+    if (this->wordsPerColumn == 0)
+        return;
+    unsigned long long bitCount = this->wordsPerColumn * 64ULL;
+    for (uint columnIndex = 0; columnIndex < columnCount; columnIndex++)
+    {
+        unsigned long long *filter = this->words.data() + columnIndex * this->wordsPerColumn;
+        for (int rowCounter = 0; rowCounter < rowCount; rowCounter++)
+        {
+            if (columnIndex >= rows[rowCounter].size())
+                continue;
+            unsigned long long hash = hashValue(rows[rowCounter][columnIndex]);
+            unsigned long long first = hash & 0xFFFFFFFF, step = (hash >> 32) | 1;
+            for (uint probe = 0; probe < HASH_COUNT; probe++)
+            {
+                unsigned long long bit = (first + probe * step) % bitCount;
+                filter[bit >> 6] |= 1ULL << (bit & 63);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Whether value may occur in the column on this page. False means it
+ * certainly doesn't; an empty filter (no rows) contains nothing.
+ *
+ * @param columnIndex
+ * @param value
+ * @return true if value may be on the page
+ */
+bool PageBloomFilter::mayContain(uint columnIndex, int value) const
+{
+    if (this->wordsPerColumn == 0 || (columnIndex + 1) * this->wordsPerColumn > this->words.size())
+        return this->wordsPerColumn != 0;
+    const unsigned long long *filter = this->words.data() + columnIndex * this->wordsPerColumn;
+    unsigned long long bitCount = this->wordsPerColumn * 64ULL;
+    unsigned long long hash = hashValue(value);
+    unsigned long long first = hash & 0xFFFFFFFF, step = (hash >> 32) | 1;
+    for (uint probe = 0; probe < HASH_COUNT; probe++)
+    {
+        unsigned long long bit = (first + probe * step) % bitCount;
+        if (!((filter[bit >> 6] >> (bit & 63)) & 1))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Writes the filters to the catalog (see TableCatalogue::checkpoint).
+ *
+ * @param fout
+ */
+void PageBloomFilter::save(ostream &fout) const
+{
+    writeCatalogValue(fout, this->wordsPerColumn);
+    writeCatalogVector(fout, this->words);
+}
+
+bool PageBloomFilter::restore(istream &fin)
+{
+    return readCatalogValue(fin, this->wordsPerColumn) && readCatalogVector(fin, this->words);
+}
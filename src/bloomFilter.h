@@ -0,0 +1,34 @@
+#ifndef BLOOMFILTER_H
+#define BLOOMFILTER_H
+
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief Bloom filters over the values of every column of one page, stored one
+ * after the other in a single array of words. Each filter has about
+ * BITS_PER_VALUE bits per row of the page and sets HASH_COUNT bits per value,
+ * which gives about 1% false positives. mayContain never misses a value that
+ * is on the page, so a scan for column == value can skip every page whose
+ * filter says no.
+ *
+ */
+class PageBloomFilter
+{
+    uint wordsPerColumn = 0;
+    vector<unsigned long long> words;
+
+public:
+    static const uint BITS_PER_VALUE = 10;
+    static const uint HASH_COUNT = 4;
+
+    void build(const vector<vector<int>> &rows, int rowCount, uint columnCount);
+    bool mayContain(uint columnIndex, int value) const;
+    bool isEmpty() const { return this->wordsPerColumn == 0; }
+    void save(ostream &fout) const;
+    bool restore(istream &fin);
+};
+
+#endif // BLOOMFILTER_H
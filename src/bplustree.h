@@ -510,6 +510,16 @@ private:
     }
 
 public:
+    // Page reads of an index scan per batch of row numbers taken off the leaf
+    // chain, kept by Table::updateIndexScanStatistics so that planning doesn't
+    // walk the tree. scanRowCount is the row count of the table they were
+    // computed for, -1 while there are none; scanCoversTable is false if the
+    // tree didn't cover every row exactly once in key order.
+    long long scanRowCount = -1;
+    uint scanBatchSize = 0;
+    bool scanCoversTable = false;
+    vector<long long> scanBatchPageReads;
+
     BPlusTree(int order, string tableName, string columnName) {
         try {
             if (order < 2) {
@@ -559,6 +569,7 @@ public:
 
     // Insert a key-value pair into the tree
     void insert(int key, int rowId) {
+        this->scanRowCount = -1;
         try {
             // cout << "DEBUG: Inserting key " << key << " with rowId " << rowId << endl;
             
@@ -953,6 +964,18 @@ public:
         return result;
     }
 
+    // Get the leftmost leaf, from which the leaf chain visits all keys in order
+    BPlusTreeNode* getFirstLeaf() {
+        BPlusTreeNode* current = root;
+        while (current && !current->isLeaf) {
+            if (current->children.empty()) {
+                return nullptr;
+            }
+            current = current->children[0];
+        }
+        return current;
+    }
+
     // Save the tree to disk
     bool saveToDisk() {
         // Check if the tree is empty
@@ -984,6 +1007,7 @@ public:
 
     // Load the tree from disk
     bool loadFromDisk() {
+        this->scanRowCount = -1;
         ifstream inFile(indexFileName, ios::binary);
         if (!inFile) {
             return false;
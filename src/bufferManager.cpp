@@ -43,6 +43,113 @@ bool BufferManager::isTableBeingIndexed(string tableName)
     return tablesBeingIndexed.find(tableName) != tablesBeingIndexed.end();
 }
 
+/**
+ * @brief Returns a copy of the running totals of hits, misses and writes.
+ *
+ * @return BufferStatistics
+ */
+BufferStatistics BufferManager::getStatistics()
+{
+    lock_guard<mutex> lock(this->poolMutex);
+    return this->statistics;
+}
+
+/**
+ * @brief Names of the pages in the pool, oldest first, i.e. in the order they
+ * will be evicted.
+ *
+ * @return vector<string>
+ */
+vector<string> BufferManager::getPoolPageNames()
+{
+    logger.log("BufferManager::getPoolPageNames");
+    lock_guard<mutex> lock(this->poolMutex);
+    vector<string> pageNames;
+    for (const Page &page : this->pages)
+        pageNames.push_back(page.pageName);
+    return pageNames;
+}
+
+/**
+ * @brief Name of the table or matrix a page of the pool belongs to, taken from
+ * its page name ../data/temp/<name>_Page<index>.
+ *
+ */
+static string getPageOwnerName(const string &pageName)
+{
+    string name = pageName;
+    if (name.compare(0, 13, "../data/temp/") == 0)
+        name = name.substr(13);
+    size_t position = name.rfind("_Page");
+    return position == string::npos ? name : name.substr(0, position);
+}
+
+/**
+ * @brief Number of pages of every table and matrix that are in the pool.
+ *
+ * @return map<string, uint>
+ */
+map<string, uint> BufferManager::getResidentPageCounts()
+{
+    logger.log("BufferManager::getResidentPageCounts");
+    map<string, uint> residentPages;
+    for (const string &pageName : this->getPoolPageNames())
+        residentPages[getPageOwnerName(pageName)]++;
+    return residentPages;
+}
+
+/**
+ * @brief Writes the statistics and the pages of every table in the pool to
+ * fileName in the Prometheus text format. The file is written under another
+ * name and renamed, so a scraper never reads half of it.
+ *
+ * @param fileName
+ * @return true if the file was written
+ */
+bool BufferManager::writeMetrics(string fileName)
+{
+    logger.log("BufferManager::writeMetrics");
+    BufferStatistics statistics = this->getStatistics();
+    vector<pair<string, long long>> counters = {
+        {"hits", statistics.hits}, {"misses", statistics.misses}, {"evictions", statistics.evictions},
+        {"pages_written", statistics.pagesWritten}, {"bytes_read", statistics.bytesRead}, {"bytes_written", statistics.bytesWritten}};
+    string temporaryFileName = fileName + ".tmp";
+    ofstream fout(temporaryFileName, ios::trunc);
+    if (!fout.is_open())
+        return false;
+    for (const auto &counter : counters)
+    {
+        fout << "# TYPE simplera_buffer_" << counter.first << "_total counter" << endl;
+        fout << "simplera_buffer_" << counter.first << "_total " << counter.second << endl;
+    }
+    fout << "# TYPE simplera_buffer_capacity_pages gauge" << endl;
+    fout << "simplera_buffer_capacity_pages " << BLOCK_COUNT << endl;
+    fout << "# TYPE simplera_buffer_resident_pages gauge" << endl;
+    for (const auto &residentPages : this->getResidentPageCounts())
+        fout << "simplera_buffer_resident_pages{table=\"" << residentPages.first << "\"} " << residentPages.second << endl;
+    fout.close();
+    return (bool)fout && rename(temporaryFileName.c_str(), fileName.c_str()) == 0;
+}
+
+/**
+ * @brief Writes the metrics to ../data/buffer_metrics.prom if
+ * METRICS_DUMP_INTERVAL seconds have passed since they were last written.
+ * Called between commands, so a long command delays the dump until it ends.
+ * An interval of 0 turns the dumps off.
+ *
+ * @param force write the metrics however long ago they were last written
+ */
+void BufferManager::dumpMetricsIfDue(bool force)
+{
+    auto now = chrono::steady_clock::now();
+    if (METRICS_DUMP_INTERVAL == 0 || (!force && now - this->lastMetricsDump < chrono::seconds(METRICS_DUMP_INTERVAL)))
+        return;
+    logger.log("BufferManager::dumpMetricsIfDue");
+    this->lastMetricsDump = now;
+    if (!this->writeMetrics("../data/buffer_metrics.prom"))
+        logger.log("BufferManager::dumpMetricsIfDue: Err");
+}
+
 /**
  * @brief Function called to read a page from the buffer manager. If the page is
  * not present in the pool, the page is read and then inserted into the pool.
@@ -52,24 +159,46 @@ bool BufferManager::isTableBeingIndexed(string tableName)
  * @return Page 
  */
 Page BufferManager::getPage(string tableName, int pageIndex)
+{
+    return this->getPage(tableName, pageIndex, vector<int>());
+}
+
+/**
+ * @brief Reads a page of which only the given columns are needed, e.g. by a
+ * projection. A pooled copy of the full page is used if there is one;
+ * otherwise a column layout page only reads those columns' segments and is
+ * pooled as a separate copy (see getColumnsPageName). An empty columnIndexes
+ * asks for every column.
+ *
+ * @param tableName 
+ * @param pageIndex 
+ * @param columnIndexes
+ * @return Page 
+ */
+Page BufferManager::getPage(string tableName, int pageIndex, vector<int> columnIndexes)
 {
     logger.log("BufferManager::getPage");
     if (strncmp(tableName.c_str(), "temp/", 5) == 0) {
         tableName = tableName.substr(5);
     }
+    sort(columnIndexes.begin(), columnIndexes.end());
+    columnIndexes.erase(unique(columnIndexes.begin(), columnIndexes.end()), columnIndexes.end());
     
     string pageName = "../data/temp/" + tableName + "_Page" + to_string(pageIndex);
+    string columnsPageName = columnIndexes.empty() ? pageName : getColumnsPageName(pageName, columnIndexes);
+    unique_lock<mutex> lock(this->poolMutex);
     
     // cout << "DEBUG: BufferManager::getPage - Requesting page: " << pageName << endl;
     // cout << "DEBUG: Current buffer size: " << this->pages.size() << "/" << BLOCK_COUNT << endl;
     
     // Check if page exists in pool
     for (auto& page : this->pages) {
-        if (page.pageName == pageName) {
+        if (page.pageName == pageName || page.pageName == columnsPageName) {
             // cout << "DEBUG: Page found in buffer pool: " << pageName << endl;
             // Move the page to the end of the deque to mark it as recently used
             Page foundPage = page;
             // We'll move it to the end later after removing it
+            this->statistics.hits++;
             return foundPage;
         }
     }
@@ -78,10 +207,26 @@ Page BufferManager::getPage(string tableName, int pageIndex)
     
     // If not in pool, create new page and add to pool
     try {
-        Page newPage(tableName, pageIndex);
+        // The page is read without holding the pool lock so that sort workers
+        // can read different pages concurrently
+        lock.unlock();
+        TraceSpan span("page read", "io", columnsPageName);
+        Page newPage(tableName, pageIndex, columnIndexes);
+        lock.lock();
+        this->statistics.misses++;
+        this->statistics.bytesRead += newPage.bytesTransferred;
+
+        // Another worker may have read the same page while the lock was
+        // released; keep a single copy of it in the pool
+        for (auto& page : this->pages) {
+            if (page.pageName == newPage.pageName) {
+                return page;
+            }
+        }
         
         // If buffer is full, we need to evict a page
         if (this->pages.size() >= BLOCK_COUNT) {
+            this->statistics.evictions++;
             // Check if the page we're about to evict is an index page
             string frontPageName = this->pages.front().pageName;
             bool isIndexPage = frontPageName.find("_index") != string::npos || 
@@ -192,16 +337,21 @@ Page BufferManager::getPage(string matrixName, int pageIndex, int is_matrix)
         if (page.pageName == pageName) {
             // Move the page to the end of the deque to mark it as recently used
             Page foundPage = page;
+            this->statistics.hits++;
             return foundPage;
         }
     }
     
     // If not in pool, create new page and add to pool
     try {
+        TraceSpan span("page read", "io", pageName);
         Page newPage(matrixName, pageIndex, 1);
+        this->statistics.misses++;
+        this->statistics.bytesRead += newPage.bytesTransferred;
         
         // If buffer is full, we need to evict a page
         if (this->pages.size() >= BLOCK_COUNT) {
+            this->statistics.evictions++;
             // Check if the page we're about to evict is an index page
             string frontPageName = this->pages.front().pageName;
             bool isIndexPage = frontPageName.find("_index") != string::npos || 
@@ -295,6 +445,7 @@ Page BufferManager::insertIntoPool(string tableName, int pageIndex)
         
         // If buffer is full, we need to evict a page
         if (this->pages.size() >= BLOCK_COUNT) {
+            this->statistics.evictions++;
             // Check if the page we're about to evict is an index page
             string frontPageName = this->pages.front().pageName;
             bool isIndexPage = frontPageName.find("_index") != string::npos || 
@@ -341,6 +492,7 @@ Page BufferManager::insertIntoPool(string tableName, int pageIndex, int is_matri
         
         // If buffer is full, we need to evict a page
         if (this->pages.size() >= BLOCK_COUNT) {
+            this->statistics.evictions++;
             // Check if the page we're about to evict is an index page
             string frontPageName = this->pages.front().pageName;
             bool isIndexPage = frontPageName.find("_index") != string::npos || 
@@ -388,17 +540,22 @@ Page BufferManager::insertIntoPool(string tableName, int pageIndex, int is_matri
  * @param rows 
  * @param rowCount 
  */
-void BufferManager::writePage(string tableName, int pageIndex, vector<vector<int>> rows, int rowCount)
+void BufferManager::writePage(string tableName, int pageIndex, vector<vector<int>> rows, int rowCount, PageLayout layout)
 {
     logger.log("BufferManager::writePage");
     string pageName = "../data/temp/" + tableName + "_Page" + to_string(pageIndex);
     
     try {
         // Create new page
-        Page page(tableName, pageIndex, rows, rowCount);
+        Page page(tableName, pageIndex, rows, rowCount, layout);
         
         // Write to disk
+        TraceSpan span("page write", "io", pageName);
         page.writePage();
+        lock_guard<mutex> lock(this->poolMutex);
+        this->statistics.pagesWritten++;
+        this->statistics.bytesWritten += page.bytesTransferred;
+        this->dropColumnCopies(pageName);
         
         // Update in pool if exists
         for (auto& p : this->pages) {
@@ -410,6 +567,7 @@ void BufferManager::writePage(string tableName, int pageIndex, vector<vector<int
         
         // If not in pool, add it
         if (this->pages.size() >= BLOCK_COUNT) {
+            this->statistics.evictions++;
             // Check if the page we're about to evict is an index page
             string frontPageName = this->pages.front().pageName;
             bool isIndexPage = frontPageName.find("_index") != string::npos || 
@@ -460,7 +618,9 @@ void BufferManager::deleteFile(string fileName)
 
 /**
  * @brief Overloaded function that calls deleteFile(fileName) by constructing
- * the fileName from the tableName and pageIndex.
+ * the fileName from the tableName and pageIndex. Pages of a column layout
+ * table live in its column segments, which are cut off at the page instead;
+ * pages are only ever deleted from the end of a table.
  *
  * @param tableName 
  * @param pageIndex 
@@ -470,6 +630,11 @@ void BufferManager::deleteFile(string tableName, int pageIndex)
     logger.log("BufferManager::deleteFile");
     string fileName = "../data/temp/"+tableName + "_Page" + to_string(pageIndex);
     this->deleteFile(fileName);
+    if (tableCatalogue.isTable(tableName)) {
+        Table *table = tableCatalogue.getTable(tableName);
+        if (table && table->pageLayout == COLUMN_LAYOUT)
+            truncateColumns(tableName, pageIndex, table->columnCount);
+    }
 }
 
 /**
@@ -480,6 +645,8 @@ void BufferManager::deleteFile(string tableName, int pageIndex)
 void BufferManager::deletePage(string pageName)
 {
     logger.log("BufferManager::deletePage");
+    lock_guard<mutex> lock(this->poolMutex);
+    this->dropColumnCopies(pageName);
     for (auto it = this->pages.begin(); it != this->pages.end(); ++it)
     {
         if (it->pageName == pageName)
@@ -491,3 +658,23 @@ void BufferManager::deletePage(string pageName)
     }
     logger.log("BufferManager::deletePage: Page not found in buffer");
 }
+
+/**
+ * @brief Drops the copies of a page holding only some of its columns from the
+ * pool, which go stale when the page is written or deleted. Must be called
+ * with the pool locked.
+ *
+ * @param pageName
+ */
+void BufferManager::dropColumnCopies(string pageName)
+{
+    logger.log("BufferManager::dropColumnCopies");
+    string prefix = pageName + "{";
+    for (auto it = this->pages.begin(); it != this->pages.end();)
+    {
+        if (it->pageName.compare(0, prefix.size(), prefix) == 0)
+            it = this->pages.erase(it);
+        else
+            ++it;
+    }
+}
@@ -1,5 +1,25 @@
 #include"page.h"
 
+/**
+ * @brief Running totals of the buffer manager's work since the server started:
+ * page requests answered from the pool (hits) or read from disk (misses), pages
+ * pushed out of a full pool (evictions), and pages and bytes moved to and from
+ * disk. The pool writes through, so pages are never dirty when they are
+ * evicted; every write back happens in writePage and counts as a page written.
+ * EXPLAIN ANALYZE reports the difference over each operator, SHOW STATS the
+ * totals.
+ *
+ */
+struct BufferStatistics
+{
+    long long hits = 0;
+    long long misses = 0;
+    long long evictions = 0;
+    long long pagesWritten = 0;
+    long long bytesRead = 0;
+    long long bytesWritten = 0;
+};
+
 /**
  * @brief The BufferManager is responsible for reading pages to the main memory.
  * Recall that large files are broken and stored as blocks in the hard disk. The
@@ -18,6 +38,11 @@
  * be transparent to the executors i.e. the executor should not know if a block
  * was previously present in the buffer or was read in from the disk. 
  * </p>
+ * <p>
+ * getPage(tableName, pageIndex), writePage(tableName, ...) and deletePage may
+ * be called from several threads; the pool is locked while it is searched or
+ * changed, but not while a page file is read or written.
+ * </p>
  *
  */
 class BufferManager{
@@ -27,24 +52,36 @@ class BufferManager{
     Page getFromPool(string pageName);
     Page insertIntoPool(string tableName, int pageIndex);
     Page insertIntoPool(string tableName, int pageIndex, int is_matrix);
+    void dropColumnCopies(string pageName);
     
     // Set of tables that are currently being indexed
     // This helps prevent evicting pages from tables that are being indexed
     unordered_set<string> tablesBeingIndexed;
+    // Guards pages for the worker threads of the external sort
+    mutex poolMutex;
+    BufferStatistics statistics;
+    chrono::steady_clock::time_point lastMetricsDump = chrono::steady_clock::now();
 
     public:
     
     BufferManager();
     Page getPage(string tableName, int pageIndex);
+    Page getPage(string tableName, int pageIndex, vector<int> columnIndexes);
     Page getPage(string matrixName, int pageIndex, int is_matrix);
     void writePage(string pageName, vector<vector<int>> rows);
     void deleteFile(string tableName, int pageIndex);
     void deleteFile(string fileName);
     void deletePage(string pageName);
-    void writePage(string tableName, int pageIndex, vector<vector<int>> rows, int rowCount);
+    void writePage(string tableName, int pageIndex, vector<vector<int>> rows, int rowCount, PageLayout layout = ROW_LAYOUT);
     
     // Methods to mark tables as being indexed
     void markTableAsBeingIndexed(string tableName);
     void unmarkTableAsBeingIndexed(string tableName);
     bool isTableBeingIndexed(string tableName);
+
+    BufferStatistics getStatistics();
+    vector<string> getPoolPageNames();
+    map<string, uint> getResidentPageCounts();
+    bool writeMetrics(string fileName);
+    void dumpMetricsIfDue(bool force = false);
 };
\ No newline at end of file
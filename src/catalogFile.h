@@ -0,0 +1,64 @@
+#ifndef CATALOGFILE_H
+#define CATALOGFILE_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief Helpers for the binary catalog written by TableCatalogue::checkpoint.
+ * Fixed size values are written as they are in memory, strings and vectors of
+ * them as their length followed by their contents. Reads return false once
+ * the stream has failed, so a truncated catalog is noticed.
+ *
+ */
+template <typename T>
+void writeCatalogValue(ostream &fout, const T &value)
+{
+    fout.write((const char *)&value, sizeof(value));
+}
+
+template <typename T>
+bool readCatalogValue(istream &fin, T &value)
+{
+    fin.read((char *)&value, sizeof(value));
+    return (bool)fin;
+}
+
+template <typename T>
+void writeCatalogVector(ostream &fout, const vector<T> &values)
+{
+    writeCatalogValue<unsigned long long>(fout, values.size());
+    fout.write((const char *)values.data(), values.size() * sizeof(T));
+}
+
+template <typename T>
+bool readCatalogVector(istream &fin, vector<T> &values)
+{
+    unsigned long long size;
+    if (!readCatalogValue(fin, size))
+        return false;
+    values.resize(size);
+    fin.read((char *)values.data(), size * sizeof(T));
+    return (bool)fin;
+}
+
+inline void writeCatalogString(ostream &fout, const string &value)
+{
+    writeCatalogValue<unsigned long long>(fout, value.size());
+    fout.write(value.data(), value.size());
+}
+
+inline bool readCatalogString(istream &fin, string &value)
+{
+    unsigned long long size;
+    if (!readCatalogValue(fin, size))
+        return false;
+    value.resize(size);
+    fin.read(&value[0], size);
+    return (bool)fin;
+}
+
+#endif // CATALOGFILE_H
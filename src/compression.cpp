@@ -0,0 +1,465 @@
+#include "global.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define COMPRESSION_HAS_X86_KERNELS
+#endif
+
+/**
+ * @brief File contains the lightweight integer encodings of compressed pages.
+ * encodeColumn computes the size of every encoding from a single pass of
+ * statistics (range, distinct values, runs and the range of the differences)
+ * and only builds the smallest one. Decoding unpacks the codes 8 at a time
+ * with AVX2 gathers when the CPU supports it, and comparisons against a
+ * literal are evaluated on the codes where the encoding allows:
+ *
+ * - FOR and DICTIONARY turn the literal into a range of codes, which the
+ *   unpacked codes are tested against without reconstructing any value
+ * - RLE tests every run once
+ * - PLAIN and DELTA are decoded and go through the filter kernels
+ */
+
+// Size of the encoding and bit width written by writeEncodedColumn
+static const size_t ENCODED_HEADER_SIZE = 2;
+// Bytes read past the last code by a single 8 byte load
+static const size_t PACKED_PADDING = 8;
+// Widest code the AVX2 unpacker reads with a 4 byte gather
+static const uint8_t MAX_GATHER_WIDTH = 25;
+
+static uint8_t getBitWidth(unsigned long long range)
+{
+    uint8_t width = 0;
+    while (width < 64 && (range >> width))
+        width++;
+    return width;
+}
+
+static size_t getPackedSize(uint count, uint8_t bitWidth)
+{
+    return ((unsigned long long)count * bitWidth + 7) / 8;
+}
+
+// Size of the fields writeEncodedColumn writes between the header and the data
+static size_t getFieldsSize(ColumnEncoding encoding)
+{
+    switch (encoding)
+    {
+    case FOR_ENCODING:
+        return sizeof(int);
+    case DELTA_ENCODING:
+        return 2 * sizeof(int);
+    case RLE_ENCODING:
+    case DICTIONARY_ENCODING:
+        return sizeof(uint);
+    default:
+        return 0;
+    }
+}
+
+static void packCodes(const vector<uint> &codes, uint8_t bitWidth, vector<uint8_t> &packed)
+{
+    packed.assign(getPackedSize(codes.size(), bitWidth) + PACKED_PADDING, 0);
+    if (bitWidth == 0)
+        return;
+    for (uint position = 0; position < codes.size(); position++)
+    {
+        unsigned long long bit = (unsigned long long)position * bitWidth;
+        unsigned long long word;
+        memcpy(&word, &packed[bit >> 3], sizeof(word));
+        word |= (unsigned long long)codes[position] << (bit & 7);
+        memcpy(&packed[bit >> 3], &word, sizeof(word));
+    }
+}
+
+static void unpackScalar(const uint8_t *packed, uint8_t bitWidth, uint first, uint count, int base, int *values)
+{
+    uint mask = bitWidth >= 32 ? UINT_MAX : (1u << bitWidth) - 1;
+    for (uint position = first; position < count; position++)
+    {
+        unsigned long long bit = (unsigned long long)position * bitWidth;
+        unsigned long long word;
+        memcpy(&word, packed + (bit >> 3), sizeof(word));
+        values[position] = (int)((uint)base + ((uint)(word >> (bit & 7)) & mask));
+    }
+}
+
+#ifdef COMPRESSION_HAS_X86_KERNELS
+
+/**
+ * @brief Unpacks 8 codes at a time: every lane gathers the 4 bytes its code
+ * starts in, shifts it down to the first bit and masks it. Codes of up to 25
+ * bits always lie within those 4 bytes.
+ *
+ * @return uint number of values unpacked, a multiple of 8
+ */
+__attribute__((target("avx2"))) static uint unpackAVX2(const uint8_t *packed, uint8_t bitWidth, uint count, int base, int *values)
+{
+    __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i laneBits = _mm256_mullo_epi32(lanes, _mm256_set1_epi32(bitWidth));
+    __m256i mask = _mm256_set1_epi32((1u << bitWidth) - 1);
+    __m256i seven = _mm256_set1_epi32(7);
+    __m256i baseVector = _mm256_set1_epi32(base);
+    uint position = 0;
+    for (; position + 8 <= count; position += 8)
+    {
+        __m256i bits = _mm256_add_epi32(laneBits, _mm256_set1_epi32(position * bitWidth));
+        __m256i bytes = _mm256_i32gather_epi32((const int *)packed, _mm256_srli_epi32(bits, 3), 1);
+        __m256i codes = _mm256_and_si256(_mm256_srlv_epi32(bytes, _mm256_and_si256(bits, seven)), mask);
+        _mm256_storeu_si256((__m256i *)(values + position), _mm256_add_epi32(codes, baseVector));
+    }
+    return position;
+}
+
+#endif // COMPRESSION_HAS_X86_KERNELS
+
+/**
+ * @brief Unpacks count codes and adds base to every one of them.
+ *
+ */
+static void unpackCodes(const EncodedColumn &column, int base, int *values)
+{
+    uint first = 0;
+#ifdef COMPRESSION_HAS_X86_KERNELS
+    // The gather offsets are 32 bit, so only pages of under 2^31 bits qualify
+    if (column.bitWidth > 0 && column.bitWidth <= MAX_GATHER_WIDTH && getFilterKernelLevel() == AVX2_KERNELS &&
+        (unsigned long long)column.count * column.bitWidth < INT_MAX)
+        first = unpackAVX2(column.packed.data(), column.bitWidth, column.count, base, values);
+#endif
+    unpackScalar(column.packed.data(), column.bitWidth, first, column.count, base, values);
+}
+
+/**
+ * @brief Picks the encoding that stores the values in the fewest bytes and
+ * encodes them in it.
+ *
+ * @param values
+ * @param count
+ * @return EncodedColumn
+ */
+EncodedColumn encodeColumn(const int *values, uint count)
+{
+    EncodedColumn column;
+    column.count = count;
+    if (count == 0)
+        return column;
+
+    int minValue = values[0], maxValue = values[0];
+    long long minDelta = 0, maxDelta = 0;
+    uint runCount = 1;
+    for (uint position = 1; position < count; position++)
+    {
+        minValue = min(minValue, values[position]);
+        maxValue = max(maxValue, values[position]);
+        long long delta = (long long)values[position] - values[position - 1];
+        minDelta = position == 1 ? delta : min(minDelta, delta);
+        maxDelta = position == 1 ? delta : max(maxDelta, delta);
+        runCount += values[position] != values[position - 1];
+    }
+    vector<int> dictionary(values, values + count);
+    sort(dictionary.begin(), dictionary.end());
+    dictionary.erase(unique(dictionary.begin(), dictionary.end()), dictionary.end());
+
+    uint8_t forWidth = getBitWidth((unsigned long long)((long long)maxValue - minValue));
+    uint8_t deltaWidth = getBitWidth((unsigned long long)(maxDelta - minDelta));
+    uint8_t dictionaryWidth = getBitWidth(dictionary.size() - 1);
+    size_t sizes[] = {
+        (size_t)count * sizeof(int),
+        getPackedSize(count, forWidth),
+        deltaWidth <= 32 ? getPackedSize(count, deltaWidth) : SIZE_MAX,
+        (size_t)runCount * (sizeof(int) + sizeof(uint)),
+        dictionary.size() * sizeof(int) + getPackedSize(count, dictionaryWidth)};
+    int best = PLAIN_ENCODING;
+    for (int encoding = FOR_ENCODING; encoding <= DICTIONARY_ENCODING; encoding++)
+        if (sizes[encoding] != SIZE_MAX && sizes[encoding] + getFieldsSize((ColumnEncoding)encoding) < sizes[best])
+            best = encoding;
+    column.encoding = (ColumnEncoding)best;
+
+    vector<uint> codes;
+    switch (column.encoding)
+    {
+    case PLAIN_ENCODING:
+        column.values.assign(values, values + count);
+        break;
+    case FOR_ENCODING:
+        column.base = minValue;
+        column.bitWidth = forWidth;
+        for (uint position = 0; position < count; position++)
+            codes.push_back((uint)values[position] - (uint)minValue);
+        packCodes(codes, forWidth, column.packed);
+        break;
+    case DELTA_ENCODING:
+        column.base = values[0];
+        column.deltaBase = (int)minDelta;
+        column.bitWidth = deltaWidth;
+        codes.push_back(0);
+        for (uint position = 1; position < count; position++)
+            codes.push_back((uint)((long long)values[position] - values[position - 1] - minDelta));
+        packCodes(codes, deltaWidth, column.packed);
+        break;
+    case RLE_ENCODING:
+        for (uint position = 0; position < count; position++)
+        {
+            if (position > 0 && values[position] == values[position - 1])
+                column.runEnds.back() = position + 1;
+            else
+            {
+                column.values.push_back(values[position]);
+                column.runEnds.push_back(position + 1);
+            }
+        }
+        break;
+    case DICTIONARY_ENCODING:
+        column.bitWidth = dictionaryWidth;
+        for (uint position = 0; position < count; position++)
+            codes.push_back(lower_bound(dictionary.begin(), dictionary.end(), values[position]) - dictionary.begin());
+        column.values = dictionary;
+        packCodes(codes, dictionaryWidth, column.packed);
+        break;
+    }
+    return column;
+}
+
+/**
+ * @brief Reconstructs the count values of an encoded column.
+ *
+ * @param column
+ * @param values room for column.count values
+ */
+void decodeColumn(const EncodedColumn &column, int *values)
+{
+    switch (column.encoding)
+    {
+    case PLAIN_ENCODING:
+        copy(column.values.begin(), column.values.end(), values);
+        break;
+    case FOR_ENCODING:
+        unpackCodes(column, column.base, values);
+        break;
+    case DELTA_ENCODING:
+        unpackCodes(column, column.deltaBase, values);
+        if (column.count > 0)
+            values[0] = column.base;
+        for (uint position = 1; position < column.count; position++)
+            values[position] = (int)((uint)values[position - 1] + (uint)values[position]);
+        break;
+    case RLE_ENCODING:
+    {
+        uint position = 0;
+        for (uint run = 0; run < column.values.size(); run++)
+            for (; position < column.runEnds[run]; position++)
+                values[position] = column.values[run];
+        break;
+    }
+    case DICTIONARY_ENCODING:
+        unpackCodes(column, 0, values);
+        for (uint position = 0; position < column.count; position++)
+            values[position] = column.values[values[position]];
+        break;
+    }
+}
+
+/**
+ * @brief Range [lowest, highest] of the values that satisfy value op literal;
+ * for NOT_EQUAL the range of the values that don't.
+ *
+ */
+static void getQualifyingRange(BinaryOperator op, int literal, long long &lowest, long long &highest)
+{
+    lowest = INT_MIN;
+    highest = INT_MAX;
+    if (op == LESS_THAN)
+        highest = (long long)literal - 1;
+    else if (op == LEQ)
+        highest = literal;
+    else if (op == GREATER_THAN)
+        lowest = (long long)literal + 1;
+    else if (op == GEQ)
+        lowest = literal;
+    else
+        lowest = highest = literal;
+}
+
+/**
+ * @brief Selects the positions whose code lies in [lowest, highest], or
+ * outside of it if negate is set. Branch-free, like the scalar filter kernel.
+ *
+ */
+static uint selectCodes(const int *codes, uint count, long long lowest, long long highest, bool negate, uint *selection)
+{
+    uint selected = 0;
+    if (lowest > highest)
+    {
+        if (negate)
+            for (uint position = 0; position < count; position++)
+                selection[selected++] = position;
+        return selected;
+    }
+    unsigned long long width = highest - lowest;
+    for (uint position = 0; position < count; position++)
+    {
+        selection[selected] = position;
+        selected += ((unsigned long long)((long long)(uint)codes[position] - lowest) <= width) != negate;
+    }
+    return selected;
+}
+
+/**
+ * @brief Evaluates column op literal on an encoded column and writes the
+ * positions of the qualifying values to selection, ascending.
+ *
+ * @param column
+ * @param op
+ * @param literal
+ * @param selection room for column.count positions
+ * @return uint number of qualifying positions
+ */
+uint filterEncodedColumn(const EncodedColumn &column, BinaryOperator op, int literal, uint *selection)
+{
+    long long lowest, highest;
+    getQualifyingRange(op, literal, lowest, highest);
+    bool negate = op == NOT_EQUAL;
+    vector<int> codes(column.count);
+    uint selected = 0;
+    switch (column.encoding)
+    {
+    case FOR_ENCODING:
+        unpackCodes(column, 0, codes.data());
+        return selectCodes(codes.data(), column.count, max(lowest - column.base, 0LL), min(highest - column.base, (long long)UINT_MAX), negate, selection);
+    case DICTIONARY_ENCODING:
+    {
+        // The dictionary is sorted, so the qualifying values have consecutive codes
+        long long firstCode = lower_bound(column.values.begin(), column.values.end(), lowest) - column.values.begin();
+        long long endCode = upper_bound(column.values.begin(), column.values.end(), highest) - column.values.begin();
+        unpackCodes(column, 0, codes.data());
+        return selectCodes(codes.data(), column.count, firstCode, endCode - 1, negate, selection);
+    }
+    case RLE_ENCODING:
+    {
+        uint position = 0;
+        for (uint run = 0; run < column.values.size(); run++)
+        {
+            if (evaluateBinOp(column.values[run], literal, op))
+                for (uint row = position; row < column.runEnds[run]; row++)
+                    selection[selected++] = row;
+            position = column.runEnds[run];
+        }
+        return selected;
+    }
+    default:
+        decodeColumn(column, codes.data());
+        return getScanFilter(op, false)(codes.data(), nullptr, literal, column.count, selection);
+    }
+}
+
+/**
+ * @brief Number of bytes writeEncodedColumn writes for the column.
+ *
+ * @param column
+ * @return size_t
+ */
+size_t getEncodedSize(const EncodedColumn &column)
+{
+    return ENCODED_HEADER_SIZE + getFieldsSize(column.encoding) + column.values.size() * sizeof(int) +
+           column.runEnds.size() * sizeof(uint) + getPackedSize(column.count, column.bitWidth);
+}
+
+template <typename T>
+static void appendValue(string &buffer, T value)
+{
+    buffer.append((const char *)&value, sizeof(value));
+}
+
+template <typename T>
+static bool readValue(const char *&data, const char *end, T &value)
+{
+    if (end - data < (long)sizeof(value))
+        return false;
+    memcpy(&value, data, sizeof(value));
+    data += sizeof(value);
+    return true;
+}
+
+/**
+ * @brief Appends the column to buffer: encoding and bit width, then only
+ * what the encoding needs. The count isn't written, every column of a page
+ * has the page's row count.
+ *
+ * - PLAIN: the values
+ * - FOR: base, packed codes
+ * - DELTA: base, delta base, packed codes
+ * - RLE: run count, values, run ends
+ * - DICTIONARY: dictionary size, dictionary, packed codes
+ *
+ * @param column
+ * @param buffer
+ */
+void writeEncodedColumn(const EncodedColumn &column, string &buffer)
+{
+    appendValue<uint8_t>(buffer, column.encoding);
+    appendValue<uint8_t>(buffer, column.bitWidth);
+    if (column.encoding == FOR_ENCODING || column.encoding == DELTA_ENCODING)
+        appendValue<int>(buffer, column.base);
+    if (column.encoding == DELTA_ENCODING)
+        appendValue<int>(buffer, column.deltaBase);
+    if (column.encoding == RLE_ENCODING || column.encoding == DICTIONARY_ENCODING)
+        appendValue<uint>(buffer, column.values.size());
+    buffer.append((const char *)column.values.data(), column.values.size() * sizeof(int));
+    buffer.append((const char *)column.runEnds.data(), column.runEnds.size() * sizeof(uint));
+    buffer.append((const char *)column.packed.data(), min(getPackedSize(column.count, column.bitWidth), column.packed.size()));
+}
+
+/**
+ * @brief Reads a column of count values written by writeEncodedColumn.
+ *
+ * @param data
+ * @param size
+ * @param count
+ * @param column
+ * @return false if the data is truncated or malformed
+ */
+bool readEncodedColumn(const char *data, size_t size, uint count, EncodedColumn &column)
+{
+    const char *end = data + size;
+    uint8_t encoding;
+    if (!readValue(data, end, encoding) || encoding > DICTIONARY_ENCODING || !readValue(data, end, column.bitWidth) ||
+        column.bitWidth > 32)
+        return false;
+    column.encoding = (ColumnEncoding)encoding;
+    column.count = count;
+    if ((encoding == FOR_ENCODING || encoding == DELTA_ENCODING) && !readValue(data, end, column.base))
+        return false;
+    if (encoding == DELTA_ENCODING && !readValue(data, end, column.deltaBase))
+        return false;
+    uint valueCount = encoding == PLAIN_ENCODING ? count : 0;
+    if ((encoding == RLE_ENCODING || encoding == DICTIONARY_ENCODING) && !readValue(data, end, valueCount))
+        return false;
+    uint runCount = encoding == RLE_ENCODING ? valueCount : 0;
+    size_t packedSize = encoding == PLAIN_ENCODING || encoding == RLE_ENCODING ? 0 : getPackedSize(count, column.bitWidth);
+    if ((size_t)(end - data) != (size_t)valueCount * sizeof(int) + (size_t)runCount * sizeof(uint) + packedSize)
+        return false;
+    column.values.assign((const int *)data, (const int *)data + valueCount);
+    data += (size_t)valueCount * sizeof(int);
+    column.runEnds.assign((const uint *)data, (const uint *)data + runCount);
+    data += (size_t)runCount * sizeof(uint);
+    column.packed.assign(packedSize + PACKED_PADDING, 0);
+    memcpy(column.packed.data(), data, packedSize);
+    if (encoding == RLE_ENCODING && (runCount == 0 ? count != 0 : column.runEnds.back() != count))
+        return false;
+    return true;
+}
+
+string getEncodingName(ColumnEncoding encoding)
+{
+    switch (encoding)
+    {
+    case FOR_ENCODING:
+        return "FOR";
+    case DELTA_ENCODING:
+        return "DELTA";
+    case RLE_ENCODING:
+        return "RLE";
+    case DICTIONARY_ENCODING:
+        return "DICTIONARY";
+    default:
+        return "PLAIN";
+    }
+}
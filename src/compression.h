@@ -0,0 +1,57 @@
+#ifndef COMPRESSION_H
+#define COMPRESSION_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "enums.h"
+
+using namespace std;
+
+enum ColumnEncoding : uint8_t
+{
+    PLAIN_ENCODING,
+    FOR_ENCODING,
+    DELTA_ENCODING,
+    RLE_ENCODING,
+    DICTIONARY_ENCODING
+};
+
+/**
+ * @brief One column of a compressed page, in the encoding that stores it in
+ * the fewest bytes:
+ *
+ * - PLAIN: the values as they are, in values
+ * - FOR (frame of reference): every value minus base, bit-packed in bitWidth
+ *   bits
+ * - DELTA: the first value in base, then every value's difference to the one
+ *   before it minus deltaBase, bit-packed
+ * - RLE: the value of every run in values and the position after its last
+ *   row in runEnds
+ * - DICTIONARY: the distinct values, ascending, in values and the index of
+ *   every value among them, bit-packed
+ *
+ * Codes are packed least significant bit first into packed, which is followed
+ * by 8 bytes of padding so that any code can be read with one 8 byte load.
+ */
+struct EncodedColumn
+{
+    ColumnEncoding encoding = PLAIN_ENCODING;
+    uint count = 0;
+    uint8_t bitWidth = 0;
+    int base = 0;
+    int deltaBase = 0;
+    vector<int> values;
+    vector<uint> runEnds;
+    vector<uint8_t> packed;
+};
+
+EncodedColumn encodeColumn(const int *values, uint count);
+void decodeColumn(const EncodedColumn &column, int *values);
+uint filterEncodedColumn(const EncodedColumn &column, BinaryOperator op, int literal, uint *selection);
+size_t getEncodedSize(const EncodedColumn &column);
+void writeEncodedColumn(const EncodedColumn &column, string &buffer);
+bool readEncodedColumn(const char *data, size_t size, uint count, EncodedColumn &column);
+string getEncodingName(ColumnEncoding encoding);
+
+#endif // COMPRESSION_H
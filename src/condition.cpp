@@ -0,0 +1,317 @@
+#include "global.h"
+
+/**
+ * @brief File contains the parser of the conditions of SELECT, SEARCH and
+ * DELETE:
+ *
+ *      condition -> conjunction | condition OR conjunction
+ *      conjunction -> term | conjunction AND term
+ *      term -> comparison | ( condition )
+ *      comparison -> column_name binop column_name
+ *                  | column_name binop int_literal
+ *                  | column_name IN ( int_literal_list )
+ *
+ * The tokenizer only splits on whitespace and commas, so parentheses may be
+ * glued to the tokens next to them and are split off first. An IN list
+ * becomes the OR of one equality per value.
+ */
+
+/**
+ * @brief Maps the spelling of a comparison operator to its BinaryOperator.
+ *
+ * @param binaryOperator
+ * @return BinaryOperator NO_BINOP_CLAUSE if it isn't an operator
+ */
+BinaryOperator parseBinaryOperator(const string &binaryOperator)
+{
+    if (binaryOperator == "<")
+        return LESS_THAN;
+    if (binaryOperator == ">")
+        return GREATER_THAN;
+    if (binaryOperator == ">=" || binaryOperator == "=>")
+        return GEQ;
+    if (binaryOperator == "<=" || binaryOperator == "=<")
+        return LEQ;
+    if (binaryOperator == "==")
+        return EQUAL;
+    if (binaryOperator == "!=")
+        return NOT_EQUAL;
+    return NO_BINOP_CLAUSE;
+}
+
+string binaryOperatorToString(BinaryOperator binaryOperator)
+{
+    switch (binaryOperator)
+    {
+    case LESS_THAN:
+        return "<";
+    case GREATER_THAN:
+        return ">";
+    case LEQ:
+        return "<=";
+    case GEQ:
+        return ">=";
+    case EQUAL:
+        return "==";
+    case NOT_EQUAL:
+        return "!=";
+    default:
+        return "?";
+    }
+}
+
+/**
+ * @brief Converts a token matching [-]?[0-9]+ to a long long.
+ *
+ * @return false, after reporting it, if the value doesn't fit in a long long
+ */
+bool parseIntLiteral(const string &token, long long &value)
+{
+    try
+    {
+        value = stoll(token);
+        return true;
+    }
+    catch (const out_of_range &)
+    {
+        cout << "SYNTAX ERROR: Integer literal out of range: " << token << endl;
+        return false;
+    }
+}
+
+/**
+ * @brief Converts a token matching [-]?[0-9]+ to an int.
+ *
+ * @return false, after reporting it, if the value doesn't fit in an int
+ */
+bool parseIntLiteral(const string &token, int &value)
+{
+    long long wideValue;
+    if (!parseIntLiteral(token, wideValue))
+        return false;
+    if (wideValue < INT_MIN || wideValue > INT_MAX)
+    {
+        cout << "SYNTAX ERROR: Integer literal out of range: " << token << endl;
+        return false;
+    }
+    value = wideValue;
+    return true;
+}
+
+/**
+ * @brief Recursive descent parser over the tokens of a condition. Every parse
+ * function consumes what it recognised and returns false on a syntax error.
+ *
+ */
+class ConditionParser
+{
+    vector<string> tokens;
+    uint position = 0;
+
+    bool accept(const string &token)
+    {
+        if (this->position < this->tokens.size() && this->tokens[this->position] == token)
+        {
+            this->position++;
+            return true;
+        }
+        return false;
+    }
+
+    bool parseInList(Condition &condition)
+    {
+        static const regex numeric("[-]?[0-9]+");
+        string columnName = this->tokens[this->position];
+        this->position += 2;
+        if (!this->accept("("))
+            return false;
+        condition = Condition();
+        condition.type = OR_CONDITION;
+        while (this->position < this->tokens.size() && regex_match(this->tokens[this->position], numeric))
+        {
+            Condition equality;
+            equality.comparison.firstColumnName = columnName;
+            equality.comparison.binaryOperator = EQUAL;
+            if (!parseIntLiteral(this->tokens[this->position++], equality.comparison.intLiteral))
+                return false;
+            condition.children.push_back(equality);
+        }
+        if (condition.children.empty() || !this->accept(")"))
+            return false;
+        if (condition.children.size() == 1)
+            condition = Condition(condition.children[0]);
+        return true;
+    }
+
+    bool parseComparison(Condition &condition)
+    {
+        if (this->position + 3 > this->tokens.size())
+            return false;
+        if (this->tokens[this->position + 1] == "IN")
+            return this->parseInList(condition);
+        static const regex numeric("[-]?[0-9]+");
+        Comparison &comparison = condition.comparison;
+        condition.type = COMPARISON_CONDITION;
+        comparison.firstColumnName = this->tokens[this->position];
+        comparison.binaryOperator = parseBinaryOperator(this->tokens[this->position + 1]);
+        string secondArgument = this->tokens[this->position + 2];
+        this->position += 3;
+        if (comparison.binaryOperator == NO_BINOP_CLAUSE)
+        {
+            cout << "SYNTAX ERROR: Invalid binary operator" << endl;
+            return false;
+        }
+        for (const string &name : {comparison.firstColumnName, secondArgument})
+            if (name == "(" || name == ")" || name == "AND" || name == "OR")
+                return false;
+        if (regex_match(secondArgument, numeric))
+        {
+            comparison.compareColumns = false;
+            if (!parseIntLiteral(secondArgument, comparison.intLiteral))
+                return false;
+        }
+        else
+        {
+            comparison.compareColumns = true;
+            comparison.secondColumnName = secondArgument;
+        }
+        return true;
+    }
+
+    bool parseTerm(Condition &condition)
+    {
+        if (!this->accept("("))
+            return this->parseComparison(condition);
+        return this->parseDisjunction(condition) && this->accept(")");
+    }
+
+    bool parseOperand(Condition &condition, ConditionType type)
+    {
+        if (type == OR_CONDITION)
+            return this->parseConjunction(condition);
+        return this->parseTerm(condition);
+    }
+
+    /**
+     * @brief Parses operand (separator operand)* into condition, as one node
+     * of the given type if there is more than one operand.
+     *
+     */
+    bool parseList(Condition &condition, ConditionType type, const string &separator)
+    {
+        vector<Condition> operands(1);
+        if (!this->parseOperand(operands.back(), type))
+            return false;
+        while (this->accept(separator))
+        {
+            operands.emplace_back();
+            if (!this->parseOperand(operands.back(), type))
+                return false;
+        }
+        if (operands.size() == 1)
+        {
+            condition = operands[0];
+            return true;
+        }
+        condition = Condition();
+        condition.type = type;
+        for (const Condition &operand : operands)
+        {
+            if (operand.type == type)
+                condition.children.insert(condition.children.end(), operand.children.begin(), operand.children.end());
+            else
+                condition.children.push_back(operand);
+        }
+        return true;
+    }
+
+    bool parseConjunction(Condition &condition)
+    {
+        return this->parseList(condition, AND_CONDITION, "AND");
+    }
+
+    bool parseDisjunction(Condition &condition)
+    {
+        return this->parseList(condition, OR_CONDITION, "OR");
+    }
+
+public:
+    ConditionParser(const vector<string> &queryTokens)
+    {
+        for (const string &token : queryTokens)
+        {
+            string name = "";
+            for (char character : token)
+            {
+                if (character != '(' && character != ')')
+                {
+                    name += character;
+                    continue;
+                }
+                if (!name.empty())
+                    this->tokens.push_back(name);
+                name = "";
+                this->tokens.push_back(string(1, character));
+            }
+            if (!name.empty())
+                this->tokens.push_back(name);
+        }
+    }
+
+    bool parse(Condition &condition)
+    {
+        return this->parseDisjunction(condition) && this->position == this->tokens.size();
+    }
+};
+
+/**
+ * @brief Parses the tokens of a condition into a predicate tree.
+ *
+ * @param tokens
+ * @param condition
+ * @return true if the tokens form a condition
+ */
+bool parseCondition(const vector<string> &tokens, Condition &condition)
+{
+    logger.log("parseCondition");
+    ConditionParser parser(tokens);
+    condition = Condition();
+    return parser.parse(condition);
+}
+
+string conditionToString(const Condition &condition)
+{
+    if (condition.type == COMPARISON_CONDITION)
+    {
+        const Comparison &comparison = condition.comparison;
+        return comparison.firstColumnName + " " + binaryOperatorToString(comparison.binaryOperator) + " " +
+               (comparison.compareColumns ? comparison.secondColumnName : to_string(comparison.intLiteral));
+    }
+    string text = "";
+    for (const Condition &child : condition.children)
+    {
+        if (!text.empty())
+            text += condition.type == AND_CONDITION ? " AND " : " OR ";
+        text += child.type == COMPARISON_CONDITION ? conditionToString(child) : "(" + conditionToString(child) + ")";
+    }
+    return text;
+}
+
+/**
+ * @brief Appends the names of all columns the condition refers to.
+ *
+ * @param condition
+ * @param columnNames
+ */
+void getConditionColumns(const Condition &condition, vector<string> &columnNames)
+{
+    if (condition.type != COMPARISON_CONDITION)
+    {
+        for (const Condition &child : condition.children)
+            getConditionColumns(child, columnNames);
+        return;
+    }
+    columnNames.push_back(condition.comparison.firstColumnName);
+    if (condition.comparison.compareColumns)
+        columnNames.push_back(condition.comparison.secondColumnName);
+}
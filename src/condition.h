@@ -0,0 +1,57 @@
+#ifndef CONDITION_H
+#define CONDITION_H
+
+#include <string>
+#include <vector>
+#include "enums.h"
+
+using namespace std;
+
+/**
+ * @brief One comparison of a WHERE condition: column_name bin_op int_literal,
+ * or column_name bin_op column_name when compareColumns is set.
+ *
+ */
+struct Comparison
+{
+    string firstColumnName = "";
+    BinaryOperator binaryOperator = NO_BINOP_CLAUSE;
+    bool compareColumns = false;
+    string secondColumnName = "";
+    int intLiteral = 0;
+};
+
+enum ConditionType
+{
+    COMPARISON_CONDITION,
+    AND_CONDITION,
+    OR_CONDITION
+};
+
+/**
+ * @brief Predicate tree of the condition of SELECT, SEARCH and DELETE. A leaf
+ * is a single comparison, inner nodes are the AND or OR of their children.
+ * AND binds tighter than OR and parentheses group, so
+ *
+ *      a > 5 AND ( b == 3 OR c < d )
+ *
+ * is an AND node over a comparison and an OR node. Nested nodes of the same
+ * type are flattened into one while parsing.
+ *
+ */
+struct Condition
+{
+    ConditionType type = COMPARISON_CONDITION;
+    Comparison comparison;
+    vector<Condition> children;
+};
+
+BinaryOperator parseBinaryOperator(const string &binaryOperator);
+string binaryOperatorToString(BinaryOperator binaryOperator);
+bool parseIntLiteral(const string &token, long long &value);
+bool parseIntLiteral(const string &token, int &value);
+bool parseCondition(const vector<string> &tokens, Condition &condition);
+string conditionToString(const Condition &condition);
+void getConditionColumns(const Condition &condition, vector<string> &columnNames);
+
+#endif // CONDITION_H
@@ -9,6 +9,24 @@ Cursor::Cursor(string tableName, int pageIndex)
     this->pageIndex = pageIndex;
 }
 
+/**
+ * @brief Cursor that only needs the given columns of the rows; the others may
+ * read as 0. Pages in the column layout then only read those columns.
+ *
+ * @param tableName
+ * @param pageIndex
+ * @param columnIndexes
+ */
+Cursor::Cursor(string tableName, int pageIndex, const vector<int> &columnIndexes)
+{
+    logger.log("Cursor::Cursor");
+    this->columnIndexes = columnIndexes;
+    this->page = bufferManager.getPage(tableName, pageIndex, columnIndexes);
+    this->pagePointer = 0;
+    this->tableName = tableName;
+    this->pageIndex = pageIndex;
+}
+
 Cursor::Cursor(string matrixName, int pageIndex, int is_matrix)
 {
     logger.log("Cursor :: MatrixCursor");
@@ -73,7 +91,7 @@ void Cursor::nextPage(int pageIndex)
     if (this->is_it_matrix == 1)
         this->page = bufferManager.getPage(this->tableName, pageIndex, 1);
     else
-        this->page = bufferManager.getPage(this->tableName, pageIndex);
+        this->page = bufferManager.getPage(this->tableName, pageIndex, this->columnIndexes);
     this->pageIndex = pageIndex;
     this->pagePointer = 0;
 }
\ No newline at end of file
@@ -12,9 +12,12 @@ class Cursor{
     string tableName;
     int pagePointer;
     int is_it_matrix = 0;
+    // Columns the reader needs, empty for all of them
+    vector<int> columnIndexes;
 
     public:
     Cursor(string tableName, int pageIndex);
+    Cursor(string tableName, int pageIndex, const vector<int> &columnIndexes);
     Cursor(string matrixName, int pageIndex, int is_matrix);
     vector<int> getNext();
     vector<int> getNextPageRow();
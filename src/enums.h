@@ -12,4 +12,20 @@ enum BinaryOperator
     NO_BINOP_CLAUSE
 };
 
+/**
+ * @brief How the rows of a table's pages are stored. A row layout page is one
+ * file with a line per row. A column layout table keeps one segment file per
+ * column instead, with the values of every page at a fixed offset, so reading
+ * a few columns of a wide table only reads their part of each page. A
+ * compressed layout page is one binary file holding every column in its own
+ * lightweight encoding (see compression.h), so more rows fit in a block.
+ *
+ */
+enum PageLayout
+{
+    ROW_LAYOUT,
+    COLUMN_LAYOUT,
+    COMPRESSED_LAYOUT
+};
+
 #endif // ENUMS_H
\ No newline at end of file
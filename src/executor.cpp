@@ -2,6 +2,19 @@
 
 void executeCommand(){
 
+    if (parsedQuery.explain)
+    {
+        executeEXPLAIN();
+        return;
+    }
+
+    // The catalog of the last checkpoint no longer describes the tables once
+    // anything but a read has run
+    if (parsedQuery.queryType != PRINT && parsedQuery.queryType != PRINT_MATRIX &&
+        parsedQuery.queryType != LIST && parsedQuery.queryType != CHECKPOINT && parsedQuery.queryType != SHOW &&
+        parsedQuery.queryType != TRACE)
+        tableCatalogue.invalidateCheckpoint();
+
     switch(parsedQuery.queryType){
         case CLEAR: executeCLEAR(); break;
         case CROSS: executeCROSS(); break;
@@ -29,6 +42,10 @@ void executeCommand(){
         case INSERT: executeINSERT(); break;
         case UPDATE: executeUPDATE(); break;
         case DELETE: executeDELETE(); break;
+        case CHECKPOINT: executeCHECKPOINT(); break;
+        case ANALYZE: executeANALYZE(); break;
+        case SHOW: executeSHOW(); break;
+        case TRACE: executeTRACE(); break;
         default: cout<<"PARSING ERROR"<<endl;
     }
 
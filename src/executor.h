@@ -28,6 +28,11 @@ void executeSEARCH();
 void executeINSERT();
 void executeUPDATE();
 void executeDELETE();
+void executeCHECKPOINT();
+void executeANALYZE();
+void executeEXPLAIN();
+void executeSHOW();
+void executeTRACE();
 
-bool evaluateBinOp(int value1, int value2, BinaryOperator binaryOperator);
+bool evaluateBinOp(long long value1, long long value2, BinaryOperator binaryOperator);
 void printRowCount(int rowCount);
\ No newline at end of file
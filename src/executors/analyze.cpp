@@ -0,0 +1,51 @@
+#include "global.h"
+/**
+ * @brief 
+ * SYNTAX: ANALYZE relation_name
+ *
+ * Reads the table and rebuilds the statistics of its columns, including their
+ * histograms, which SELECT, SEARCH and DELETE use to choose between scanning
+ * the table and using its indexes (see Table::chooseAccessPath).
+ */
+bool syntacticParseANALYZE()
+{
+    logger.log("syntacticParseANALYZE");
+    if (tokenizedQuery.size() != 2)
+    {
+        cout << "SYNTAX ERROR" << endl;
+        return false;
+    }
+    parsedQuery.queryType = ANALYZE;
+    parsedQuery.analyzeRelationName = tokenizedQuery[1];
+    return true;
+}
+
+bool semanticParseANALYZE()
+{
+    logger.log("semanticParseANALYZE");
+    if (!tableCatalogue.isTable(parsedQuery.analyzeRelationName))
+    {
+        cout << "SEMANTIC ERROR: Relation doesn't exist" << endl;
+        return false;
+    }
+    return true;
+}
+
+void executeANALYZE()
+{
+    logger.log("executeANALYZE");
+    Table *table = tableCatalogue.getTable(parsedQuery.analyzeRelationName);
+    table->analyze();
+    for (uint columnCounter = 0; columnCounter < table->columnCount; columnCounter++)
+    {
+        const ColumnStatistics &statistics = table->columnStatistics[columnCounter];
+        cout << table->columns[columnCounter] << ": ";
+        if (statistics.isEmpty())
+            cout << "no values" << endl;
+        else
+            cout << "about " << table->getDistinctValueCount(columnCounter) << " distinct values from "
+                 << statistics.minValue << " to " << statistics.maxValue << endl;
+    }
+    cout << "Analyzed " << table->tableName << endl;
+    printRowCount(table->rowCount);
+}
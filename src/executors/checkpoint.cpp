@@ -0,0 +1,32 @@
+#include "global.h"
+/**
+ * @brief 
+ * SYNTAX: CHECKPOINT TABLES
+ *
+ * Writes the catalog, so that the next start of the server reattaches every
+ * table as it is now instead of starting empty. QUIT checkpoints as well.
+ */
+bool syntacticParseCHECKPOINT()
+{
+    logger.log("syntacticParseCHECKPOINT");
+    if (tokenizedQuery.size() != 2 || tokenizedQuery[1] != "TABLES")
+    {
+        cout << "SYNTAX ERROR" << endl;
+        return false;
+    }
+    parsedQuery.queryType = CHECKPOINT;
+    return true;
+}
+
+bool semanticParseCHECKPOINT()
+{
+    logger.log("semanticParseCHECKPOINT");
+    return true;
+}
+
+void executeCHECKPOINT()
+{
+    logger.log("executeCHECKPOINT");
+    if (tableCatalogue.checkpoint())
+        cout << "Checkpoint written" << endl;
+}
@@ -0,0 +1,268 @@
+#include "global.h"
+/**
+ * @brief
+ * SYNTAX: EXPLAIN query
+ *         EXPLAIN ANALYZE query
+ *
+ * EXPLAIN prints the plan the query would run with: the access path, join,
+ * sort or aggregation strategy of every step, with the blocks it is estimated
+ * to read and write and the rows it is estimated to produce. Nothing is read
+ * or written but what the planner needs (e.g. a B+ tree that isn't in memory).
+ *
+ * EXPLAIN ANALYZE prints the plan, then runs the query and reports for every
+ * operator that ran the rows it produced, the pages it read from disk (the
+ * buffer pool's misses) and wrote, the page requests the pool answered (its
+ * hits) and its wall time. Nested
+ * operators are indented under the one that ran them.
+ */
+bool syntacticParseEXPLAIN()
+{
+    logger.log("syntacticParseEXPLAIN");
+    bool analyze = tokenizedQuery.size() > 2 && tokenizedQuery[1] == "ANALYZE";
+    tokenizedQuery.erase(tokenizedQuery.begin(), tokenizedQuery.begin() + (analyze ? 2 : 1));
+    if (tokenizedQuery.size() < 2 || tokenizedQuery[0] == "EXPLAIN")
+    {
+        cout << "SYNTAX ERROR: Expected format: EXPLAIN [ANALYZE] query" << endl;
+        return false;
+    }
+    if (!syntacticParse())
+        return false;
+    parsedQuery.explain = true;
+    parsedQuery.explainAnalyze = analyze;
+    return true;
+}
+
+/**
+ * @brief A step of a plan as EXPLAIN prints it. Estimates of -1 aren't
+ * printed.
+ *
+ */
+struct PlanStep
+{
+    uint depth;
+    string description;
+    double estimatedBlocks;
+    double estimatedRows;
+};
+
+static string getStatementName(QueryType queryType)
+{
+    switch (queryType)
+    {
+    case CROSS: return "CROSS";
+    case DELETE: return "DELETE";
+    case DISTINCT: return "DISTINCT";
+    case GROUP_BY: return "GROUP BY";
+    case JOIN: return "JOIN";
+    case ORDERBY: return "ORDER BY";
+    case PROJECTION: return "PROJECT";
+    case SEARCH: return "SEARCH";
+    case SELECTION: return "SELECT";
+    case SORT: return "SORT";
+    default: return tokenizedQuery.size() > 1 && tokenizedQuery[1] == "<-" ? tokenizedQuery[2] : tokenizedQuery[0];
+    }
+}
+
+/**
+ * @brief The table whose row count is the number of rows the query produced,
+ * empty if it produces none.
+ *
+ */
+static string getResultRelationName()
+{
+    switch (parsedQuery.queryType)
+    {
+    case CROSS: return parsedQuery.crossResultRelationName;
+    case DISTINCT: return parsedQuery.distinctResultRelationName;
+    case GROUP_BY: return parsedQuery.groupByResultRelationName;
+    case JOIN: return parsedQuery.joinResultRelationName;
+    case ORDERBY: return parsedQuery.orderResultRelation;
+    case PROJECTION: return parsedQuery.projectionResultRelationName;
+    case SEARCH: return parsedQuery.searchResultRelationName;
+    case SELECTION: return parsedQuery.selectionResultRelationName;
+    case SORT: return parsedQuery.sortRelationName;
+    default: return "";
+    }
+}
+
+/**
+ * @brief Blocks taken by rows rows of columnCount columns in the row layout.
+ *
+ */
+static double estimateResultBlocks(double rows, uint columnCount)
+{
+    double rowsPerBlock = max(1u, (uint)((BLOCK_SIZE * 1000) / (sizeof(int) * columnCount)));
+    return ceil(rows / rowsPerBlock);
+}
+
+static void planFilter(Table *table, const Condition &condition, bool fetchRows, vector<PlanStep> &plan)
+{
+    AccessPath path = table->chooseAccessPath(condition, fetchRows);
+    plan.push_back({1, "filter " + table->tableName + " where " + conditionToString(condition), path.getCost(), path.estimatedRows});
+    string alternatives = "full scan " + to_string((long long)path.fullScanCost) + ", zone-map scan " + to_string((long long)path.zoneMapScanCost);
+    if (path.indexScanCost >= 0)
+        alternatives += ", index lookup " + to_string((long long)ceil(path.indexScanCost));
+    plan.push_back({2, getAccessMethodName(path.method) + " (blocks of " + alternatives + ")", path.getCost(), -1});
+}
+
+/**
+ * @brief Lists the steps of the plan of the query in parsedQuery.
+ *
+ */
+static vector<PlanStep> planQuery()
+{
+    logger.log("planQuery");
+    vector<PlanStep> plan;
+    switch (parsedQuery.queryType)
+    {
+    case SELECTION:
+    case SEARCH:
+    {
+        bool isSearch = parsedQuery.queryType == SEARCH;
+        Table *table = tableCatalogue.getTable(isSearch ? parsedQuery.searchRelationName : parsedQuery.selectionRelationName);
+        planFilter(table, isSearch ? parsedQuery.searchCondition : parsedQuery.selectionCondition, true, plan);
+        double rows = plan[0].estimatedRows;
+        plan.push_back({1, "write " + (isSearch ? parsedQuery.searchResultRelationName : parsedQuery.selectionResultRelationName), estimateResultBlocks(rows, table->columnCount), rows});
+        break;
+    }
+    case DELETE:
+    {
+        Table *table = tableCatalogue.getTable(parsedQuery.deleteRelationName);
+        planFilter(table, parsedQuery.deleteCondition, false, plan);
+        double rows = plan[0].estimatedRows;
+        // Every page holding a deleted row is read and written back
+        plan.push_back({1, "delete from " + table->tableName, 2 * table->estimatePagesHolding(rows), rows});
+        break;
+    }
+    case JOIN:
+    {
+        Table *table1 = tableCatalogue.getTable(parsedQuery.joinFirstRelationName);
+        Table *table2 = tableCatalogue.getTable(parsedQuery.joinSecondRelationName);
+        uint distinctValues = max(table1->getDistinctValueCount(table1->getColumnIndex(parsedQuery.joinFirstColumnName)),
+                                  table2->getDistinctValueCount(table2->getColumnIndex(parsedQuery.joinSecondColumnName)));
+        double rows = (double)table1->rowCount * table2->rowCount / max(1u, distinctValues);
+        double resultBlocks = estimateResultBlocks(rows, table1->columnCount + table2->columnCount);
+        plan.push_back({1, "hash join " + table1->tableName + "." + parsedQuery.joinFirstColumnName + " = " + table2->tableName + "." + parsedQuery.joinSecondColumnName,
+                        (double)table1->blockCount + table2->blockCount + resultBlocks, rows});
+        plan.push_back({2, "build: full scan " + table1->tableName + " into an in-memory hash table", (double)table1->blockCount, (double)table1->rowCount});
+        plan.push_back({2, "probe: full scan " + table2->tableName, (double)table2->blockCount, (double)table2->rowCount});
+        plan.push_back({2, "write " + parsedQuery.joinResultRelationName, resultBlocks, rows});
+        break;
+    }
+    case CROSS:
+    {
+        Table *table1 = tableCatalogue.getTable(parsedQuery.crossFirstRelationName);
+        Table *table2 = tableCatalogue.getTable(parsedQuery.crossSecondRelationName);
+        double rows = (double)table1->rowCount * table2->rowCount;
+        plan.push_back({1, "nested loop cross product: " + table2->tableName + " is scanned once per row of " + table1->tableName,
+                        table1->blockCount + table1->rowCount * (double)table2->blockCount, rows});
+        plan.push_back({1, "write " + parsedQuery.crossResultRelationName, estimateResultBlocks(rows, table1->columnCount + table2->columnCount), rows});
+        break;
+    }
+    case PROJECTION:
+    {
+        Table *table = tableCatalogue.getTable(parsedQuery.projectionRelationName);
+        plan.push_back({1, "full scan " + table->tableName, (double)table->blockCount, (double)table->rowCount});
+        plan.push_back({1, "write " + parsedQuery.projectionResultRelationName, estimateResultBlocks(table->rowCount, parsedQuery.projectionColumnList.size()), (double)table->rowCount});
+        break;
+    }
+    case SORT:
+    {
+        Table *table = tableCatalogue.getTable(parsedQuery.sortRelationName);
+        vector<int> columnIndexes;
+        vector<bool> descending;
+        for (int i = 0; i < parsedQuery.sortColumns.size(); i++)
+        {
+            columnIndexes.push_back(table->getColumnIndex(parsedQuery.sortColumns[i]));
+            descending.push_back(i < parsedQuery.sortStrategy.size() && parsedQuery.sortStrategy[i] == DESC);
+        }
+        SortKeyEncoder encoder(columnIndexes, descending);
+        if (parsedQuery.sortLimit >= 0)
+        {
+            double outputBlocks = ceil((double)min(parsedQuery.sortLimit, table->rowCount) / max(1u, table->maxRowsPerBlock));
+            plan.push_back({1, "top-k " + table->tableName, table->blockCount + outputBlocks, (double)min(parsedQuery.sortLimit, table->rowCount)});
+        }
+        else if (encoder.isPrefixOf(table->sortedColumnIndexes, table->sortedDescending))
+            plan.push_back({1, table->tableName + " is already in this order", 0, (double)table->rowCount});
+        else
+            plan.push_back({1, "external sort " + table->tableName, estimateSortCost(table->blockCount), (double)table->rowCount});
+        break;
+    }
+    case ORDERBY:
+    {
+        Table *table = tableCatalogue.getTable(parsedQuery.orderRelationName);
+        SortKeyEncoder encoder({table->getColumnIndex(parsedQuery.orderAttribute)}, {parsedQuery.sortingStrategy == DESC});
+        long long limit = parsedQuery.orderLimit;
+        double estimatedCost;
+        OrderByStrategy strategy = table->chooseOrderByStrategy(table->getBPlusTree(parsedQuery.orderAttribute), encoder, limit, estimatedCost);
+        double rows = limit >= 0 ? min(limit, table->rowCount) : table->rowCount;
+        plan.push_back({1, getOrderByStrategyName(strategy) + " " + table->tableName + " on " + parsedQuery.orderAttribute, estimatedCost, rows});
+        break;
+    }
+    case GROUP_BY:
+    {
+        Table *table = tableCatalogue.getTable(parsedQuery.groupRelation);
+        double estimatedGroups, estimatedCost;
+        GroupByStrategy strategy = table->chooseGroupByStrategy(estimatedGroups, estimatedCost);
+        plan.push_back({1, getGroupByStrategyName(strategy) + " " + table->tableName, estimatedCost, estimatedGroups > 0 ? estimatedGroups : -1});
+        break;
+    }
+    case DISTINCT:
+        plan.push_back({1, "DISTINCT is not implemented, nothing is read", 0, 0});
+        break;
+    default:
+        plan.push_back({1, "no plan to choose", -1, -1});
+        break;
+    }
+    return plan;
+}
+
+static string formatEstimate(double value)
+{
+    return value < 0 ? "?" : to_string(llround(ceil(value)));
+}
+
+void executeEXPLAIN()
+{
+    logger.log("executeEXPLAIN");
+    string statementName = getStatementName(parsedQuery.queryType);
+    cout << "Plan of " << statementName << ":" << endl;
+    for (const PlanStep &step : planQuery())
+    {
+        cout << string(2 * step.depth, ' ') << step.description;
+        if (step.estimatedBlocks >= 0 || step.estimatedRows >= 0)
+            cout << "  (blocks: " << formatEstimate(step.estimatedBlocks) << ", rows: " << formatEstimate(step.estimatedRows) << ")";
+        cout << endl;
+    }
+    if (!parsedQuery.explainAnalyze)
+        return;
+
+    // Running the query may clear parsedQuery, e.g. JOIN does
+    QueryType queryType = parsedQuery.queryType;
+    string resultRelationName = getResultRelationName();
+    Table *deleteTable = queryType == DELETE ? tableCatalogue.getTable(parsedQuery.deleteRelationName) : nullptr;
+    long long rowCountBefore = deleteTable ? deleteTable->rowCount : 0;
+    parsedQuery.explain = false;
+
+    cout << endl;
+    queryProfiler.start();
+    {
+        OperatorScope scope(statementName);
+        executeCommand();
+        if (deleteTable)
+            scope.setRows(rowCountBefore - deleteTable->rowCount);
+        else if (!resultRelationName.empty() && tableCatalogue.isTable(resultRelationName))
+            scope.setRows(tableCatalogue.getTable(resultRelationName)->rowCount);
+    }
+    queryProfiler.stop();
+
+    cout << endl << left << setw(44) << "Operator" << right << setw(10) << "Rows" << setw(11) << "Read/Miss" << setw(9) << "Written"
+         << setw(8) << "Hits" << setw(12) << "Time (ms)" << endl;
+    for (const OperatorProfile &profile : queryProfiler.getOperators())
+    {
+        cout << left << setw(44) << (string(2 * profile.depth, ' ') + profile.name) << right << setw(10)
+             << (profile.rows < 0 ? "-" : to_string(profile.rows)) << setw(11) << profile.pagesRead << setw(9) << profile.pagesWritten
+             << setw(8) << profile.hits << setw(12) << fixed << setprecision(3) << profile.milliseconds << endl;
+        cout.unsetf(ios::fixed);
+    }
+}
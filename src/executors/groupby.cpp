@@ -1,10 +1,48 @@
 #include "global.h"
+/**
+ * @brief
+ * SYNTAX: R <- GROUP BY column_name[, column_name ...] FROM relation_name
+ *         [HAVING aggregate(column_name) bin_op int_literal]
+ *         RETURN aggregate(column_name)[, aggregate(column_name) ...]
+ *
+ * aggregate = MAX | MIN | SUM | AVG | COUNT
+ */
+
+/**
+ * @brief Splits a token of the form FUNCTION(column) into its aggregate
+ * function and column name.
+ *
+ * @return false if the token isn't of that form or the function is unknown
+ */
+static bool parseAggregateToken(string token, string &function, string &column, Aggregate &aggregate)
+{
+    size_t open = token.find('(');
+    if (open == string::npos || open == 0 || token.back() != ')' || open + 2 > token.size() - 1)
+        return false;
+    function = token.substr(0, open);
+    column = token.substr(open + 1, token.size() - open - 2);
+
+    if (function == "MAX")
+        aggregate = MAX;
+    else if (function == "MIN")
+        aggregate = MIN;
+    else if (function == "AVG")
+        aggregate = AVG;
+    else if (function == "SUM")
+        aggregate = SUM;
+    else if (function == "COUNT")
+        aggregate = COUNT;
+    else
+        return false;
+    return true;
+}
 
 bool syntacticParseGROUP_BY()
 {
     logger.log("syntacticParseGROUPBY");
 
-    if (tokenizedQuery.size() != 13)
+    int queryLength = tokenizedQuery.size();
+    if (queryLength < 9)
     {
         cout << "SYNTAX ERROR [Query length is not correct. please see grammer]" << endl;
         return false;
@@ -12,89 +50,77 @@ bool syntacticParseGROUP_BY()
 
     parsedQuery.queryType = GROUP_BY;
     parsedQuery.groupByResultRelationName = tokenizedQuery[0];
-    parsedQuery.groupAttribute = tokenizedQuery[4];
-    parsedQuery.groupRelation = tokenizedQuery[6];
-    parsedQuery.havingAggregate = "";
-    parsedQuery.havingAttribute = "";
-    parsedQuery.returnAggregate = "";
-    parsedQuery.returnAttribute = "";
-
-    int i = 0;
-    for (; i < tokenizedQuery[8].size(); i++)
-    {
-        if (tokenizedQuery[8][i] == '(')
-            break;
-        parsedQuery.havingAggregate += tokenizedQuery[8][i];
-    }
-    i++;
-    for (; i < tokenizedQuery[8].size() - 1; i++)
-    {
-        parsedQuery.havingAttribute += tokenizedQuery[8][i];
-    }
 
-    i = 0;
-    for (; i < tokenizedQuery[12].size(); i++)
+    int i = 4;
+    while (i < queryLength && tokenizedQuery[i] != "FROM")
+        parsedQuery.groupAttributes.push_back(tokenizedQuery[i++]);
+    if (parsedQuery.groupAttributes.empty() || i + 1 >= queryLength)
     {
-        if (tokenizedQuery[12][i] == '(')
-            break;
-        parsedQuery.returnAggregate += tokenizedQuery[12][i];
-    }
-    i++;
-    for (; i < tokenizedQuery[12].size() - 1; i++)
-    {
-        parsedQuery.returnAttribute += tokenizedQuery[12][i];
+        cout << "SYNTAX ERROR: Expected grouping columns followed by FROM relation_name" << endl;
+        return false;
     }
+    parsedQuery.groupRelation = tokenizedQuery[i + 1];
+    i += 2;
 
-    if (parsedQuery.havingAggregate == "MAX")
-        parsedQuery.havingAgg = MAX;
-    else if (parsedQuery.havingAggregate == "MIN")
-        parsedQuery.havingAgg = MIN;
-    else if (parsedQuery.havingAggregate == "AVG")
-        parsedQuery.havingAgg = AVG;
-    else if (parsedQuery.havingAggregate == "SUM")
-        parsedQuery.havingAgg = SUM;
-    else if (parsedQuery.havingAggregate == "COUNT")
-        parsedQuery.havingAgg = COUNT;
-    else
+    if (i < queryLength && tokenizedQuery[i] == "HAVING")
     {
-        cout << "SYNTAX ERROR: Incorrect HAVING aggregate function" << endl;
-        return false;
+        if (i + 3 >= queryLength)
+        {
+            cout << "SYNTAX ERROR: Expected HAVING aggregate(column_name) bin_op int_literal" << endl;
+            return false;
+        }
+        if (!parseAggregateToken(tokenizedQuery[i + 1], parsedQuery.havingAggregate, parsedQuery.havingAttribute, parsedQuery.havingAgg))
+        {
+            cout << "SYNTAX ERROR: Incorrect HAVING aggregate function" << endl;
+            return false;
+        }
+        string binaryOperator = tokenizedQuery[i + 2];
+        if (binaryOperator == "<")
+            parsedQuery.groupBinaryOperator = LESS_THAN;
+        else if (binaryOperator == ">")
+            parsedQuery.groupBinaryOperator = GREATER_THAN;
+        else if (binaryOperator == ">=" || binaryOperator == "=>")
+            parsedQuery.groupBinaryOperator = GEQ;
+        else if (binaryOperator == "<=" || binaryOperator == "=<")
+            parsedQuery.groupBinaryOperator = LEQ;
+        else if (binaryOperator == "==")
+            parsedQuery.groupBinaryOperator = EQUAL;
+        else if (binaryOperator == "!=")
+            parsedQuery.groupBinaryOperator = NOT_EQUAL;
+        else
+        {
+            cout << "SYNTAX ERROR: Incorrect Binary Operator" << endl;
+            return false;
+        }
+        regex numeric("[-]?[0-9]+");
+        if (!regex_match(tokenizedQuery[i + 3], numeric))
+        {
+            cout << "SYNTAX ERROR: HAVING value must be an integer" << endl;
+            return false;
+        }
+        if (!parseIntLiteral(tokenizedQuery[i + 3], parsedQuery.havingValue))
+            return false;
+        i += 4;
     }
-    if (parsedQuery.returnAggregate == "MAX")
-        parsedQuery.returnAgg = MAX;
-    else if (parsedQuery.returnAggregate == "MIN")
-        parsedQuery.returnAgg = MIN;
-    else if (parsedQuery.returnAggregate == "AVG")
-        parsedQuery.returnAgg = AVG;
-    else if (parsedQuery.returnAggregate == "SUM")
-        parsedQuery.returnAgg = SUM;
-    else if (parsedQuery.havingAggregate == "COUNT")
-        parsedQuery.returnAgg = COUNT;
-    else
+
+    if (i + 1 >= queryLength || tokenizedQuery[i] != "RETURN")
     {
-        cout << "SYNTAX ERROR: Incorrect RETURN aggregate function" << endl;
+        cout << "SYNTAX ERROR: Expected RETURN aggregate(column_name)[, aggregate(column_name) ...]" << endl;
         return false;
     }
-    parsedQuery.havingValue = stoi(tokenizedQuery[10]);
-    string binaryOperator = tokenizedQuery[9];
-    if (binaryOperator == "<")
-        parsedQuery.groupBinaryOperator = LESS_THAN;
-    else if (binaryOperator == ">")
-        parsedQuery.groupBinaryOperator = GREATER_THAN;
-    else if (binaryOperator == ">=" || binaryOperator == "=>")
-        parsedQuery.groupBinaryOperator = GEQ;
-    else if (binaryOperator == "<=" || binaryOperator == "=<")
-        parsedQuery.groupBinaryOperator = LEQ;
-    else if (binaryOperator == "==")
-        parsedQuery.groupBinaryOperator = EQUAL;
-    else if (binaryOperator == "!=")
-        parsedQuery.groupBinaryOperator = NOT_EQUAL;
-    else
+    for (i++; i < queryLength; i++)
     {
-        cout << "SYNTAX ERROR: Incorrect Binary Operator" << endl;
-        return false;
+        string function, column;
+        Aggregate aggregate;
+        if (!parseAggregateToken(tokenizedQuery[i], function, column, aggregate))
+        {
+            cout << "SYNTAX ERROR: Incorrect RETURN aggregate function " << tokenizedQuery[i] << endl;
+            return false;
+        }
+        parsedQuery.returnAggregates.push_back(function);
+        parsedQuery.returnAttributes.push_back(column);
+        parsedQuery.returnAggs.push_back(aggregate);
     }
-    cout << "SYNTAX ORDER is correct" << endl;
     return true;
 }
 
@@ -112,20 +138,37 @@ bool semanticParseGROUP_BY()
         cout << "SEMANTIC ERROR: Relation doesn't exist" << endl;
         return false;
     }
-    if (!tableCatalogue.isColumnFromTable(parsedQuery.groupAttribute, parsedQuery.groupRelation))
+    unordered_set<string> resultColumns;
+    for (const string &groupAttribute : parsedQuery.groupAttributes)
     {
-        cout << "SEMANTIC ERROR: Grouping Column doesn't exist in relation" << endl;
-        return false;
+        if (!tableCatalogue.isColumnFromTable(groupAttribute, parsedQuery.groupRelation))
+        {
+            cout << "SEMANTIC ERROR: Grouping Column " << groupAttribute << " doesn't exist in relation" << endl;
+            return false;
+        }
+        if (!resultColumns.insert(groupAttribute).second)
+        {
+            cout << "SEMANTIC ERROR: Grouping Column " << groupAttribute << " repeated" << endl;
+            return false;
+        }
     }
-    if (!tableCatalogue.isColumnFromTable(parsedQuery.havingAttribute, parsedQuery.groupRelation))
+    if (parsedQuery.havingAgg != NO_AGGREGATE_FUNCTION && !tableCatalogue.isColumnFromTable(parsedQuery.havingAttribute, parsedQuery.groupRelation))
     {
         cout << "SEMANTIC ERROR: Having Column doesn't exist in relation" << endl;
         return false;
     }
-    if (!tableCatalogue.isColumnFromTable(parsedQuery.returnAttribute, parsedQuery.groupRelation))
+    for (int i = 0; i < parsedQuery.returnAttributes.size(); i++)
     {
-        cout << "SEMANTIC ERROR: Return Column doesn't exist in relation" << endl;
-        return false;
+        if (!tableCatalogue.isColumnFromTable(parsedQuery.returnAttributes[i], parsedQuery.groupRelation))
+        {
+            cout << "SEMANTIC ERROR: Return Column " << parsedQuery.returnAttributes[i] << " doesn't exist in relation" << endl;
+            return false;
+        }
+        if (!resultColumns.insert(parsedQuery.returnAggregates[i] + "(" + parsedQuery.returnAttributes[i] + ")").second)
+        {
+            cout << "SEMANTIC ERROR: Return aggregate " << parsedQuery.returnAggregates[i] << "(" << parsedQuery.returnAttributes[i] << ") repeated" << endl;
+            return false;
+        }
     }
     return true;
 }
@@ -138,15 +181,32 @@ void executeGROUP_BY()
     parsedQuery.clear();
 }
 
+/**
+ * @brief
+ * SYNTAX: R <- ORDER BY column_name sorting_order ON relation_name [LIMIT k]
+ *
+ * With a LIMIT only the first k rows of the order are kept.
+ */
 bool syntacticParseORDERBY()
 {
     logger.log("syntacticParseORDERBY()");
 
-    if (tokenizedQuery.size() != 8)
+    bool hasLimit = tokenizedQuery.size() == 10 && tokenizedQuery[8] == "LIMIT";
+    if (tokenizedQuery.size() != 8 && !hasLimit)
     {
-        cout << "SYNATX ERROR: PLEASE GIVE 8 Arguments" << endl;
+        cout << "SYNATX ERROR: PLEASE GIVE 8 Arguments, or 10 with LIMIT" << endl;
         return false;
     }
+    if (hasLimit)
+    {
+        regex count("[0-9]{1,18}");
+        if (!regex_match(tokenizedQuery[9], count))
+        {
+            cout << "SYNTAX ERROR: LIMIT must be a non-negative integer" << endl;
+            return false;
+        }
+        parsedQuery.orderLimit = stoll(tokenizedQuery[9]);
+    }
     parsedQuery.queryType = ORDERBY;
     parsedQuery.orderResultRelation = tokenizedQuery[0];
     parsedQuery.orderAttribute = tokenizedQuery[4];
@@ -192,8 +252,8 @@ bool semanticParseORDERBY()
 
 void executeORDER_BY()
 {
-    logger.log("executeGROUPBY");
-    Table *table = tableCatalogue.getTable(parsedQuery.groupRelation);
+    logger.log("executeORDERBY");
+    Table *table = tableCatalogue.getTable(parsedQuery.orderRelationName);
     table->orderBy();
     parsedQuery.clear();
 }
@@ -211,49 +271,32 @@ bool syntaticParseInsert()
 
     parsedQuery.queryType = INSERT;
     parsedQuery.loadRelationName = tokenizedQuery[2];
+    // The tokenizer drops the commas, so the pairs arrive as separate tokens,
+    // e.g. "(", "c0", "=", "1", "c1=2", ")"
     string valueStr = "";
     for (int i = 3; i < tokenizedQuery.size(); i++)
+        valueStr += tokenizedQuery[i] + " ";
+    string spacedStr = "";
+    for (char c : valueStr)
     {
-        valueStr += tokenizedQuery[i];
-        if (i != tokenizedQuery.size() - 1 && tokenizedQuery[i].back() != ',')
-            valueStr += ","; // Re-add comma if missing
-    }
-    cout << "Raw insert values string: " << valueStr << endl;
-    // Remove parentheses
-    if (!valueStr.empty() && valueStr.front() == '(')
-        valueStr.erase(0, 1);
-    if (!valueStr.empty() && valueStr.back() == ')')
-        valueStr.pop_back();
-
-    // Helper lambda to trim whitespace
-    auto trim = [](string &s)
-    {
-        s.erase(s.begin(), find_if(s.begin(), s.end(), [](unsigned char ch)
-                                   { return !isspace(ch); }));
-        s.erase(find_if(s.rbegin(), s.rend(), [](unsigned char ch)
-                        { return !isspace(ch); })
-                    .base(),
-                s.end());
-    };
-
-    // Now parse key=value pairs
-    stringstream ss(valueStr);
-    string pair;
-    while (getline(ss, pair, ','))
+        if (c == '(' || c == ')')
+            spacedStr += ' ';
+        else if (c == '=')
+            spacedStr += " = ";
+        else
+            spacedStr += c;
+    }
+
+    // Now parse key = value pairs
+    stringstream ss(spacedStr);
+    string key, equals, value;
+    while (ss >> key)
     {
-        size_t pos = pair.find('=');
-        if (pos == string::npos)
-            continue;
-
-        string key = pair.substr(0, pos);
-        string value = pair.substr(pos + 1);
-
-        trim(key);
-        trim(value);
-
-        if (key.empty() || value.empty())
-            continue;
-
+        if (!(ss >> equals >> value) || equals != "=" || value == "=")
+        {
+            cout << "SYNTAX ERROR: Expected format -> INSERT INTO table_name ( col = val, ... )" << endl;
+            return false;
+        }
         parsedQuery.insertKeyValue[key] = value;
     }
 
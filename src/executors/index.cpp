@@ -2,7 +2,7 @@
 /**
  * @brief 
  * SYNTAX: INDEX ON column_name FROM relation_name USING indexing_strategy
- * indexing_strategy: ASC | DESC | NOTHING
+ * indexing_strategy: BTREE | HASH | BITMAP | NOTHING
  */
 bool syntacticParseINDEX()
 {
@@ -20,6 +20,8 @@ bool syntacticParseINDEX()
         parsedQuery.indexingStrategy = BTREE;
     else if (indexingStrategy == "HASH")
         parsedQuery.indexingStrategy = HASH;
+    else if (indexingStrategy == "BITMAP")
+        parsedQuery.indexingStrategy = BITMAP;
     else if (indexingStrategy == "NOTHING")
         parsedQuery.indexingStrategy = NOTHING;
     else
@@ -44,7 +46,8 @@ bool semanticParseINDEX()
         return false;
     }
     Table* table = tableCatalogue.getTable(parsedQuery.indexRelationName);
-    if(table->indexed){
+    // Bitmap indexes can be added next to the table's B+ tree index
+    if(table->indexed && parsedQuery.indexingStrategy != BITMAP){
         cout << "SEMANTIC ERROR: Table already indexed" << endl;
         return false;
     }
@@ -59,7 +62,8 @@ void executeINDEX()
     Table* table = tableCatalogue.getTable(parsedQuery.indexRelationName);
     
     // Create an index on the specified column
-    if (table->buildIndex(parsedQuery.indexColumnName)) {
+    bool built = parsedQuery.indexingStrategy == BITMAP ? table->buildBitmapIndex(parsedQuery.indexColumnName) : table->buildIndex(parsedQuery.indexColumnName);
+    if (built) {
         cout << "Index created successfully on " << parsedQuery.indexRelationName << "." << parsedQuery.indexColumnName << endl;
     } else {
         cout << "Failed to create index on " << parsedQuery.indexRelationName << "." << parsedQuery.indexColumnName << endl;
@@ -1,18 +1,36 @@
 #include "global.h"
 /**
  * @brief 
- * SYNTAX: LOAD relation_name
+ * SYNTAX: LOAD relation_name [USING page_layout]
+ * page_layout: ROW | COLUMNAR | COMPRESSED
+ *
+ * COLUMNAR stores every column in its own file, so queries that only refer to
+ * a few columns of a wide table only read those. COMPRESSED encodes every
+ * column of a page in the smallest of a few integer encodings, so that more
+ * rows fit in a block and scans read fewer blocks.
  */
 bool syntacticParseLOAD()
 {
     logger.log("syntacticParseLOAD");
-    if (tokenizedQuery.size() != 2)
+    if (tokenizedQuery.size() != 2 && (tokenizedQuery.size() != 4 || tokenizedQuery[2] != "USING"))
     {
         cout << "SYNTAX ERROR" << endl;
         return false;
     }
     parsedQuery.queryType = LOAD;
     parsedQuery.loadRelationName = tokenizedQuery[1];
+    if (tokenizedQuery.size() == 4)
+    {
+        if (tokenizedQuery[3] == "COLUMNAR")
+            parsedQuery.loadPageLayout = COLUMN_LAYOUT;
+        else if (tokenizedQuery[3] == "COMPRESSED")
+            parsedQuery.loadPageLayout = COMPRESSED_LAYOUT;
+        else if (tokenizedQuery[3] != "ROW")
+        {
+            cout << "SYNTAX ERROR: Unknown page layout " << tokenizedQuery[3] << endl;
+            return false;
+        }
+    }
     return true;
 }
 
@@ -67,12 +85,15 @@ void executeLOAD()
     logger.log("executeLOAD");
     cout << "EXECUTING LOADING..." << endl;
     Table *table = new Table(parsedQuery.loadRelationName);
+    table->pageLayout = parsedQuery.loadPageLayout;
     // cout << "LOADING : " << parsedQuery.loadRelationName << endl;
     // cout << "PATH : " << table->sourceFileName << endl;
     if (table->load())
     {
         tableCatalogue.insertTable(table);
         cout << "Loaded Table. Column Count: " << table->columnCount << " Row Count: " << table->rowCount << endl;
+        if (table->pageLayout == COMPRESSED_LAYOUT)
+            cout << "Rows per block: " << table->maxRowsPerBlock << " Block Count: " << table->blockCount << endl;
     }
     return;
 }
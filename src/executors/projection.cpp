@@ -52,12 +52,13 @@ void executePROJECTION()
     logger.log("executePROJECTION");
     Table* resultantTable = new Table(parsedQuery.projectionResultRelationName, parsedQuery.projectionColumnList);
     Table table = *tableCatalogue.getTable(parsedQuery.projectionRelationName);
-    Cursor cursor = table.getCursor();
     vector<int> columnIndices;
     for (int columnCounter = 0; columnCounter < parsedQuery.projectionColumnList.size(); columnCounter++)
     {
         columnIndices.emplace_back(table.getColumnIndex(parsedQuery.projectionColumnList[columnCounter]));
     }
+    // Only the projected columns are read from column layout pages
+    Cursor cursor = table.getCursor(columnIndices);
     vector<int> row = cursor.getNext();
     vector<int> resultantRow(columnIndices.size(), 0);
 
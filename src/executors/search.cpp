@@ -2,52 +2,31 @@
 
 /**
  * @brief 
- * SYNTAX: R <- SEARCH FROM relation_name WHERE column_name bin_op value
+ * SYNTAX: R <- SEARCH FROM relation_name WHERE condition
+ *
+ * where condition is one or more comparisons column_name bin_op
+ * [column_name | int_literal] joined by AND and OR, grouped with parentheses.
  */
 bool syntacticParseSEARCH()
 {
     logger.log("syntacticParseSEARCH");
     
-    if (tokenizedQuery.size() != 9|| tokenizedQuery[3] != "FROM" || tokenizedQuery[5] != "WHERE")
+    if (tokenizedQuery.size() < 9 || tokenizedQuery[3] != "FROM" || tokenizedQuery[5] != "WHERE")
     {
-        cout << "SYNTAX ERROR: Expected format: R <- SEARCH FROM relation_name WHERE column_name bin_op value" << endl;
+        cout << "SYNTAX ERROR: Expected format: R <- SEARCH FROM relation_name WHERE condition" << endl;
         return false;
     }
     
     parsedQuery.queryType = SEARCH;
     parsedQuery.searchResultRelationName = tokenizedQuery[0];
     parsedQuery.searchRelationName = tokenizedQuery[4];
-    parsedQuery.searchColumnName = tokenizedQuery[6];
     
-    string binaryOperator = tokenizedQuery[7];
-    if (binaryOperator == "<")
-        parsedQuery.searchBinaryOperator = LESS_THAN;
-    else if (binaryOperator == ">")
-        parsedQuery.searchBinaryOperator = GREATER_THAN;
-    else if (binaryOperator == ">=" || binaryOperator == "=>")
-        parsedQuery.searchBinaryOperator = GEQ;
-    else if (binaryOperator == "<=" || binaryOperator == "=<")
-        parsedQuery.searchBinaryOperator = LEQ;
-    else if (binaryOperator == "==")
-        parsedQuery.searchBinaryOperator = EQUAL;
-    else if (binaryOperator == "!=")
-        parsedQuery.searchBinaryOperator = NOT_EQUAL;
-    else
-    {
-        cout << "SYNTAX ERROR: Invalid binary operator" << endl;
-        return false;
-    }
-    
-    // Check if value is a valid integer
-    regex numeric("[-]?[0-9]+");
-    string valueStr = tokenizedQuery[8];
-    if (!regex_match(valueStr, numeric))
+    vector<string> conditionTokens(tokenizedQuery.begin() + 6, tokenizedQuery.end());
+    if (!parseCondition(conditionTokens, parsedQuery.searchCondition))
     {
-        cout << "SYNTAX ERROR: Value must be an integer" << endl;
+        cout << "SYNTAX ERROR: Expected condition: column_name bin_op value [AND | OR ...]" << endl;
         return false;
     }
-    
-    parsedQuery.searchIntLiteral = stoi(valueStr);
     return true;
 }
 
@@ -67,15 +46,16 @@ bool semanticParseSEARCH()
         return false;
     }
     
-    if (!tableCatalogue.isColumnFromTable(parsedQuery.searchColumnName, parsedQuery.searchRelationName))
-    {
-        cout << "SEMANTIC ERROR: Column doesn't exist in relation" << endl;
-        return false;
-    }
-    
-    return true;
+    return semanticParseCondition(parsedQuery.searchCondition, parsedQuery.searchRelationName);
 }
 
+/**
+ * @brief Evaluates the condition with Table::filterRows, which chooses between
+ * scanning the table, with or without its zone maps, and looking the rows up
+ * in the indexes of the compared columns by their estimated cost in blocks
+ * read (see Table::chooseAccessPath). No index is built for the search.
+ *
+ */
 void executeSEARCH()
 {
     logger.log("executeSEARCH");
@@ -83,123 +63,20 @@ void executeSEARCH()
     Table* table = tableCatalogue.getTable(parsedQuery.searchRelationName);
     Table* resultantTable = new Table(parsedQuery.searchResultRelationName, table->columns);
     
-    // Check if the table has an index on the search column
-    bool useIndex = table->isIndexed(parsedQuery.searchColumnName);
+    cout << "Searching for rows where " << conditionToString(parsedQuery.searchCondition) << " in " << parsedQuery.searchRelationName << endl;
     int rowsMatched = 0;
-    
-    cout << "Searching for rows where " << parsedQuery.searchColumnName << " ";
-    switch(parsedQuery.searchBinaryOperator) {
-        case LESS_THAN: cout << "< "; break;
-        case GREATER_THAN: cout << "> "; break;
-        case LEQ: cout << "<= "; break;
-        case GEQ: cout << ">= "; break;
-        case EQUAL: cout << "== "; break;
-        case NOT_EQUAL: cout << "!= "; break;
-        default: cout << "? "; break;
-    }
-    cout << parsedQuery.searchIntLiteral << " in " << parsedQuery.searchRelationName << endl;
-    
-    vector<int> matchingRows;
-    
-    if (useIndex)
-    {
-        // Check if the index is a B+ tree
-        if (table->indexingStrategy == BTREE) {
-            cout << "Using existing B+ tree index on " << parsedQuery.searchRelationName << "." << parsedQuery.searchColumnName << endl;
-        } else {
-            cout << "Using existing index on " << parsedQuery.searchRelationName << "." << parsedQuery.searchColumnName << endl;
-        }
-        
-        // Get matching row numbers from the index
-        matchingRows = table->searchIndexed(parsedQuery.searchColumnName, parsedQuery.searchIntLiteral, parsedQuery.searchBinaryOperator);
-        rowsMatched = matchingRows.size();
-        
-        if (rowsMatched > 0) {
-            cout << "Found " << rowsMatched << " matching rows using index" << endl;
-            
-            // Retrieve the actual rows
-            for (int rowNum : matchingRows)
-            {
-                // Get the row from the table
-                Cursor cursor = table->getCursor();
-                vector<int> row;
-                for (int i = 0; i <= rowNum; i++)
-                {
-                    row = cursor.getNext();
-                    if (row.empty()) break;
-                }
-                
-                if (!row.empty())
-                {
-                    resultantTable->writeRow<int>(row);
-                }
-            }
-        } else {
-            cout << "No matching rows found" << endl;
-        }
-    }
+    AccessPath accessPath;
+    ofstream fout(resultantTable->sourceFileName, ios::app);
+    table->filterRows(parsedQuery.searchCondition, [&](const vector<int> &row)
+                      {
+        resultantTable->writeRow<int>(row, fout);
+        rowsMatched++; }, &accessPath);
+    fout.close();
+    cout << "Access path: " << accessPath.toString() << endl;
+    if (rowsMatched > 0)
+        cout << "Found " << rowsMatched << " matching rows" << endl;
     else
-    {
-        cout << "No index found on " << parsedQuery.searchColumnName << ", creating new B+ tree index..." << endl;
-        
-        // Create a new B+ tree index for this search
-        bool indexCreated = table->buildIndex(parsedQuery.searchColumnName);
-        
-        if (indexCreated) {
-            // Get matching row numbers from the index
-            matchingRows = table->searchIndexed(parsedQuery.searchColumnName, parsedQuery.searchIntLiteral, parsedQuery.searchBinaryOperator);
-            rowsMatched = matchingRows.size();
-            
-            if (rowsMatched > 0) {
-                cout << "Found " << rowsMatched << " matching rows using newly created B+ tree index" << endl;
-                
-                // Retrieve the actual rows
-                for (int rowNum : matchingRows)
-                {
-                    // Get the row from the table
-                    Cursor cursor = table->getCursor();
-                    vector<int> row;
-                    for (int i = 0; i <= rowNum; i++)
-                    {
-                        row = cursor.getNext();
-                        if (row.empty()) break;
-                    }
-                    
-                    if (!row.empty())
-                    {
-                        resultantTable->writeRow<int>(row);
-                    }
-                }
-            } else {
-                cout << "No matching rows found" << endl;
-            }
-        } else {
-            cout << "Failed to create B+ tree index, falling back to sequential scan" << endl;
-            
-            // Fallback to sequential scan
-            int columnIndex = table->getColumnIndex(parsedQuery.searchColumnName);
-            cout << "Doing sequential scan on " << parsedQuery.searchRelationName << endl;
-            Cursor cursor = table->getCursor();
-            vector<int> row = cursor.getNext();
-            
-            while (!row.empty()) {
-                if (columnIndex < row.size()) {
-                    int value = row[columnIndex];
-                    if (evaluateBinOp(value, parsedQuery.searchIntLiteral, parsedQuery.searchBinaryOperator)) {
-                        resultantTable->writeRow<int>(row);
-                        rowsMatched++;
-                    }
-                }
-                row = cursor.getNext();
-            }
-            
-            if (rowsMatched > 0) {
-                cout << "Found " << rowsMatched << " matching rows using sequential scan" << endl;
-            } else {
-                cout << "No matching rows found" << endl;
-            }
-        }
-    }
+        cout << "No matching rows found" << endl;
     
     if (resultantTable->blockify())
     {
@@ -216,4 +93,4 @@ void executeSEARCH()
     }
     
     return;
-}
\ No newline at end of file
+}
@@ -1,50 +1,37 @@
 #include "global.h"
 /**
  * @brief 
- * SYNTAX: R <- SELECT column_name bin_op [column_name | int_literal] FROM relation_name
+ * SYNTAX: R <- SELECT condition FROM relation_name
+ *
+ * where condition is one or more comparisons column_name bin_op
+ * [column_name | int_literal] joined by AND and OR, grouped with parentheses.
  */
 bool syntacticParseSELECTION()
 {
     logger.log("syntacticParseSELECTION");
-    if (tokenizedQuery.size() != 8 || tokenizedQuery[6] != "FROM")
+    if (tokenizedQuery.size() < 8 || tokenizedQuery[tokenizedQuery.size() - 2] != "FROM")
     {
-        cout << "SYNTAX ERROR: Expected format: R <- SELECT column_name bin_op value FROM relation_name" << endl;
+        cout << "SYNTAX ERROR: Expected format: R <- SELECT condition FROM relation_name" << endl;
         return false;
     }
     parsedQuery.queryType = SELECTION;
     parsedQuery.selectionResultRelationName = tokenizedQuery[0];
-    parsedQuery.selectionFirstColumnName = tokenizedQuery[3];
-    parsedQuery.selectionRelationName = tokenizedQuery[7];
+    parsedQuery.selectionRelationName = tokenizedQuery.back();
 
-    string binaryOperator = tokenizedQuery[4];
-    if (binaryOperator == "<")
-        parsedQuery.selectionBinaryOperator = LESS_THAN;
-    else if (binaryOperator == ">")
-        parsedQuery.selectionBinaryOperator = GREATER_THAN;
-    else if (binaryOperator == ">=" || binaryOperator == "=>")
-        parsedQuery.selectionBinaryOperator = GEQ;
-    else if (binaryOperator == "<=" || binaryOperator == "=<")
-        parsedQuery.selectionBinaryOperator = LEQ;
-    else if (binaryOperator == "==")
-        parsedQuery.selectionBinaryOperator = EQUAL;
-    else if (binaryOperator == "!=")
-        parsedQuery.selectionBinaryOperator = NOT_EQUAL;
-    else
+    vector<string> conditionTokens(tokenizedQuery.begin() + 3, tokenizedQuery.end() - 2);
+    if (!parseCondition(conditionTokens, parsedQuery.selectionCondition))
     {
-        cout << "SYNTAX ERROR: Invalid binary operator" << endl;
+        cout << "SYNTAX ERROR: Expected condition: column_name bin_op value [AND | OR ...]" << endl;
         return false;
     }
-    regex numeric("[-]?[0-9]+");
-    string secondArgument = tokenizedQuery[5];
-    if (regex_match(secondArgument, numeric))
+    if (parsedQuery.selectionCondition.type == COMPARISON_CONDITION)
     {
-        parsedQuery.selectType = INT_LITERAL;
-        parsedQuery.selectionIntLiteral = stoi(secondArgument);
-    }
-    else
-    {
-        parsedQuery.selectType = COLUMN;
-        parsedQuery.selectionSecondColumnName = secondArgument;
+        const Comparison &comparison = parsedQuery.selectionCondition.comparison;
+        parsedQuery.selectionFirstColumnName = comparison.firstColumnName;
+        parsedQuery.selectionBinaryOperator = comparison.binaryOperator;
+        parsedQuery.selectType = comparison.compareColumns ? COLUMN : INT_LITERAL;
+        parsedQuery.selectionSecondColumnName = comparison.secondColumnName;
+        parsedQuery.selectionIntLiteral = comparison.intLiteral;
     }
     return true;
 }
@@ -65,50 +52,28 @@ bool semanticParseSELECTION()
         return false;
     }
 
-    if (!tableCatalogue.isColumnFromTable(parsedQuery.selectionFirstColumnName, parsedQuery.selectionRelationName))
-    {
-        cout << "SEMANTIC ERROR: Column doesn't exist in relation" << endl;
-        return false;
-    }
-
-    if (parsedQuery.selectType == COLUMN)
-    {
-        if (!tableCatalogue.isColumnFromTable(parsedQuery.selectionSecondColumnName, parsedQuery.selectionRelationName))
-        {
-            cout << "SEMANTIC ERROR: Column doesn't exist in relation" << endl;
-            return false;
-        }
-    }
-    return true;
+    return semanticParseCondition(parsedQuery.selectionCondition, parsedQuery.selectionRelationName);
 }
 
-// evaluateBinOp is now defined in global.h
-
+/**
+ * @brief Evaluates the condition with Table::filterRows: comparisons on
+ * indexed columns are answered from their indexes, the rest with vectorized
+ * filter kernels on a page at a time, most selective first.
+ *
+ */
 void executeSELECTION()
 {
     logger.log("executeSELECTION");
 
-    Table table = *tableCatalogue.getTable(parsedQuery.selectionRelationName);
-    Table* resultantTable = new Table(parsedQuery.selectionResultRelationName, table.columns);
-    Cursor cursor = table.getCursor();
-    vector<int> row = cursor.getNext();
-    int firstColumnIndex = table.getColumnIndex(parsedQuery.selectionFirstColumnName);
-    int secondColumnIndex;
-    if (parsedQuery.selectType == COLUMN)
-        secondColumnIndex = table.getColumnIndex(parsedQuery.selectionSecondColumnName);
-    while (!row.empty())
-    {
+    Table *table = tableCatalogue.getTable(parsedQuery.selectionRelationName);
+    Table* resultantTable = new Table(parsedQuery.selectionResultRelationName, table->columns);
+    logger.log("executeSELECTION: using " + getFilterKernelName(getFilterKernelLevel()) + " filter kernels");
+
+    ofstream fout(resultantTable->sourceFileName, ios::app);
+    table->filterRows(parsedQuery.selectionCondition, [&](const vector<int> &row)
+                      { resultantTable->writeRow<int>(row, fout); });
+    fout.close();
 
-        int value1 = row[firstColumnIndex];
-        int value2;
-        if (parsedQuery.selectType == INT_LITERAL)
-            value2 = parsedQuery.selectionIntLiteral;
-        else
-            value2 = row[secondColumnIndex];
-        if (evaluateBinOp(value1, value2, parsedQuery.selectionBinaryOperator))
-            resultantTable->writeRow<int>(row);
-        row = cursor.getNext();
-    }
     if(resultantTable->blockify())
         tableCatalogue.insertTable(resultantTable);
     else{
@@ -117,4 +82,4 @@ void executeSELECTION()
         delete resultantTable;
     }
     return;
-}
\ No newline at end of file
+}
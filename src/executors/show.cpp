@@ -0,0 +1,76 @@
+#include "global.h"
+/**
+ * @brief
+ * SYNTAX: SHOW BUFFER
+ *         SHOW STATS
+ *
+ * SHOW BUFFER lists the pages in the buffer pool, oldest first, and how many
+ * of them every table holds. SHOW STATS prints the buffer manager's counters
+ * since the server started. The same numbers are dumped periodically to
+ * ../data/buffer_metrics.prom (see BufferManager::dumpMetricsIfDue).
+ */
+bool syntacticParseSHOW()
+{
+    logger.log("syntacticParseSHOW");
+    if (tokenizedQuery.size() != 2 || (tokenizedQuery[1] != "BUFFER" && tokenizedQuery[1] != "STATS"))
+    {
+        cout << "SYNTAX ERROR: Expected format: SHOW BUFFER or SHOW STATS" << endl;
+        return false;
+    }
+    parsedQuery.queryType = SHOW;
+    parsedQuery.showTarget = tokenizedQuery[1];
+    return true;
+}
+
+bool semanticParseSHOW()
+{
+    logger.log("semanticParseSHOW");
+    return true;
+}
+
+/**
+ * @brief Formats a byte count with the largest unit that keeps it above 1.
+ *
+ */
+static string formatBytes(long long bytes)
+{
+    static const string units[] = {"B", "KB", "MB", "GB"};
+    double value = bytes;
+    int unit = 0;
+    while (value >= 1000 && unit < 3)
+    {
+        value /= 1000;
+        unit++;
+    }
+    stringstream ss;
+    ss << fixed << setprecision(unit ? 1 : 0) << value << " " << units[unit];
+    return ss.str();
+}
+
+void executeSHOW()
+{
+    logger.log("executeSHOW");
+    vector<string> pageNames = bufferManager.getPoolPageNames();
+    cout << "Buffer pool: " << pageNames.size() << " of " << BLOCK_COUNT << " pages of " << BLOCK_SIZE << " KB" << endl;
+    if (parsedQuery.showTarget == "BUFFER")
+    {
+        for (const string &pageName : pageNames)
+            cout << "  " << pageName << endl;
+        cout << "Pages per table:" << endl;
+        for (const auto &residentPages : bufferManager.getResidentPageCounts())
+            cout << "  " << residentPages.first << ": " << residentPages.second << endl;
+        return;
+    }
+
+    BufferStatistics statistics = bufferManager.getStatistics();
+    long long requests = statistics.hits + statistics.misses;
+    cout << "Page requests: " << requests << " (" << statistics.hits << " hits, " << statistics.misses << " misses";
+    if (requests)
+        cout << ", " << fixed << setprecision(1) << 100.0 * statistics.hits / requests << "% hit ratio";
+    cout << ")" << endl;
+    cout.unsetf(ios::fixed);
+    cout << "Evictions: " << statistics.evictions << endl;
+    cout << "Pages written: " << statistics.pagesWritten << " (written through, none are dirty when evicted)" << endl;
+    cout << "Read from disk: " << formatBytes(statistics.bytesRead) << endl;
+    cout << "Written to disk: " << formatBytes(statistics.bytesWritten) << endl;
+}
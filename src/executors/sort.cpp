@@ -3,9 +3,11 @@
  * @brief File contains method to process SORT commands.
  * 
  * syntax:
- * R <- SORT relation_name BY column_name IN sorting_order
+ * SORT relation_name BY column_name ... IN sorting_order ... [LIMIT k]
  * 
  * sorting_order = ASC | DESC 
+ *
+ * With a LIMIT only the first k rows of the order are kept in the table.
  */
 bool syntacticParseSORT(){
     logger.log("syntacticParseSORT");
@@ -42,10 +44,18 @@ bool syntacticParseSORT(){
     }
     i++;
     vector<string> sortingStrategy;
-    while(i<query_length){
+    while(i<query_length && tokenizedQuery[i]!="LIMIT"){
         sortingStrategy.push_back(tokenizedQuery[i]);
         i++;
     }
+    if(i<query_length){
+        regex count("[0-9]{1,18}");
+        if(i+2!=query_length || !regex_match(tokenizedQuery[i+1], count)){
+            cout<<"SYNTAX ERROR: LIMIT must be followed by a non-negative integer"<<endl;
+            return false;
+        }
+        parsedQuery.sortLimit = stoll(tokenizedQuery[i+1]);
+    }
     for(int i=0;i<sortingStrategy.size();i++){
         if(sortingStrategy[i] == "ASC")
             parsedQuery.sortStrategy.push_back(ASC);
@@ -95,6 +105,13 @@ void executeSORT(){
     logger.log("executeSORT");
     cout << "SORT FUNCTION IS Executing, will implement soon." << endl;
     Table* table = tableCatalogue.getTable(parsedQuery.sortRelationName);
-    table->sortTable(true);
+    table->sortTable(true, nullptr, parsedQuery.sortLimit);
+    // Sorting moves rows, so indexes on their row numbers must be rebuilt
+    for (const auto& col : table->columns) {
+        if (table->isIndexed(col)) {
+            cout << "Rebuilding index on column " << col << endl;
+            table->rebuildIndex(col);
+        }
+    }
     return;
 }
\ No newline at end of file
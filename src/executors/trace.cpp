@@ -0,0 +1,58 @@
+#include "global.h"
+/**
+ * @brief
+ * SYNTAX: TRACE ON [file_name]
+ *         TRACE OFF
+ *
+ * TRACE ON starts recording a timeline of the commands that follow: their
+ * parse, semantic check and execution, the operators they run (sort runs and
+ * merge passes, hash join build and probe, index builds, ...) and every page
+ * read from or written to disk. TRACE OFF, or QUIT, writes it to
+ * ../data/file_name.json (trace.json by default) in the Chrome trace-event
+ * format, which chrome://tracing and ui.perfetto.dev open.
+ */
+bool syntacticParseTRACE()
+{
+    logger.log("syntacticParseTRACE");
+    if ((tokenizedQuery.size() != 2 && tokenizedQuery.size() != 3) || (tokenizedQuery[1] != "ON" && tokenizedQuery[1] != "OFF") ||
+        (tokenizedQuery[1] == "OFF" && tokenizedQuery.size() == 3))
+    {
+        cout << "SYNTAX ERROR: Expected format: TRACE ON [file_name] or TRACE OFF" << endl;
+        return false;
+    }
+    parsedQuery.queryType = TRACE;
+    parsedQuery.traceOn = tokenizedQuery[1] == "ON";
+    parsedQuery.traceFileName = tokenizedQuery.size() == 3 ? tokenizedQuery[2] : "trace";
+    return true;
+}
+
+bool semanticParseTRACE()
+{
+    logger.log("semanticParseTRACE");
+    if (parsedQuery.traceOn && queryTracer.isEnabled())
+    {
+        cout << "SEMANTIC ERROR: A trace is already being taken" << endl;
+        return false;
+    }
+    if (!parsedQuery.traceOn && !queryTracer.isEnabled())
+    {
+        cout << "SEMANTIC ERROR: No trace is being taken" << endl;
+        return false;
+    }
+    return true;
+}
+
+void executeTRACE()
+{
+    logger.log("executeTRACE");
+    if (parsedQuery.traceOn)
+    {
+        queryTracer.start("../data/" + parsedQuery.traceFileName + ".json");
+        cout << "Tracing to " << queryTracer.getFileName() << endl;
+        return;
+    }
+    if (queryTracer.stop())
+        cout << "Trace written to " << queryTracer.getFileName() << endl;
+    else
+        cout << "Error: Could not write " << queryTracer.getFileName() << endl;
+}
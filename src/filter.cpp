@@ -0,0 +1,235 @@
+#include "global.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define FILTER_HAS_X86_KERNELS
+#endif
+
+/**
+ * @brief File contains the filter kernels used by scans. Every kernel is a
+ * template on the comparison and the kind of operand, so both are resolved
+ * once per query and the inner loop has no branch on them. The SIMD kernels
+ * compare 8 (AVX2) or 4 (SSE4.2) values at a time and turn the comparison mask
+ * into positions through a SelectionTable; the scalar kernel writes every
+ * position and only advances past the qualifying ones. Values after the last
+ * full vector are handled by the scalar kernel.
+ *
+ * The SIMD kernels are compiled for their instruction set with target
+ * attributes, so the rest of the server doesn't need to be built for it and
+ * still runs on CPUs without it.
+ */
+
+template <BinaryOperator op, typename Operand>
+static uint filterScalar(const int *left, const int *right, int literal, uint count, uint *selection)
+{
+    return ScanFilter<op, Operand>::select(left, right, literal, 0, count, selection, 0);
+}
+
+/**
+ * @brief Lane numbers of the set bits of every lanes-wide comparison mask,
+ * packed to the front. The SIMD kernels add the position of the vector to
+ * them and store all lanes at the end of the selection, which then advances
+ * by the number of set bits, so turning a mask into positions needs no branch.
+ *
+ */
+template <uint lanes>
+struct SelectionTable
+{
+    uint lanesOfMask[1 << lanes][lanes];
+
+    SelectionTable()
+    {
+        for (uint mask = 0; mask < (1u << lanes); mask++)
+        {
+            uint count = 0;
+            for (uint lane = 0; lane < lanes; lane++)
+                lanesOfMask[mask][lane] = 0;
+            for (uint lane = 0; lane < lanes; lane++)
+                if (mask & (1u << lane))
+                    lanesOfMask[mask][count++] = lane;
+        }
+    }
+};
+
+#ifdef FILTER_HAS_X86_KERNELS
+
+template <BinaryOperator op>
+__attribute__((target("avx2"))) static inline uint compareMaskAVX2(__m256i left, __m256i right)
+{
+    __m256i result;
+    bool negate = op == NOT_EQUAL || op == GEQ || op == LEQ;
+    if (op == GREATER_THAN || op == LEQ)
+        result = _mm256_cmpgt_epi32(left, right);
+    else if (op == LESS_THAN || op == GEQ)
+        result = _mm256_cmpgt_epi32(right, left);
+    else
+        result = _mm256_cmpeq_epi32(left, right);
+    uint mask = _mm256_movemask_ps(_mm256_castsi256_ps(result));
+    return negate ? mask ^ 0xFF : mask;
+}
+
+template <BinaryOperator op, typename Operand>
+__attribute__((target("avx2"))) static uint filterAVX2(const int *left, const int *right, int literal, uint count, uint *selection)
+{
+    static const SelectionTable<8> selectionTable;
+    uint selected = 0;
+    uint position = 0;
+    __m256i literalVector = _mm256_set1_epi32(literal);
+    for (; position + 8 <= count; position += 8)
+    {
+        __m256i leftVector = _mm256_loadu_si256((const __m256i *)(left + position));
+        __m256i rightVector = is_same<Operand, Column>::value ? _mm256_loadu_si256((const __m256i *)(right + position)) : literalVector;
+        uint mask = compareMaskAVX2<op>(leftVector, rightVector);
+        __m256i lanes = _mm256_loadu_si256((const __m256i *)selectionTable.lanesOfMask[mask]);
+        _mm256_storeu_si256((__m256i *)(selection + selected), _mm256_add_epi32(lanes, _mm256_set1_epi32(position)));
+        selected += __builtin_popcount(mask);
+    }
+    return ScanFilter<op, Operand>::select(left, right, literal, position, count, selection, selected);
+}
+
+template <BinaryOperator op>
+__attribute__((target("sse4.2"))) static inline uint compareMaskSSE42(__m128i left, __m128i right)
+{
+    __m128i result;
+    bool negate = op == NOT_EQUAL || op == GEQ || op == LEQ;
+    if (op == GREATER_THAN || op == LEQ)
+        result = _mm_cmpgt_epi32(left, right);
+    else if (op == LESS_THAN || op == GEQ)
+        result = _mm_cmpgt_epi32(right, left);
+    else
+        result = _mm_cmpeq_epi32(left, right);
+    uint mask = _mm_movemask_ps(_mm_castsi128_ps(result));
+    return negate ? mask ^ 0xF : mask;
+}
+
+template <BinaryOperator op, typename Operand>
+__attribute__((target("sse4.2"))) static uint filterSSE42(const int *left, const int *right, int literal, uint count, uint *selection)
+{
+    static const SelectionTable<4> selectionTable;
+    uint selected = 0;
+    uint position = 0;
+    __m128i literalVector = _mm_set1_epi32(literal);
+    for (; position + 4 <= count; position += 4)
+    {
+        __m128i leftVector = _mm_loadu_si128((const __m128i *)(left + position));
+        __m128i rightVector = is_same<Operand, Column>::value ? _mm_loadu_si128((const __m128i *)(right + position)) : literalVector;
+        uint mask = compareMaskSSE42<op>(leftVector, rightVector);
+        __m128i lanes = _mm_loadu_si128((const __m128i *)selectionTable.lanesOfMask[mask]);
+        _mm_storeu_si128((__m128i *)(selection + selected), _mm_add_epi32(lanes, _mm_set1_epi32(position)));
+        selected += __builtin_popcount(mask);
+    }
+    return ScanFilter<op, Operand>::select(left, right, literal, position, count, selection, selected);
+}
+
+#endif // FILTER_HAS_X86_KERNELS
+
+/**
+ * @brief Detects the widest kernels this CPU supports. The result is cached,
+ * CPUID is only queried on the first call.
+ *
+ * @return FilterKernelLevel
+ */
+FilterKernelLevel getFilterKernelLevel()
+{
+    static FilterKernelLevel level = []()
+    {
+#ifdef FILTER_HAS_X86_KERNELS
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            return AVX2_KERNELS;
+        if (__builtin_cpu_supports("sse4.2"))
+            return SSE42_KERNELS;
+#endif
+        return SCALAR_KERNELS;
+    }();
+    return level;
+}
+
+string getFilterKernelName(FilterKernelLevel level)
+{
+    if (level == AVX2_KERNELS)
+        return "AVX2";
+    if (level == SSE42_KERNELS)
+        return "SSE4.2";
+    return "scalar";
+}
+
+template <BinaryOperator op, typename Operand>
+static ScanFilterFunction getKernel(FilterKernelLevel level)
+{
+#ifdef FILTER_HAS_X86_KERNELS
+    if (level == AVX2_KERNELS)
+        return filterAVX2<op, Operand>;
+    if (level == SSE42_KERNELS)
+        return filterSSE42<op, Operand>;
+#endif
+    return filterScalar<op, Operand>;
+}
+
+template <typename Operand>
+static ScanFilterFunction getKernel(BinaryOperator op, FilterKernelLevel level)
+{
+    switch (op)
+    {
+    case LESS_THAN:
+        return getKernel<LESS_THAN, Operand>(level);
+    case GREATER_THAN:
+        return getKernel<GREATER_THAN, Operand>(level);
+    case LEQ:
+        return getKernel<LEQ, Operand>(level);
+    case GEQ:
+        return getKernel<GEQ, Operand>(level);
+    case EQUAL:
+        return getKernel<EQUAL, Operand>(level);
+    case NOT_EQUAL:
+        return getKernel<NOT_EQUAL, Operand>(level);
+    default:
+        return nullptr;
+    }
+}
+
+/**
+ * @brief Returns the filter kernel for op, comparing against a second column
+ * or a literal, in the given instruction set. Levels the CPU doesn't support
+ * must not be asked for.
+ *
+ * @param op
+ * @param compareColumns
+ * @param level
+ * @return ScanFilterFunction nullptr for an unknown operator
+ */
+ScanFilterFunction getScanFilter(BinaryOperator op, bool compareColumns, FilterKernelLevel level)
+{
+    if (compareColumns)
+        return getKernel<Column>(op, level);
+    return getKernel<Literal>(op, level);
+}
+
+/**
+ * @brief Copies one column of the first count rows of a page into a
+ * contiguous array, the layout the filter kernels work on.
+ *
+ * @param rows
+ * @param count
+ * @param columnIndex
+ * @param values
+ */
+void gatherColumn(const vector<vector<int>> &rows, uint count, int columnIndex, int *values)
+{
+    for (uint position = 0; position < count; position++)
+        values[position] = rows[position][columnIndex];
+}
+
+/**
+ * @brief Compacting gather: appends the rows at the positions of a selection
+ * vector to output, in order.
+ *
+ * @param rows
+ * @param selection
+ * @param count number of positions in selection
+ * @param output
+ */
+void gatherRows(const vector<vector<int>> &rows, const uint *selection, uint count, vector<vector<int>> &output)
+{
+    for (uint position = 0; position < count; position++)
+        output.push_back(rows[selection[position]]);
+}
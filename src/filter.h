@@ -0,0 +1,38 @@
+#ifndef FILTER_H
+#define FILTER_H
+
+#include <string>
+#include <vector>
+#include "enums.h"
+#include "predicate.h"
+
+using namespace std;
+
+/**
+ * @brief Instruction sets the filter kernels come in. The widest one the CPU
+ * supports is detected once with CPUID and used by every scan.
+ *
+ */
+enum FilterKernelLevel
+{
+    SCALAR_KERNELS,
+    SSE42_KERNELS,
+    AVX2_KERNELS
+};
+
+FilterKernelLevel getFilterKernelLevel();
+string getFilterKernelName(FilterKernelLevel level);
+
+/**
+ * Filter kernels evaluate a comparison over a batch of column values, usually
+ * one page of a column gathered into a contiguous array, and write the
+ * positions of the qualifying values in ascending order to a selection vector
+ * (which must have room for count entries). getScanFilter resolves the
+ * operator, the kind of operand and the instruction set once per query.
+ */
+ScanFilterFunction getScanFilter(BinaryOperator op, bool compareColumns, FilterKernelLevel level = getFilterKernelLevel());
+
+void gatherColumn(const vector<vector<int>> &rows, uint count, int columnIndex, int *values);
+void gatherRows(const vector<vector<int>> &rows, const uint *selection, uint count, vector<vector<int>> &output);
+
+#endif // FILTER_H
@@ -1,14 +1,23 @@
 #include"executor.h"
+#include"aggregate.h"
+#include"parallel.h"
+#include"filter.h"
+#include"profiler.h"
 #include <sys/stat.h>
 
 extern float BLOCK_SIZE;
 extern uint BLOCK_COUNT;
 extern uint PRINT_COUNT;
+extern uint SORT_THREAD_COUNT;
+extern uint SORT_BUFFER_BLOCKS;
+extern uint METRICS_DUMP_INTERVAL;
 extern vector<string> tokenizedQuery;
 extern ParsedQuery parsedQuery;
 extern TableCatalogue tableCatalogue;
 extern MatrixCatalogue matrixCatalogue;
 extern BufferManager bufferManager;
+extern QueryProfiler queryProfiler;
+extern QueryTracer queryTracer;
 
 /**
  * @brief Helper function to evaluate binary operations
@@ -19,7 +28,7 @@ extern BufferManager bufferManager;
  * @return true if the condition is satisfied
  * @return false otherwise
  */
-inline bool evaluateBinOp(int value1, int value2, BinaryOperator op) {
+inline bool evaluateBinOp(long long value1, long long value2, BinaryOperator op) {
     switch (op) {
         case LESS_THAN:
             return value1 < value2;
@@ -0,0 +1,81 @@
+#include "global.h"
+
+void ValueSampler::add(int value)
+{
+    this->valueCount++;
+    if (this->values.size() < SAMPLE_SIZE)
+    {
+        this->values.push_back(value);
+        return;
+    }
+    unsigned long long slot = uniform_int_distribution<unsigned long long>(0, this->valueCount - 1)(this->generator);
+    if (slot < SAMPLE_SIZE)
+        this->values[slot] = value;
+}
+
+/**
+ * @brief Builds the histogram from a sample of the column, the bounds being
+ * the values at every (1 / BUCKET_COUNT)th quantile of it.
+ *
+ * @param values
+ */
+void EquiDepthHistogram::build(vector<int> values)
+{
+    this->bounds.clear();
+    if (values.empty())
+        return;
+    sort(values.begin(), values.end());
+    uint bucketCount = min((size_t)BUCKET_COUNT, values.size());
+    for (uint bucket = 0; bucket < bucketCount; bucket++)
+        this->bounds.push_back(values[(size_t)bucket * values.size() / bucketCount]);
+    this->bounds.push_back(values.back());
+}
+
+/**
+ * @brief Estimated fraction of the rows whose value is below value, or at
+ * most value if inclusive is set.
+ *
+ * @param value
+ * @param inclusive
+ * @return double
+ */
+double EquiDepthHistogram::fractionBelow(int value, bool inclusive) const
+{
+    if (this->isEmpty())
+        return 0;
+    uint bucketCount = this->bounds.size() - 1;
+    double depth = 1.0 / bucketCount, fraction = 0;
+    for (uint bucket = 0; bucket < bucketCount; bucket++)
+    {
+        long long low = this->bounds[bucket], high = this->bounds[bucket + 1];
+        if (inclusive ? high <= value : high < value)
+            fraction += depth;
+        else if (inclusive ? low <= value : low < value)
+            fraction += depth * (value - low + inclusive) / (high - low + 1);
+        else
+            break;
+    }
+    return min(1.0, fraction);
+}
+
+/**
+ * @brief Estimated fraction of the rows equal to value: the buckets the value
+ * fills on its own, or its share of the range of the bucket it falls in.
+ *
+ * @param value
+ * @return double
+ */
+double EquiDepthHistogram::fractionEqual(int value) const
+{
+    return max(0.0, this->fractionBelow(value, true) - this->fractionBelow(value, false));
+}
+
+void EquiDepthHistogram::save(ostream &fout) const
+{
+    writeCatalogVector(fout, this->bounds);
+}
+
+bool EquiDepthHistogram::restore(istream &fin)
+{
+    return readCatalogVector(fin, this->bounds) && this->bounds.size() <= BUCKET_COUNT + 1;
+}
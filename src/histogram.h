@@ -0,0 +1,55 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief A uniform random sample of at most SAMPLE_SIZE of the values added to
+ * it (reservoir sampling), which the histogram of a column is built from
+ * without holding the whole column in memory. The generator has a fixed seed
+ * so the same rows give the same histogram.
+ *
+ */
+class ValueSampler
+{
+    mt19937 generator;
+    unsigned long long valueCount = 0;
+
+public:
+    static const uint SAMPLE_SIZE = 4096;
+    vector<int> values;
+
+    ValueSampler() : generator(0x5EED) {}
+    void add(int value);
+};
+
+/**
+ * @brief Equi-depth histogram of a column: BUCKET_COUNT buckets holding the same
+ * number of rows each, bucket i between bounds[i] and bounds[i + 1]. Values
+ * within a bucket are taken to be spread evenly over its range, so skewed
+ * columns get narrow buckets where the values are dense, and a value that
+ * fills several buckets on its own is known to be frequent. Empty until the
+ * table is loaded or analyzed (see Table::analyze).
+ *
+ */
+class EquiDepthHistogram
+{
+    vector<int> bounds;
+
+public:
+    static const uint BUCKET_COUNT = 32;
+
+    void build(vector<int> values);
+    bool isEmpty() const { return this->bounds.size() < 2; }
+    double fractionBelow(int value, bool inclusive) const;
+    double fractionEqual(int value) const;
+    void clear() { this->bounds.clear(); }
+    void save(ostream &fout) const;
+    bool restore(istream &fin);
+};
+
+#endif // HISTOGRAM_H
@@ -0,0 +1,90 @@
+#include "global.h"
+
+/**
+ * @brief Mixes a value into 64 well distributed bits (the finalizer of
+ * splitmix64), like the Bloom filters of the zone maps do.
+ *
+ */
+static inline unsigned long long hashValue(int value)
+{
+    unsigned long long hash = (unsigned long long)(unsigned int)value + 0x9E3779B97F4A7C15ULL;
+    hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBULL;
+    return hash ^ (hash >> 31);
+}
+
+void HyperLogLog::add(int value)
+{
+    unsigned long long hash = hashValue(value);
+    uint registerIndex = hash >> (64 - PRECISION);
+    // Rank of the first set bit of the remaining bits, 64 - PRECISION + 1 if
+    // there is none
+    unsigned long long rest = hash << PRECISION;
+    uint8_t rank = rest ? __builtin_clzll(rest) + 1 : 64 - PRECISION + 1;
+    if (rank > this->registers[registerIndex])
+        this->registers[registerIndex] = rank;
+}
+
+void HyperLogLog::merge(const HyperLogLog &other)
+{
+    for (uint registerIndex = 0; registerIndex < this->registers.size(); registerIndex++)
+        this->registers[registerIndex] = max(this->registers[registerIndex], other.registers[registerIndex]);
+}
+
+/**
+ * @brief Estimated number of distinct values added: the harmonic mean of the
+ * registers, or linear counting of the empty registers while few of them are
+ * set, where the harmonic mean is biased.
+ *
+ * @return unsigned long long
+ */
+unsigned long long HyperLogLog::estimate() const
+{
+    double registerCount = this->registers.size();
+    double sum = 0;
+    uint emptyRegisters = 0;
+    for (uint8_t rank : this->registers)
+    {
+        sum += ldexp(1.0, -rank);
+        emptyRegisters += rank == 0;
+    }
+    double alpha = 0.7213 / (1 + 1.079 / registerCount);
+    double estimate = alpha * registerCount * registerCount / sum;
+    if (estimate <= 2.5 * registerCount && emptyRegisters > 0)
+        estimate = registerCount * log(registerCount / emptyRegisters);
+    return (unsigned long long)llround(estimate);
+}
+
+void HyperLogLog::save(ostream &fout) const
+{
+    writeCatalogVector(fout, this->registers);
+}
+
+bool HyperLogLog::restore(istream &fin)
+{
+    return readCatalogVector(fin, this->registers) && this->registers.size() == (1u << PRECISION);
+}
+
+void ColumnStatistics::add(int value)
+{
+    this->distinctValues.add(value);
+    this->minValue = min(this->minValue, value);
+    this->maxValue = max(this->maxValue, value);
+}
+
+/**
+ * @brief Folds the statistics of other rows into these. Histograms don't
+ * merge, so the result only keeps one if just one side had any rows.
+ *
+ */
+void ColumnStatistics::merge(const ColumnStatistics &other)
+{
+    if (this->isEmpty())
+        this->histogram = other.histogram;
+    else if (!other.isEmpty())
+        this->histogram.clear();
+    this->distinctValues.merge(other.distinctValues);
+    this->minValue = min(this->minValue, other.minValue);
+    this->maxValue = max(this->maxValue, other.maxValue);
+    this->nullCount += other.nullCount;
+}
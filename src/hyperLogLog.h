@@ -0,0 +1,59 @@
+#ifndef HYPERLOGLOG_H
+#define HYPERLOGLOG_H
+
+#include <climits>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include "histogram.h"
+
+using namespace std;
+
+/**
+ * @brief HyperLogLog sketch of the distinct values of a column. Every value is
+ * hashed to 64 bits; the first PRECISION bits pick one of 2^PRECISION
+ * registers, which keeps the longest run of leading zeros seen in the rest.
+ * The estimate has a standard error of about 1.04 / sqrt(2^PRECISION), 1.6%,
+ * in a fixed 4KB however many values there are. Adding a value twice changes
+ * nothing and the sketches of two sets of values merge into the sketch of
+ * their union, so partial sketches built separately can be combined.
+ *
+ */
+class HyperLogLog
+{
+    vector<uint8_t> registers;
+
+public:
+    static const uint PRECISION = 12;
+
+    HyperLogLog() : registers(1 << PRECISION, 0) {}
+    void add(int value);
+    void merge(const HyperLogLog &other);
+    unsigned long long estimate() const;
+    void save(ostream &fout) const;
+    bool restore(istream &fin);
+};
+
+/**
+ * @brief Statistics of one column of a table, kept up to date as pages are
+ * written (see Table::writePage): a sketch of its distinct values and the
+ * smallest and largest value. nullCount counts the cells INSERT filled in
+ * with 0 because no valid value was given. The histogram can't be kept up to
+ * date a page at a time; it is built when the table is loaded or analyzed and
+ * only describes the rows as they were then.
+ *
+ */
+struct ColumnStatistics
+{
+    HyperLogLog distinctValues;
+    int minValue = INT_MAX;
+    int maxValue = INT_MIN;
+    long long nullCount = 0;
+    EquiDepthHistogram histogram;
+
+    void add(int value);
+    void merge(const ColumnStatistics &other);
+    bool isEmpty() const { return this->minValue > this->maxValue; }
+};
+
+#endif // HYPERLOGLOG_H
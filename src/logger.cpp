@@ -7,5 +7,6 @@ Logger::Logger()
 
 void Logger::log(string logString)
 {
+    lock_guard<mutex> lock(this->logMutex);
     fout << logString << endl;
 }
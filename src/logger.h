@@ -9,6 +9,7 @@ class Logger{
 
     string logFile = "log";
     ofstream fout;
+    mutex logMutex;
     
     public:
 
@@ -1,4 +1,5 @@
 #include "global.h"
+#include <unistd.h>
 /**
  * @brief Construct a new Page object. Never used as part of the code
  *
@@ -20,12 +21,30 @@ Page::Page()
  * "<tablename>_Page<pageindex>". For example, If the Page being loaded is of
  * table "R" and the pageIndex is 2 then the file name is "R_Page2". The page
  * loads the rows (or tuples) into a vector of rows (where each row is a vector
- * of integers).
+ * of integers). Tables in the column layout store every column in a segment
+ * file, "R_Column0", "R_Column1" and so on, instead (see readColumn), and
+ * pages in the compressed layout are binary (see readCompressedColumns).
  *
  * @param tableName 
  * @param pageIndex 
  */
-Page::Page(string tableName, int pageIndex)
+Page::Page(string tableName, int pageIndex) : Page(tableName, pageIndex, vector<int>())
+{
+}
+
+/**
+ * @brief Loads only the given columns of a page; the other values of its rows
+ * are left 0. Only pages in the column and compressed layouts can skip
+ * columns, so for any other page, or when columnIndexes is empty, every
+ * column is loaded. The
+ * pageName of a page holding a subset of the columns names them (see
+ * getColumnsPageName), so the buffer pool never mistakes it for the full page.
+ *
+ * @param tableName 
+ * @param pageIndex 
+ * @param columnIndexes
+ */
+Page::Page(string tableName, int pageIndex, const vector<int> &columnIndexes)
 {
     logger.log("Page::Page");
     this->tableName = tableName;
@@ -37,12 +56,37 @@ Page::Page(string tableName, int pageIndex)
         cerr << "Error: Table not found in catalog" << endl;
         return;
     }
-    Table table = *tempTable;
     
-    this->columnCount = table.columnCount;
-    uint maxRowCount = table.maxRowsPerBlock;
+    this->columnCount = tempTable->columnCount;
+    this->layout = tempTable->pageLayout;
+    uint maxRowCount = tempTable->maxRowsPerBlock;
     vector<int> row(columnCount, 0);
     this->rows.assign(maxRowCount, row);
+    this->rowCount = tempTable->rowsPerBlockCount[pageIndex];
+
+    if (this->layout == COLUMN_LAYOUT) {
+        if (columnIndexes.empty() || columnIndexes.size() >= this->columnCount) {
+            for (int columnCounter = 0; columnCounter < columnCount; columnCounter++)
+                this->readColumn(columnCounter);
+            return;
+        }
+        for (int columnIndex : columnIndexes)
+            this->readColumn(columnIndex);
+        this->pageName = getColumnsPageName(this->pageName, columnIndexes);
+        return;
+    }
+
+    if (this->layout == COMPRESSED_LAYOUT) {
+        if (columnIndexes.empty() || columnIndexes.size() >= this->columnCount) {
+            vector<int> allColumns(this->columnCount);
+            iota(allColumns.begin(), allColumns.end(), 0);
+            this->readCompressedColumns(allColumns);
+            return;
+        }
+        this->readCompressedColumns(columnIndexes);
+        this->pageName = getColumnsPageName(this->pageName, columnIndexes);
+        return;
+    }
 
     ifstream fin(pageName, ios::in);
     if (!fin.is_open()) {
@@ -50,10 +94,10 @@ Page::Page(string tableName, int pageIndex)
         return;
     }
 
-    this->rowCount = table.rowsPerBlockCount[pageIndex];
     string line;
     for (uint rowCounter = 0; rowCounter < this->rowCount; rowCounter++) {
         getline(fin, line);
+        this->bytesTransferred += line.size() + 1;
         stringstream ss(line);
         string value;
         for (int columnCounter = 0; columnCounter < columnCount; columnCounter++) {
@@ -65,6 +109,140 @@ Page::Page(string tableName, int pageIndex)
     fin.close();
 }
 
+/**
+ * @brief Reads and decodes the given columns (ascending) of a compressed
+ * page. The file starts with the column count, the row count and the offset
+ * of every column's encoded block plus the end of the last one, all of which
+ * is read first; every run of adjacent columns is then read with one more
+ * read, so only the requested columns come off the disk.
+ *
+ * @param columnIndexes
+ */
+void Page::readCompressedColumns(const vector<int> &columnIndexes)
+{
+    logger.log("Page::readCompressedColumns");
+    ifstream fin;
+    fin.rdbuf()->pubsetbuf(nullptr, 0);
+    fin.open(this->pageName, ios::in | ios::binary);
+    if (!fin.is_open()) {
+        cerr << "Error: Could not open file " << this->pageName << endl;
+        return;
+    }
+    vector<char> header(2 * sizeof(uint) + (this->columnCount + 1) * sizeof(uint));
+    fin.read(header.data(), header.size());
+    this->bytesTransferred += header.size();
+    uint fileColumnCount;
+    memcpy(&fileColumnCount, header.data(), sizeof(uint));
+    if (!fin || fileColumnCount != this->columnCount) {
+        cerr << "Error: Corrupt compressed page " << this->pageName << endl;
+        return;
+    }
+    vector<uint> offsets(this->columnCount + 1);
+    memcpy(offsets.data(), header.data() + 2 * sizeof(uint), offsets.size() * sizeof(uint));
+
+    this->encodedColumns.assign(this->columnCount, EncodedColumn());
+    vector<int> values(this->rowCount);
+    vector<char> data;
+    for (uint first = 0; first < columnIndexes.size();)
+    {
+        uint last = first;
+        while (last + 1 < columnIndexes.size() && columnIndexes[last + 1] == columnIndexes[last] + 1)
+            last++;
+        uint start = offsets[columnIndexes[first]];
+        data.resize(offsets[columnIndexes[last] + 1] - start);
+        fin.seekg(start);
+        fin.read(data.data(), data.size());
+        this->bytesTransferred += data.size();
+        for (uint position = first; position <= last; position++)
+        {
+            int columnIndex = columnIndexes[position];
+            EncodedColumn &column = this->encodedColumns[columnIndex];
+            if (!readEncodedColumn(data.data() + (offsets[columnIndex] - start), offsets[columnIndex + 1] - offsets[columnIndex], this->rowCount, column)) {
+                cerr << "Error: Corrupt column " << columnIndex << " in compressed page " << this->pageName << endl;
+                column = EncodedColumn();
+                continue;
+            }
+            decodeColumn(column, values.data());
+            for (uint rowCounter = 0; rowCounter < this->rowCount; rowCounter++)
+                this->rows[rowCounter][columnIndex] = values[rowCounter];
+        }
+        first = last + 1;
+    }
+    fin.close();
+}
+
+/**
+ * @brief Encodes every column of the page and writes the page in the format
+ * readCompressedColumns reads.
+ *
+ */
+void Page::writeCompressedPage()
+{
+    logger.log("Page::writeCompressedPage");
+    string blocks;
+    vector<uint> offsets;
+    size_t headerSize = 2 * sizeof(uint) + (this->columnCount + 1) * sizeof(uint);
+    vector<int> values(this->rowCount);
+    for (int columnCounter = 0; columnCounter < this->columnCount; columnCounter++)
+    {
+        for (int rowCounter = 0; rowCounter < this->rowCount; rowCounter++)
+            values[rowCounter] = this->rows[rowCounter][columnCounter];
+        offsets.push_back(headerSize + blocks.size());
+        writeEncodedColumn(encodeColumn(values.data(), this->rowCount), blocks);
+    }
+    offsets.push_back(headerSize + blocks.size());
+    ofstream fout(this->pageName, ios::trunc | ios::binary);
+    uint counts[] = {(uint)this->columnCount, (uint)this->rowCount};
+    fout.write((const char *)counts, sizeof(counts));
+    fout.write((const char *)offsets.data(), offsets.size() * sizeof(uint));
+    fout.write(blocks.data(), blocks.size());
+    fout.close();
+    this->bytesTransferred = sizeof(counts) + offsets.size() * sizeof(uint) + blocks.size();
+}
+
+/**
+ * @brief Byte offset of page pageIndex in the column segments of a table with
+ * columnCount columns. Every page gets a slot of a full block's worth of rows
+ * (as many as a row layout page holds), so a page can be rewritten in place.
+ *
+ * @param pageIndex
+ * @param columnCount
+ * @return streamoff
+ */
+static streamoff getColumnOffset(int pageIndex, int columnCount)
+{
+    uint rowsPerBlock = (uint)((BLOCK_SIZE * 1000) / (sizeof(int) * columnCount));
+    return (streamoff)pageIndex * rowsPerBlock * sizeof(int);
+}
+
+/**
+ * @brief Reads the values of one column of a column layout page from the
+ * column's segment. Values are stored as binary ints, rowCount of them at the
+ * page's offset.
+ *
+ * @param columnIndex
+ */
+void Page::readColumn(int columnIndex)
+{
+    logger.log("Page::readColumn");
+    string fileName = getColumnFileName(this->tableName, columnIndex);
+    // Unbuffered, so that only this page's values are read from the segment
+    ifstream fin;
+    fin.rdbuf()->pubsetbuf(nullptr, 0);
+    fin.open(fileName, ios::in | ios::binary);
+    if (!fin.is_open()) {
+        cerr << "Error: Could not open file " << fileName << endl;
+        return;
+    }
+    vector<int> values(this->rowCount);
+    fin.seekg(getColumnOffset(this->pageIndex, this->columnCount));
+    fin.read((char *)values.data(), values.size() * sizeof(int));
+    this->bytesTransferred += values.size() * sizeof(int);
+    for (uint rowCounter = 0; rowCounter < this->rowCount; rowCounter++)
+        this->rows[rowCounter][columnIndex] = values[rowCounter];
+    fin.close();
+}
+
 Page::Page(string tableName, int pageIndex, int is_matrix)
 {
     logger.log("Page::Page");
@@ -122,6 +300,7 @@ Page::Page(string tableName, int pageIndex, int is_matrix)
             this->rows[rowCounter][columnCounter] = number;
         }
     }
+    this->bytesTransferred = max(0LL, (long long)fin.tellg());
 
     fin.close();
 }
@@ -143,7 +322,7 @@ vector<int> Page::getRow(int rowIndex)
     return this->rows[rowIndex];
 }
 
-Page::Page(string tableName, int pageIndex, vector<vector<int>> rows, int rowCount)
+Page::Page(string tableName, int pageIndex, vector<vector<int>> rows, int rowCount, PageLayout layout)
 {
     logger.log("Page::Page");
     this->tableName = tableName;
@@ -151,6 +330,7 @@ Page::Page(string tableName, int pageIndex, vector<vector<int>> rows, int rowCou
     this->rows = rows;
     this->rowCount = rowCount;
     this->columnCount = rows[0].size();
+    this->layout = layout;
     this->pageName = "../data/temp/"+this->tableName + "_Page" + to_string(pageIndex);
 }
 
@@ -161,6 +341,29 @@ Page::Page(string tableName, int pageIndex, vector<vector<int>> rows, int rowCou
 void Page::writePage()
 {
     logger.log("Page::writePage");
+    if (this->layout == COMPRESSED_LAYOUT)
+    {
+        this->writeCompressedPage();
+        return;
+    }
+    if (this->layout == COLUMN_LAYOUT)
+    {
+        vector<int> values(this->rowCount);
+        this->bytesTransferred = (long long)this->columnCount * this->rowCount * sizeof(int);
+        for (int columnCounter = 0; columnCounter < this->columnCount; columnCounter++)
+        {
+            string fileName = getColumnFileName(this->tableName, columnCounter);
+            fstream fout(fileName, ios::in | ios::out | ios::binary);
+            if (!fout.is_open())
+                fout.open(fileName, ios::out | ios::binary);
+            for (int rowCounter = 0; rowCounter < this->rowCount; rowCounter++)
+                values[rowCounter] = this->rows[rowCounter][columnCounter];
+            fout.seekp(getColumnOffset(this->pageIndex, this->columnCount));
+            fout.write((const char *)values.data(), values.size() * sizeof(int));
+            fout.close();
+        }
+        return;
+    }
     ofstream fout(this->pageName, ios::trunc);
     for (int rowCounter = 0; rowCounter < this->rowCount; rowCounter++)
     {
@@ -172,6 +375,7 @@ void Page::writePage()
         }
         fout << endl;
     }
+    this->bytesTransferred = fout.tellp();
     fout.close();
 }
 
@@ -191,4 +395,57 @@ vector<vector<int>> Page::getAllRows() {
 int Page::getrowcount(){
     logger.log("Page::getRowCount");
     return this->rowCount;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Name of the segment holding one column of a column layout table.
+ *
+ * @param tableName
+ * @param columnIndex
+ * @return string
+ */
+string getColumnFileName(const string &tableName, int columnIndex)
+{
+    return "../data/temp/" + tableName + "_Column" + to_string(columnIndex);
+}
+
+/**
+ * @brief Name of the copy of a page that only holds the given columns, e.g.
+ * "R_Page2{0,3}".
+ *
+ * @param pageName
+ * @param columnIndexes
+ * @return string
+ */
+string getColumnsPageName(const string &pageName, const vector<int> &columnIndexes)
+{
+    string name = pageName + "{";
+    for (int position = 0; position < columnIndexes.size(); position++)
+        name += (position ? "," : "") + to_string(columnIndexes[position]);
+    return name + "}";
+}
+
+/**
+ * @brief Drops page pageIndex and every page after it from the column
+ * segments of a column layout table; segments left empty are deleted.
+ *
+ * @param tableName
+ * @param pageIndex
+ * @param columnCount
+ */
+void truncateColumns(const string &tableName, int pageIndex, int columnCount)
+{
+    logger.log("truncateColumns");
+    streamoff offset = getColumnOffset(pageIndex, columnCount);
+    for (int columnCounter = 0; columnCounter < columnCount; columnCounter++)
+    {
+        string fileName = getColumnFileName(tableName, columnCounter);
+        struct stat fileStatus;
+        if (stat(fileName.c_str(), &fileStatus) != 0 || fileStatus.st_size <= offset)
+            continue;
+        if (offset == 0)
+            remove(fileName.c_str());
+        else
+            truncate(fileName.c_str(), offset);
+    }
+}
@@ -1,4 +1,6 @@
 #include"logger.h"
+#include"enums.h"
+#include"compression.h"
 /**
  * @brief The Page object is the main memory representation of a physical page
  * (equivalent to a block). The page class and the page.h header file are at the
@@ -13,21 +15,37 @@
 class Page{
 
     string tableName;
-    string pageIndex;
+    int pageIndex;
     int columnCount;
     int rowCount;
+    PageLayout layout = ROW_LAYOUT;
+
+    void readColumn(int columnIndex);
+    void readCompressedColumns(const vector<int> &columnIndexes);
+    void writeCompressedPage();
 
     public:
 
     vector<vector<int>> rows;
+    // Columns read from a compressed page as they are stored, indexed by
+    // column; columns that weren't read have a count of 0
+    vector<EncodedColumn> encodedColumns;
     string pageName = "";
+    // Bytes the page took off the disk when it was read, or put on it when
+    // it was last written, for the buffer manager's statistics
+    long long bytesTransferred = 0;
     Page();
     Page(string tableName, int pageIndex);
+    Page(string tableName, int pageIndex, const vector<int> &columnIndexes);
     Page(string tableName, int pageIndex, int is_matrix);
-    Page(string tableName, int pageIndex, vector<vector<int>> rows, int rowCount);
+    Page(string tableName, int pageIndex, vector<vector<int>> rows, int rowCount, PageLayout layout = ROW_LAYOUT);
     vector<int> getRow(int rowIndex);
     void updateRow(int rowIndex, vector<int> newRow);
     vector<vector<int>> getAllRows();
     int getrowcount();
     void writePage();
-};
\ No newline at end of file
+};
+
+string getColumnFileName(const string &tableName, int columnIndex);
+string getColumnsPageName(const string &pageName, const vector<int> &columnIndexes);
+void truncateColumns(const string &tableName, int pageIndex, int columnCount);
\ No newline at end of file
@@ -0,0 +1,29 @@
+#include "global.h"
+
+/**
+ * @brief Runs task(0) ... task(taskCount - 1) on up to threadCount threads,
+ * the calling thread being one of them. Threads pull the next task index from
+ * a shared counter, so uneven tasks balance out. Returns once every task has
+ * finished.
+ *
+ * @param taskCount
+ * @param threadCount
+ * @param task
+ */
+void parallelFor(uint taskCount, uint threadCount, const function<void(uint)> &task)
+{
+    logger.log("parallelFor");
+    atomic<uint> nextTask(0);
+    auto worker = [&]()
+    {
+        for (uint taskIndex = nextTask++; taskIndex < taskCount; taskIndex = nextTask++)
+            task(taskIndex);
+    };
+
+    vector<thread> threads;
+    for (uint threadIndex = 1; threadIndex < min(threadCount, taskCount); threadIndex++)
+        threads.emplace_back(worker);
+    worker();
+    for (auto &thread : threads)
+        thread.join();
+}
@@ -0,0 +1,10 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <functional>
+
+using namespace std;
+
+void parallelFor(uint taskCount, uint threadCount, const function<void(uint)> &task);
+
+#endif // PARALLEL_H
@@ -0,0 +1,95 @@
+#ifndef PREDICATE_H
+#define PREDICATE_H
+
+#include <type_traits>
+#include "enums.h"
+
+/**
+ * @brief Kinds of right hand side of a comparison in a scan: an int literal
+ * or a second column of the same row.
+ *
+ */
+struct Literal
+{
+};
+struct Column
+{
+};
+
+template <BinaryOperator op>
+inline bool compareValues(int left, int right)
+{
+    if (op == LESS_THAN)
+        return left < right;
+    if (op == GREATER_THAN)
+        return left > right;
+    if (op == LEQ)
+        return left <= right;
+    if (op == GEQ)
+        return left >= right;
+    if (op == EQUAL)
+        return left == right;
+    if (op == NOT_EQUAL)
+        return left != right;
+    return false;
+}
+
+/**
+ * @brief The scan loop of one comparison, left op literal or left op right,
+ * with the operator and the kind of operand fixed at compile time. Scans pick
+ * the instantiation once per query (see getScanFilter) instead of going
+ * through evaluateBinOp's switch for every row, so the loops below contain no
+ * branch at all.
+ *
+ * The left and right values are columns of a batch of rows gathered into
+ * contiguous arrays; right is ignored for a Literal.
+ *
+ */
+template <BinaryOperator op, typename Operand>
+struct ScanFilter
+{
+    static inline bool matches(const int *left, const int *right, int literal, unsigned int position)
+    {
+        if (std::is_same<Operand, Column>::value)
+            return compareValues<op>(left[position], right[position]);
+        return compareValues<op>(left[position], literal);
+    }
+
+    /**
+     * @brief Appends the qualifying positions in [first, count) to selection
+     * from index selected on. Every position is written and the end of the
+     * selection only advances past the qualifying ones.
+     *
+     * @return unsigned int the new number of selected positions
+     */
+    static unsigned int select(const int *left, const int *right, int literal, unsigned int first, unsigned int count, unsigned int *selection, unsigned int selected)
+    {
+        for (unsigned int position = first; position < count; position++)
+        {
+            selection[selected] = position;
+            selected += matches(left, right, literal, position);
+        }
+        return selected;
+    }
+
+    /**
+     * @brief Stores 1 for every qualifying position and 0 otherwise. The loop
+     * has independent iterations, so the compiler vectorizes it.
+     *
+     */
+    static void match(const int *left, const int *right, int literal, unsigned int count, unsigned char *matches)
+    {
+        for (unsigned int position = 0; position < count; position++)
+            matches[position] = ScanFilter::matches(left, right, literal, position);
+    }
+};
+
+/**
+ * @brief A filter kernel for one comparison: writes the positions in
+ * [0, count) that satisfy it to selection, in ascending order, and returns
+ * how many there are.
+ *
+ */
+typedef unsigned int (*ScanFilterFunction)(const int *left, const int *right, int literal, unsigned int count, unsigned int *selection);
+
+#endif // PREDICATE_H
@@ -0,0 +1,74 @@
+#include "global.h"
+
+/**
+ * @brief Forgets the operators of the last query and starts recording.
+ *
+ */
+void QueryProfiler::start()
+{
+    logger.log("QueryProfiler::start");
+    this->operators.clear();
+    this->startTimes.clear();
+    this->depth = 0;
+    this->enabled = true;
+}
+
+void QueryProfiler::stop()
+{
+    logger.log("QueryProfiler::stop");
+    this->enabled = false;
+}
+
+/**
+ * @brief Records the start of an operator. The counters it started with are
+ * kept in its profile until end turns them into differences.
+ *
+ * @param name
+ * @return int the operator's index, -1 if not recording
+ */
+int QueryProfiler::begin(const string &name)
+{
+    if (!this->enabled)
+        return -1;
+    BufferStatistics statistics = bufferManager.getStatistics();
+    OperatorProfile profile;
+    profile.name = name;
+    profile.depth = this->depth++;
+    profile.pagesRead = statistics.misses;
+    profile.pagesWritten = statistics.pagesWritten;
+    profile.hits = statistics.hits;
+    this->operators.push_back(profile);
+    this->startTimes.push_back(chrono::steady_clock::now());
+    return this->operators.size() - 1;
+}
+
+void QueryProfiler::end(int operatorIndex, long long rows)
+{
+    if (!this->enabled || operatorIndex < 0 || operatorIndex >= (int)this->operators.size())
+        return;
+    BufferStatistics statistics = bufferManager.getStatistics();
+    OperatorProfile &profile = this->operators[operatorIndex];
+    profile.rows = rows;
+    profile.pagesRead = statistics.misses - profile.pagesRead;
+    profile.pagesWritten = statistics.pagesWritten - profile.pagesWritten;
+    profile.hits = statistics.hits - profile.hits;
+    profile.milliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - this->startTimes[operatorIndex]).count();
+    this->depth--;
+}
+
+OperatorScope::OperatorScope(const string &name) : span(name, "operator")
+{
+    this->operatorIndex = queryProfiler.begin(name);
+}
+
+void OperatorScope::setRows(long long rows)
+{
+    this->rows = rows;
+    if (queryTracer.isEnabled())
+        this->span.detail = to_string(rows) + " rows";
+}
+
+OperatorScope::~OperatorScope()
+{
+    queryProfiler.end(this->operatorIndex, this->rows);
+}
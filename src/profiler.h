@@ -0,0 +1,71 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include "tracer.h"
+
+using namespace std;
+
+/**
+ * @brief What one operator of a query did while EXPLAIN ANALYZE ran it: the
+ * rows it produced (-1 if it doesn't say), the pages it read from disk, wrote
+ * and found in the pool, and its wall time. Operators nest; depth is the
+ * number of operators it ran inside of.
+ *
+ */
+struct OperatorProfile
+{
+    string name;
+    uint depth = 0;
+    long long rows = -1;
+    long long pagesRead = 0;
+    long long pagesWritten = 0;
+    long long hits = 0;
+    double milliseconds = 0;
+};
+
+/**
+ * @brief Collects an OperatorProfile for every OperatorScope of the query
+ * EXPLAIN ANALYZE runs, in the order the operators started. While it isn't
+ * started operators cost nothing more than a check of a flag. The buffer
+ * counters are global, so the pages read by sort workers count towards the
+ * operator that started them.
+ *
+ */
+class QueryProfiler
+{
+    bool enabled = false;
+    uint depth = 0;
+    vector<OperatorProfile> operators;
+    vector<chrono::steady_clock::time_point> startTimes;
+
+public:
+    void start();
+    void stop();
+    bool isEnabled() const { return this->enabled; }
+    int begin(const string &name);
+    void end(int operatorIndex, long long rows);
+    const vector<OperatorProfile> &getOperators() const { return this->operators; }
+};
+
+/**
+ * @brief Profiles the enclosing block as one operator, e.g.
+ * OperatorScope scope("hash join: build"), and records it as a span of the
+ * trace if one is being taken.
+ *
+ */
+class OperatorScope
+{
+    int operatorIndex;
+    long long rows = -1;
+    TraceSpan span;
+
+public:
+    OperatorScope(const string &name);
+    ~OperatorScope();
+    void setRows(long long rows);
+};
+
+#endif // PROFILER_H
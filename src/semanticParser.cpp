@@ -29,8 +29,35 @@ bool semanticParse(){
         case INSERT: return semanticParseInsert();
         case UPDATE: return semanticParseUpdate();
         case DELETE: return semanticParseDELETE();
+        case CHECKPOINT: return semanticParseCHECKPOINT();
+        case ANALYZE: return semanticParseANALYZE();
+        case SHOW: return semanticParseSHOW();
+        case TRACE: return semanticParseTRACE();
         default: cout<<"SEMANTIC ERROR"<<endl;
     }
 
     return false;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Checks that every column the condition refers to exists in the
+ * relation. Shared by SELECT, SEARCH and DELETE.
+ *
+ * @param condition
+ * @param relationName
+ * @return true
+ * @return false
+ */
+bool semanticParseCondition(const Condition &condition, string relationName)
+{
+    logger.log("semanticParseCondition");
+    vector<string> columnNames;
+    getConditionColumns(condition, columnNames);
+    for (const string &columnName : columnNames)
+        if (!tableCatalogue.isColumnFromTable(columnName, relationName))
+        {
+            cout << "SEMANTIC ERROR: Column doesn't exist in relation" << endl;
+            return false;
+        }
+    return true;
+}
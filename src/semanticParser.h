@@ -27,4 +27,9 @@ bool semanticParseORDERBY();
 bool semanticParseSEARCH();
 bool semanticParseInsert();
 bool semanticParseUpdate();
-bool semanticParseDELETE();
\ No newline at end of file
+bool semanticParseDELETE();
+bool semanticParseCHECKPOINT();
+bool semanticParseANALYZE();
+bool semanticParseSHOW();
+bool semanticParseTRACE();
+bool semanticParseCondition(const Condition &condition, string relationName);
\ No newline at end of file
@@ -6,18 +6,48 @@ using namespace std;
 float BLOCK_SIZE = 1;
 uint BLOCK_COUNT = 2;
 uint PRINT_COUNT = 20;
+// Threads used by the external sort and the blocks of memory they may use in
+// total (run generation heaps plus merge input and output pages). The thread
+// count can be fixed with the SIMPLERA_SORT_THREADS environment variable.
+uint SORT_THREAD_COUNT = max(1u, thread::hardware_concurrency());
+uint SORT_BUFFER_BLOCKS = 16;
+// Seconds between dumps of the buffer metrics to ../data/buffer_metrics.prom,
+// 0 to turn them off
+uint METRICS_DUMP_INTERVAL = 10;
 Logger logger;
 vector<string> tokenizedQuery;
 ParsedQuery parsedQuery;
 TableCatalogue tableCatalogue;
 MatrixCatalogue matrixCatalogue;
 BufferManager bufferManager;
+QueryProfiler queryProfiler;
+QueryTracer queryTracer;
+
+/**
+ * @brief Runs a phase of a command, as a span of the trace if one is being
+ * taken.
+ *
+ */
+static bool runPhase(const string &name, bool (*phase)())
+{
+    TraceSpan span(name, "command");
+    return phase();
+}
 
 void doCommand()
 {
     // logger.log("doCommand");
-    if (syntacticParse() && semanticParse())
+    string queryText;
+    if (queryTracer.isEnabled())
+        for (const string &token : tokenizedQuery)
+            queryText += (queryText.empty() ? "" : " ") + token;
+    TraceSpan commandSpan(queryText, "command");
+    if (runPhase("parse", syntacticParse) && runPhase("semantic check", semanticParse))
+    {
+        TraceSpan span("execute", "command");
         executeCommand();
+    }
+    bufferManager.dumpMetricsIfDue();
     return;
 }
 
@@ -53,8 +83,17 @@ int main(void)
 {
     regex delim("[^\\s,]+");
     string command;
-    system("rm -rf ../data/temp");
-    system("mkdir ../data/temp");
+    if (const char *sortThreads = getenv("SIMPLERA_SORT_THREADS"))
+        if (atoi(sortThreads) > 0)
+            SORT_THREAD_COUNT = atoi(sortThreads);
+    // The tables of the last session are reattached if it ended with a
+    // checkpoint, otherwise its files are thrown away
+    system("mkdir -p ../data/temp");
+    if (!tableCatalogue.restore())
+    {
+        system("rm -rf ../data/temp");
+        system("mkdir ../data/temp");
+    }
 
     int quit_flag = 0;
 
@@ -107,4 +146,8 @@ int main(void)
             doCommand();
         }
     }
+    tableCatalogue.checkpoint();
+    bufferManager.dumpMetricsIfDue(true);
+    if (queryTracer.isEnabled() && queryTracer.stop())
+        cout << "Trace written to " << queryTracer.getFileName() << endl;
 }
\ No newline at end of file
@@ -0,0 +1,109 @@
+#include "global.h"
+
+SortKeyEncoder::SortKeyEncoder(const vector<int> &columnIndexes, const vector<bool> &descending)
+{
+    logger.log("SortKeyEncoder::SortKeyEncoder");
+    this->columnIndexes = columnIndexes;
+    this->descending = descending;
+    this->keyWidth = columnIndexes.size() * sizeof(int);
+}
+
+/**
+ * @brief Writes the normalized key of row to key, which must have room for
+ * keyWidth bytes.
+ *
+ * @param row
+ * @param key
+ */
+void SortKeyEncoder::encode(const vector<int> &row, unsigned char *key) const
+{
+    for (int i = 0; i < this->columnIndexes.size(); i++)
+    {
+        uint value = (uint)row[this->columnIndexes[i]] ^ 0x80000000u;
+        if (this->descending[i])
+            value = ~value;
+        key[0] = value >> 24;
+        key[1] = value >> 16;
+        key[2] = value >> 8;
+        key[3] = value;
+        key += 4;
+    }
+}
+
+/**
+ * @brief Checks whether rows ordered on the key (columnIndexes, descending) are
+ * also ordered on this key, i.e. whether this key is a prefix of that one.
+ *
+ * @param columnIndexes
+ * @param descending
+ * @return true if the rows need no sorting for this key
+ */
+bool SortKeyEncoder::isPrefixOf(const vector<int> &columnIndexes, const vector<bool> &descending) const
+{
+    if (this->columnIndexes.size() > columnIndexes.size())
+        return false;
+    for (int i = 0; i < this->columnIndexes.size(); i++)
+        if (this->columnIndexes[i] != columnIndexes[i] || this->descending[i] != descending[i])
+            return false;
+    return true;
+}
+
+// Buckets smaller than this are finished with a comparison sort
+const uint RADIX_SORT_CUTOFF = 32;
+
+/**
+ * @brief MSD radix sort of order[begin, end) on byte position byte and onwards
+ * of the keys. All keys in the range agree on the bytes before byte.
+ *
+ */
+static void radixSort(uint *begin, uint *end, const unsigned char *keys, uint keyWidth, uint byte, vector<uint> &buffer)
+{
+    uint count = end - begin;
+    if (count < RADIX_SORT_CUTOFF || byte >= keyWidth)
+    {
+        if (byte < keyWidth)
+            sort(begin, end, [keys, keyWidth, byte](uint a, uint b)
+                 { return memcmp(keys + a * keyWidth + byte, keys + b * keyWidth + byte, keyWidth - byte) < 0; });
+        return;
+    }
+
+    uint bucketStart[257] = {0};
+    for (uint *it = begin; it != end; it++)
+        bucketStart[keys[*it * keyWidth + byte] + 1]++;
+    // Every key has the same byte here; skip straight to the next one
+    if (bucketStart[keys[*begin * keyWidth + byte] + 1] == count)
+    {
+        radixSort(begin, end, keys, keyWidth, byte + 1, buffer);
+        return;
+    }
+    for (int bucket = 0; bucket < 256; bucket++)
+        bucketStart[bucket + 1] += bucketStart[bucket];
+
+    uint next[256];
+    copy(bucketStart, bucketStart + 256, next);
+    for (uint *it = begin; it != end; it++)
+        buffer[next[keys[*it * keyWidth + byte]]++] = *it;
+    copy(buffer.begin(), buffer.begin() + count, begin);
+
+    for (int bucket = 0; bucket < 256; bucket++)
+        if (bucketStart[bucket + 1] - bucketStart[bucket] > 1)
+            radixSort(begin + bucketStart[bucket], begin + bucketStart[bucket + 1], keys, keyWidth, byte + 1, buffer);
+}
+
+/**
+ * @brief Sorts the indexes in order by their normalized keys, where index i
+ * has its key at keys + i * keyWidth. Uses an MSD radix sort that falls back
+ * to std::sort with memcmp on small buckets.
+ *
+ * @param order
+ * @param keys
+ * @param keyWidth
+ */
+void sortByKeys(vector<uint> &order, const unsigned char *keys, uint keyWidth)
+{
+    logger.log("sortByKeys");
+    if (order.size() < 2 || keyWidth == 0)
+        return;
+    vector<uint> buffer(order.size());
+    radixSort(order.data(), order.data() + order.size(), keys, keyWidth, 0, buffer);
+}
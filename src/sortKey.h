@@ -0,0 +1,39 @@
+#ifndef SORTKEY_H
+#define SORTKEY_H
+
+#include <vector>
+#include <cstring>
+
+using namespace std;
+
+/**
+ * @brief The SortKeyEncoder turns the sort key of a row into a normalized key:
+ * a fixed width byte string whose memcmp order is the sort order. Every key
+ * column becomes 4 big-endian bytes with the sign bit flipped, so that signed
+ * ints compare correctly as unsigned bytes, and all bits of DESC columns are
+ * inverted. Comparing two rows is then a single memcmp with no per-column
+ * lookups or branches on the sort order.
+ *
+ */
+class SortKeyEncoder
+{
+    vector<int> columnIndexes;
+    vector<bool> descending;
+
+public:
+    uint keyWidth = 0;
+
+    SortKeyEncoder(const vector<int> &columnIndexes, const vector<bool> &descending);
+    void encode(const vector<int> &row, unsigned char *key) const;
+    bool isPrefixOf(const vector<int> &columnIndexes, const vector<bool> &descending) const;
+    const vector<int> &getColumnIndexes() const { return this->columnIndexes; }
+    const vector<bool> &getDescending() const { return this->descending; }
+    int compare(const unsigned char *a, const unsigned char *b) const
+    {
+        return memcmp(a, b, this->keyWidth);
+    }
+};
+
+void sortByKeys(vector<uint> &order, const unsigned char *keys, uint keyWidth);
+
+#endif // SORTKEY_H
@@ -21,6 +21,16 @@ bool syntacticParse()
         return syntacticParseINDEX();
     else if (possibleQueryType == "LIST")
         return syntacticParseLIST();
+    else if (possibleQueryType == "CHECKPOINT")
+        return syntacticParseCHECKPOINT();
+    else if (possibleQueryType == "ANALYZE")
+        return syntacticParseANALYZE();
+    else if (possibleQueryType == "EXPLAIN")
+        return syntacticParseEXPLAIN();
+    else if (possibleQueryType == "SHOW")
+        return syntacticParseSHOW();
+    else if (possibleQueryType == "TRACE")
+        return syntacticParseTRACE();
     else if (possibleQueryType == "LOAD"){
         if (tokenizedQuery.size() > 2 && possibleDataType == "MATRIX")
             return syntacticParseLOAD_MATRIX();
@@ -127,6 +137,7 @@ void ParsedQuery::clear()
     this->joinSecondColumnName = "";
 
     this->loadRelationName = "";
+    this->loadPageLayout = ROW_LAYOUT;
 
     this->printRelationName = "";
 
@@ -138,6 +149,18 @@ void ParsedQuery::clear()
     this->renameToColumnName = "";
     this->renameRelationName = "";
 
+    this->groupByResultRelationName = "";
+    this->groupAttributes.clear();
+    this->groupRelation = "";
+    this->havingAttribute = "";
+    this->havingAggregate = "";
+    this->havingValue = 0;
+    this->havingAgg = NO_AGGREGATE_FUNCTION;
+    this->groupBinaryOperator = NO_BINOP_CLAUSE;
+    this->returnAggregates.clear();
+    this->returnAttributes.clear();
+    this->returnAggs.clear();
+
     this->selectType = NO_SELECT_CLAUSE;
     this->selectionBinaryOperator = NO_BINOP_CLAUSE;
     this->selectionResultRelationName = "";
@@ -145,11 +168,37 @@ void ParsedQuery::clear()
     this->selectionFirstColumnName = "";
     this->selectionSecondColumnName = "";
     this->selectionIntLiteral = 0;
+    this->selectionCondition = Condition();
+
+    this->searchResultRelationName = "";
+    this->searchRelationName = "";
+    this->searchCondition = Condition();
+
+    this->deleteRelationName = "";
+    this->deleteCondition = Condition();
+
+    this->analyzeRelationName = "";
+
+    this->showTarget = "";
+
+    this->traceOn = false;
+    this->traceFileName = "";
+
+    this->explain = false;
+    this->explainAnalyze = false;
 
     this->sortingStrategy = NO_SORT_CLAUSE;
     this->sortResultRelationName = "";
     this->sortColumnName = "";
+    this->sortColumns.clear();
+    this->sortStrategy.clear();
     this->sortRelationName = "";
+    this->sortLimit = -1;
+
+    this->orderResultRelation = "";
+    this->orderRelationName = "";
+    this->orderAttribute = "";
+    this->orderLimit = -1;
 
     this->sourceFileName = "";
 }
@@ -31,6 +31,10 @@ enum QueryType
     UPDATE,
     SEARCH,
     DELETE,
+    CHECKPOINT,
+    ANALYZE,
+    SHOW,
+    TRACE,
     UNDETERMINED
 };
 
@@ -89,6 +93,7 @@ public:
     string joinSecondColumnName = "";
 
     string loadRelationName = "";
+    PageLayout loadPageLayout = ROW_LAYOUT;
 
     string printRelationName = "";
     string rotateRelationName = "";
@@ -103,16 +108,16 @@ public:
 
     // GROUP BY REQUIREMENTS
     string groupByResultRelationName = "";
-    string groupAttribute = "";
+    vector<string> groupAttributes;
     string groupRelation = "";
     string havingAttribute = "";
     string havingAggregate = "";
-    string returnAggregate = "";
-    string returnAttribute = "";
-    int havingValue = 0;
+    long long havingValue = 0;
     Aggregate havingAgg = NO_AGGREGATE_FUNCTION;
-    Aggregate returnAgg = NO_AGGREGATE_FUNCTION;
     BinaryOperator groupBinaryOperator = NO_BINOP_CLAUSE;
+    vector<string> returnAggregates;
+    vector<string> returnAttributes;
+    vector<Aggregate> returnAggs;
 
     SelectType selectType = NO_SELECT_CLAUSE;
     BinaryOperator selectionBinaryOperator = NO_BINOP_CLAUSE;
@@ -121,19 +126,27 @@ public:
     string selectionFirstColumnName = "";
     string selectionSecondColumnName = "";
     int selectionIntLiteral = 0;
+    Condition selectionCondition;
 
     // SEARCH COMMAND
     string searchResultRelationName = "";
     string searchRelationName = "";
-    string searchColumnName = "";
-    BinaryOperator searchBinaryOperator = NO_BINOP_CLAUSE;
-    int searchIntLiteral = 0;
+    Condition searchCondition;
     
     // DELETE COMMAND
     string deleteRelationName = "";
-    string deleteColumnName = "";
-    BinaryOperator deleteBinaryOperator = NO_BINOP_CLAUSE;
-    int deleteIntLiteral = 0;
+    Condition deleteCondition;
+
+    string analyzeRelationName = "";
+
+    string showTarget = "";
+
+    bool traceOn = false;
+    string traceFileName = "";
+
+    // EXPLAIN [ANALYZE] runs the query parsed into the fields above
+    bool explain = false;
+    bool explainAnalyze = false;
 
     SortingStrategy sortingStrategy = NO_SORT_CLAUSE;
     string sortResultRelationName = "";
@@ -141,6 +154,7 @@ public:
     vector<string> sortColumns;
     vector<SortingStrategy> sortStrategy;
     string sortRelationName = "";
+    long long sortLimit = -1;
 
     string sourceFileName = "";
 
@@ -150,6 +164,7 @@ public:
     string orderResultRelation = "";
     string orderRelationName = "";
     string orderAttribute = "";
+    long long orderLimit = -1;
 
     ParsedQuery();
     void clear();
@@ -187,6 +202,11 @@ bool syntaticParseInsert();
 bool syntaticParseUpdate();
 bool syntacticParseSEARCH();
 bool syntacticParseDELETE();
+bool syntacticParseCHECKPOINT();
+bool syntacticParseANALYZE();
+bool syntacticParseEXPLAIN();
+bool syntacticParseSHOW();
+bool syntacticParseTRACE();
 
 bool isFileExists(string tableName);
 bool isQueryFile(string fileName);
@@ -26,6 +26,7 @@ Table::~Table() {
                 delete pair.second->bPlusTreeIndex;
                 pair.second->bPlusTreeIndex = nullptr;
             }
+            delete pair.second->bitmapIndex;
             delete pair.second;
             pair.second = nullptr;
         }
@@ -44,6 +45,7 @@ Table::~Table() {
  */
 bool Table::buildIndex(string columnName) {
     logger.log("Table::buildIndex");
+    OperatorScope scope("B+ tree build " + this->tableName + "." + columnName);
     cout << "Building B+ tree index on " << this->tableName << "." << columnName << endl;
     
     if (!this->isColumn(columnName)) {
@@ -86,6 +88,8 @@ bool Table::buildIndex(string columnName) {
         // If the index exists but is not a B+ tree, rebuild it
         if (indexInfo->strategy != BTREE) {
             cout << "Rebuilding index as B+ tree..." << endl;
+            delete indexInfo->bitmapIndex;
+            indexInfo->bitmapIndex = nullptr;
         } else {
             // If we already have a B+ tree index on this column, check if it's loaded
             if (indexInfo->bPlusTreeIndex != nullptr) {
@@ -217,6 +221,7 @@ bool Table::buildIndex(string columnName) {
             this->indexingStrategy = BTREE;
             // Just point to the same object, don't create a new reference
             this->bPlusTreeIndex = indexInfo->bPlusTreeIndex;
+            this->updateIndexScanStatistics(indexInfo->bPlusTreeIndex);
             
             cout << "B+ tree index built successfully on " << this->tableName << "." << columnName << endl;
             // cout << "DEBUG: Table now has " << indices.size() << " indices" << endl;
@@ -278,6 +283,17 @@ vector<int> Table::searchIndexed(string columnName, int value, BinaryOperator op
     if (it != indices.end() && it->second != nullptr) {
         IndexInfo* indexInfo = it->second;
         
+        if (indexInfo->strategy == BITMAP) {
+            BitmapIndex* bitmapIndex = this->getBitmapIndex(columnName);
+            if (bitmapIndex != nullptr) {
+                for (const CompressedBitmap* bitmap : bitmapIndex->lookup(op, value))
+                    bitmap->appendRows(matchingRows);
+                sort(matchingRows.begin(), matchingRows.end());
+                cout << "Bitmap index search found " << matchingRows.size() << " matching rows" << endl;
+            }
+            return matchingRows;
+        }
+        
         // Check if we have a B+ tree index
         if (indexInfo->strategy == BTREE) {
             try {
@@ -596,6 +612,121 @@ bool Table::isIndexed(string columnName) {
     return legacyResult || (it != indices.end());
 }
 
+/**
+ * @brief Returns the kind of index on a column.
+ *
+ * @param columnName
+ * @return IndexingStrategy NOTHING if the column isn't indexed
+ */
+IndexingStrategy Table::getIndexingStrategy(string columnName) {
+    auto it = indices.find(columnName);
+    if (it != indices.end() && it->second != nullptr)
+        return it->second->strategy;
+    if (this->indexed && this->indexedColumn == columnName)
+        return this->indexingStrategy;
+    return NOTHING;
+}
+
+/**
+ * @brief Builds the index on a column again from the current rows, e.g. after
+ * rows have been moved or deleted. buildIndex on its own reuses the tree that
+ * is in memory or on disk.
+ *
+ * @param columnName the name of the column to index
+ * @return true if the index was rebuilt
+ */
+bool Table::rebuildIndex(string columnName) {
+    logger.log("Table::rebuildIndex");
+    auto it = indices.find(columnName);
+    if (it != indices.end() && it->second != nullptr && it->second->strategy == BITMAP) {
+        return this->buildBitmapIndex(columnName);
+    }
+    if (it != indices.end() && it->second != nullptr && it->second->bPlusTreeIndex != nullptr) {
+        if (this->bPlusTreeIndex == it->second->bPlusTreeIndex) {
+            this->bPlusTreeIndex = nullptr;
+        }
+        delete it->second->bPlusTreeIndex;
+        it->second->bPlusTreeIndex = nullptr;
+    }
+    bufferManager.deleteFile("../data/temp/" + this->tableName + "_" + columnName + "_bptree.idx");
+    return this->buildIndex(columnName);
+}
+
+/**
+ * @brief Builds a bitmap index on a column from the current rows, replacing
+ * any other index on it. The index lives in memory only; it is rebuilt when
+ * the table changes underneath it (see getBitmapIndex).
+ *
+ * @param columnName the name of the column to index
+ * @return true if the index was built
+ */
+bool Table::buildBitmapIndex(string columnName) {
+    logger.log("Table::buildBitmapIndex");
+    OperatorScope scope("bitmap index build " + this->tableName + "." + columnName);
+    cout << "Building bitmap index on " << this->tableName << "." << columnName << endl;
+    int columnIndex = this->getColumnIndex(columnName);
+    if (columnIndex < 0 || !this->isColumn(columnName)) {
+        cout << "Error: Column " << columnName << " does not exist in table " << this->tableName << endl;
+        return false;
+    }
+    
+    BitmapIndex* bitmapIndex = new BitmapIndex();
+    long long rowCounter = 0;
+    for (uint pageIndex = 0; pageIndex < this->blockCount; pageIndex++) {
+        Page page = bufferManager.getPage(this->tableName, pageIndex);
+        int pageRowCount = page.getrowcount();
+        for (int rowIndex = 0; rowIndex < pageRowCount; rowIndex++)
+            bitmapIndex->add(page.rows[rowIndex][columnIndex], rowCounter++);
+    }
+    bitmapIndex->rowCount = rowCounter;
+    
+    IndexInfo* indexInfo = indices[columnName];
+    if (indexInfo == nullptr) {
+        indexInfo = new IndexInfo(columnName, BITMAP);
+        indices[columnName] = indexInfo;
+    }
+    if (indexInfo->bPlusTreeIndex != nullptr) {
+        if (this->bPlusTreeIndex == indexInfo->bPlusTreeIndex) {
+            this->bPlusTreeIndex = nullptr;
+        }
+        delete indexInfo->bPlusTreeIndex;
+        indexInfo->bPlusTreeIndex = nullptr;
+        bufferManager.deleteFile("../data/temp/" + this->tableName + "_" + columnName + "_bptree.idx");
+    }
+    if (this->indexed && this->indexedColumn == columnName) {
+        this->indexed = false;
+        this->indexedColumn = "";
+        this->indexingStrategy = NOTHING;
+    }
+    delete indexInfo->bitmapIndex;
+    indexInfo->bitmapIndex = bitmapIndex;
+    indexInfo->strategy = BITMAP;
+    
+    cout << "Bitmap index built on " << this->tableName << "." << columnName << ": " << bitmapIndex->getBitmaps().size()
+         << " distinct values, " << bitmapIndex->sizeInBytes() << " bytes" << endl;
+    return true;
+}
+
+/**
+ * @brief Returns the bitmap index on a column. An index that no longer covers
+ * every row, or was dropped by an update, is rebuilt first.
+ *
+ * @param columnName
+ * @return BitmapIndex* nullptr if the column has no bitmap index
+ */
+BitmapIndex* Table::getBitmapIndex(string columnName) {
+    logger.log("Table::getBitmapIndex");
+    auto it = indices.find(columnName);
+    if (it == indices.end() || it->second == nullptr || it->second->strategy != BITMAP)
+        return nullptr;
+    IndexInfo* indexInfo = it->second;
+    if (indexInfo->bitmapIndex == nullptr || indexInfo->bitmapIndex->rowCount != this->rowCount) {
+        if (!this->buildBitmapIndex(columnName))
+            return nullptr;
+    }
+    return indexInfo->bitmapIndex;
+}
+
 /**
  * @brief Construct a new Table:: Table object
  *
@@ -607,7 +738,6 @@ Table::Table()
     this->indexedColumn = "";
     this->indexingStrategy = NOTHING;
 }
-vector<int> sortValues, columnIndexes;
 /**
  * @brief Construct a new Table:: Table object used in the case where the data
  * file is available and LOAD command has been called. This command should be
@@ -632,50 +762,524 @@ Table::Table(string tableName)
         this->tableName = tableName;
     }
 }
-struct MyPair
+/**
+ * @brief A sorted run: the consecutive pages [startPage, startPage + pageCount)
+ * of a scratch table.
+ *
+ */
+struct SortRun
 {
-    vector<int> row;
-    int blockNum;
-    int boundary;
-    int cursorIndex;
+    Table *table;
+    uint startPage;
+    uint pageCount;
+};
 
-    MyPair(vector<int> r, int b, int bound, int c)
-        : row(r), blockNum(b), boundary(bound), cursorIndex(c) {}
+/**
+ * @brief Buffers the rows of the run being written to a table. Consecutive rows
+ * with equal sort keys are folded together with the combiner (if any) before
+ * they reach the page buffer.
+ *
+ */
+struct RunWriter
+{
+    Table *target;
+    const SortKeyEncoder &encoder;
+    const RowCombiner &combiner;
+    vector<vector<int>> outputBuffer;
+    vector<int> pending;
+    vector<unsigned char> pendingKey;
+    uint runStartPage;
+
+    RunWriter(Table *target, const SortKeyEncoder &encoder, const RowCombiner &combiner)
+        : target(target), encoder(encoder), combiner(combiner), pendingKey(encoder.keyWidth), runStartPage(target->blockCount) {}
+
+    void write(const vector<int> &row, const unsigned char *key)
+    {
+        if (!this->pending.empty() && this->combiner && this->encoder.compare(this->pendingKey.data(), key) == 0)
+        {
+            this->combiner(this->pending, row);
+            return;
+        }
+        if (!this->pending.empty())
+        {
+            this->outputBuffer.push_back(this->pending);
+            if (this->outputBuffer.size() == this->target->maxRowsPerBlock)
+                this->target->appendPage(this->outputBuffer);
+        }
+        this->pending = row;
+        copy(key, key + this->encoder.keyWidth, this->pendingKey.begin());
+    }
+
+    /**
+     * @brief Flushes the run and returns it. Runs always end on a page boundary
+     * so that the merge can address them by page.
+     */
+    SortRun endRun()
+    {
+        if (!this->pending.empty())
+            this->outputBuffer.push_back(this->pending);
+        this->pending.clear();
+        this->target->appendPage(this->outputBuffer);
+        SortRun run = {this->target, this->runStartPage, this->target->blockCount - this->runStartPage};
+        this->runStartPage = this->target->blockCount;
+        return run;
+    }
 };
 
-struct CompareByFirstElement
+/**
+ * @brief Generates the initial sorted runs of the pages [firstPage, endPage) of
+ * input into output by replacement selection. A heap holds capacity rows (the
+ * worker's share of the sort buffer); the smallest row is written to the current run and replaced by the
+ * next input row, which joins the current run if it doesn't sort before the
+ * row just written and the next run otherwise. On random input runs come out
+ * about twice the size of the buffer.
+ *
+ * Rows are compared on their normalized keys. The buffer is first filled and
+ * radix sorted, which is already a valid heap; if the whole input fits it is
+ * written out as the only run without going through the heap at all.
+ *
+ * @param input
+ * @param firstPage
+ * @param endPage
+ * @param output
+ * @param capacity
+ * @param encoder
+ * @param combiner
+ * @return vector<SortRun> the runs, in order
+ */
+static vector<SortRun> generateRuns(Table *input, uint firstPage, uint endPage, Table *output, uint capacity, const SortKeyEncoder &encoder, const RowCombiner &combiner)
+{
+    logger.log("generateRuns");
+    uint keyWidth = encoder.keyWidth;
+    vector<vector<int>> slots;
+    vector<unsigned char> slotKeys(capacity * keyWidth);
+    vector<uint> slotRuns;
+    slots.reserve(capacity);
+    slotRuns.reserve(capacity);
+
+    // Min-heap on (run, normalized key); std heap functions build a max-heap
+    auto later = [&](uint a, uint b)
+    {
+        if (slotRuns[a] != slotRuns[b])
+            return slotRuns[a] > slotRuns[b];
+        return encoder.compare(&slotKeys[b * keyWidth], &slotKeys[a * keyWidth]) < 0;
+    };
+
+    uint pageIndex = firstPage;
+    Page page;
+    int pagePointer = 0;
+    int pageRowCount = 0;
+    auto readNext = [&](vector<int> &row)
+    {
+        while (pagePointer >= pageRowCount)
+        {
+            if (pageIndex >= endPage)
+                return false;
+            page = bufferManager.getPage(input->tableName, pageIndex++);
+            pagePointer = 0;
+            pageRowCount = page.getrowcount();
+        }
+        row = page.rows[pagePointer++];
+        return true;
+    };
+
+    vector<int> row;
+    while (slots.size() < capacity && readNext(row))
+    {
+        encoder.encode(row, &slotKeys[slots.size() * keyWidth]);
+        slots.push_back(row);
+        slotRuns.push_back(0);
+    }
+    vector<uint> heap(slots.size());
+    iota(heap.begin(), heap.end(), 0);
+    sortByKeys(heap, slotKeys.data(), keyWidth);
+
+    vector<SortRun> runs;
+    RunWriter writer(output, encoder, combiner);
+    if (!readNext(row))
+    {
+        for (uint slot : heap)
+            writer.write(slots[slot], &slotKeys[slot * keyWidth]);
+        runs.push_back(writer.endRun());
+        return runs;
+    }
+
+    vector<unsigned char> key(keyWidth);
+    bool hasNext = true;
+    uint currentRun = 0;
+    while (!heap.empty())
+    {
+        pop_heap(heap.begin(), heap.end(), later);
+        uint slot = heap.back();
+        heap.pop_back();
+        if (slotRuns[slot] != currentRun)
+        {
+            runs.push_back(writer.endRun());
+            currentRun = slotRuns[slot];
+        }
+        writer.write(slots[slot], &slotKeys[slot * keyWidth]);
+
+        if (hasNext)
+        {
+            encoder.encode(row, key.data());
+            slotRuns[slot] = encoder.compare(key.data(), &slotKeys[slot * keyWidth]) < 0 ? currentRun + 1 : currentRun;
+            slots[slot].swap(row);
+            copy(key.begin(), key.end(), slotKeys.begin() + slot * keyWidth);
+            heap.push_back(slot);
+            push_heap(heap.begin(), heap.end(), later);
+            hasNext = readNext(row);
+        }
+    }
+    runs.push_back(writer.endRun());
+    return runs;
+}
+
+/**
+ * @brief Reads the rows of a sorted run one page at a time through the buffer
+ * manager. current points into the loaded page, so rows are not copied while
+ * they are compared; key holds its normalized key. A reader can be restricted
+ * to the rows whose keys lie in [lowerKey, upperKey) (nullptr meaning
+ * unbounded), in which case it starts at the page found by seek().
+ *
+ */
+struct RunReader
 {
-    bool operator()(const MyPair &lhs, const MyPair &rhs) const
+    string tableName;
+    const SortKeyEncoder *encoder;
+    uint nextPage;
+    uint endPage;
+    const unsigned char *lowerKey;
+    const unsigned char *upperKey;
+    Page page;
+    int pagePointer = -1;
+    int pageRowCount = 0;
+    const vector<int> *current = nullptr;
+    vector<unsigned char> key;
+
+    RunReader(const SortRun &run, const SortKeyEncoder &encoder, const unsigned char *lowerKey = nullptr, const unsigned char *upperKey = nullptr)
+        : tableName(run.table->tableName), encoder(&encoder), nextPage(run.startPage), endPage(run.startPage + run.pageCount),
+          lowerKey(lowerKey), upperKey(upperKey), key(encoder.keyWidth) {}
+
+    /**
+     * @brief Binary searches the pages of the run for the last one whose first
+     * row sorts before lowerKey; no earlier page can hold a row in range.
+     */
+    void seek()
+    {
+        if (!this->lowerKey)
+            return;
+        uint low = this->nextPage, high = this->endPage;
+        while (high - low > 1)
+        {
+            uint middle = low + (high - low) / 2;
+            Page middlePage = bufferManager.getPage(this->tableName, middle);
+            this->encoder->encode(middlePage.rows[0], this->key.data());
+            if (this->encoder->compare(this->key.data(), this->lowerKey) < 0)
+                low = middle;
+            else
+                high = middle;
+        }
+        this->nextPage = low;
+    }
+
+    bool advance()
     {
-        for (int i = 0; i < columnIndexes.size(); i++)
+        do
         {
-            if (lhs.row[columnIndexes[i]] != rhs.row[columnIndexes[i]])
+            this->pagePointer++;
+            while (this->pagePointer >= this->pageRowCount)
             {
-                if (sortValues[i] == 0)
-                    return lhs.row[columnIndexes[i]] > rhs.row[columnIndexes[i]];
-                else if (sortValues[i] == 1)
-                    return lhs.row[columnIndexes[i]] < rhs.row[columnIndexes[i]];
+                if (this->nextPage >= this->endPage)
+                {
+                    this->current = nullptr;
+                    return false;
+                }
+                this->page = bufferManager.getPage(this->tableName, this->nextPage++);
+                this->pagePointer = 0;
+                this->pageRowCount = this->page.getrowcount();
             }
+            this->current = &this->page.rows[this->pagePointer];
+            this->encoder->encode(*this->current, this->key.data());
+        } while (this->lowerKey && this->encoder->compare(this->key.data(), this->lowerKey) < 0);
+
+        if (this->upperKey && this->encoder->compare(this->key.data(), this->upperKey) >= 0)
+        {
+            this->current = nullptr;
+            this->nextPage = this->endPage;
+            return false;
         }
-        return false;
+        return true;
     }
 };
 
-static bool sortComparator(const vector<int> &a, const vector<int> &b)
+/**
+ * @brief Tournament tree of losers over the heads of K runs. Each internal node
+ * remembers the run that lost the match played there and tree[0] the overall
+ * winner, so after the winner advances only the matches on its leaf-to-root
+ * path are replayed: ceil(log2 K) comparisons per row, against half that of a
+ * binary heap's sift-down, and no row is ever copied into the tree.
+ *
+ */
+class LoserTree
 {
-    logger.log("Inside Sort Comp");
-    for (int i = 0; i < columnIndexes.size(); i++)
+    vector<RunReader> &readers;
+    vector<int> tree;
+    int runCount;
+
+    // Exhausted runs lose every match; ties go to the earlier run
+    bool beats(int a, int b)
+    {
+        if (!this->readers[a].current)
+            return false;
+        if (!this->readers[b].current)
+            return true;
+        int order = this->readers[a].encoder->compare(this->readers[a].key.data(), this->readers[b].key.data());
+        return order < 0 || (order == 0 && a < b);
+    }
+
+public:
+    LoserTree(vector<RunReader> &readers) : readers(readers)
     {
-        logger.log("SORT COL INDEX: " + to_string(columnIndexes[i]));
-        if (a[columnIndexes[i]] != b[columnIndexes[i]])
+        this->runCount = readers.size();
+        this->tree.assign(this->runCount, 0);
+        vector<int> winners(2 * this->runCount);
+        for (int run = 0; run < this->runCount; run++)
+            winners[this->runCount + run] = run;
+        for (int node = this->runCount - 1; node >= 1; node--)
         {
-            if (sortValues[i] == 0)
-                return a[columnIndexes[i]] < b[columnIndexes[i]];
-            else if (sortValues[i] == 1)
-                return a[columnIndexes[i]] > b[columnIndexes[i]];
+            int left = winners[2 * node], right = winners[2 * node + 1];
+            winners[node] = this->beats(right, left) ? right : left;
+            this->tree[node] = winners[node] == left ? right : left;
         }
+        this->tree[0] = this->runCount > 1 ? winners[1] : 0;
     }
-    return false;
+
+    int winner()
+    {
+        return this->tree[0];
+    }
+
+    // Replays the matches of run after its head has advanced
+    void replay(int run)
+    {
+        int winner = run;
+        for (int node = (this->runCount + run) / 2; node >= 1; node /= 2)
+            if (this->beats(this->tree[node], winner))
+                swap(this->tree[node], winner);
+        this->tree[0] = winner;
+    }
+};
+
+/**
+ * @brief Merges runs into one run appended to target. Rows with equal sort
+ * keys are folded together with combiner (if given) before they are written.
+ * Only rows with keys in [lowerKey, upperKey) are merged if bounds are given.
+ *
+ * @param runs
+ * @param target
+ * @param encoder
+ * @param combiner
+ * @param lowerKey
+ * @param upperKey
+ * @return SortRun the merged run
+ */
+static SortRun mergeRuns(const vector<SortRun> &runs, Table *target, const SortKeyEncoder &encoder, const RowCombiner &combiner,
+                         const unsigned char *lowerKey = nullptr, const unsigned char *upperKey = nullptr)
+{
+    logger.log("mergeRuns");
+    vector<RunReader> readers;
+    readers.reserve(runs.size());
+    for (auto &run : runs)
+    {
+        readers.emplace_back(run, encoder, lowerKey, upperKey);
+        readers.back().seek();
+        readers.back().advance();
+    }
+
+    LoserTree tree(readers);
+    RunWriter writer(target, encoder, combiner);
+    while (readers[tree.winner()].current)
+    {
+        int run = tree.winner();
+        writer.write(*readers[run].current, readers[run].key.data());
+        readers[run].advance();
+        tree.replay(run);
+    }
+    return writer.endRun();
+}
+
+/**
+ * @brief Picks splitter keys that cut the key range of runs into partCount
+ * parts of about equal size. A few evenly spaced pages of every run are read
+ * and the keys of their rows sorted; the splitters are taken at equal
+ * distances in that sample.
+ *
+ * @param runs
+ * @param partCount
+ * @param encoder
+ * @return vector<unsigned char> partCount - 1 keys of keyWidth bytes each
+ */
+static vector<unsigned char> sampleSplitters(const vector<SortRun> &runs, uint partCount, const SortKeyEncoder &encoder)
+{
+    logger.log("sampleSplitters");
+    const uint SAMPLE_PAGES_PER_RUN = 8;
+    uint keyWidth = encoder.keyWidth;
+    vector<unsigned char> samples;
+    for (auto &run : runs)
+    {
+        uint samplePages = min(run.pageCount, SAMPLE_PAGES_PER_RUN);
+        for (uint sample = 0; sample < samplePages; sample++)
+        {
+            Page page = bufferManager.getPage(run.table->tableName, run.startPage + sample * run.pageCount / samplePages);
+            for (int row = 0; row < page.getrowcount(); row++)
+            {
+                samples.resize(samples.size() + keyWidth);
+                encoder.encode(page.rows[row], &samples[samples.size() - keyWidth]);
+            }
+        }
+    }
+
+    uint sampleCount = keyWidth ? samples.size() / keyWidth : 0;
+    vector<uint> order(sampleCount);
+    iota(order.begin(), order.end(), 0);
+    sortByKeys(order, samples.data(), keyWidth);
+    vector<unsigned char> splitters;
+    for (uint part = 1; part < partCount && sampleCount; part++)
+    {
+        uint sample = order[(unsigned long long)part * sampleCount / partCount];
+        splitters.insert(splitters.end(), samples.begin() + sample * keyWidth, samples.begin() + (sample + 1) * keyWidth);
+    }
+    return splitters;
+}
+
+/**
+ * @brief Moves page partPage of part to page targetPage of target. Page files
+ * are renamed when both tables use the same layout. A page of a column layout
+ * table shares its files with the other pages, and a page changing layout has
+ * to be converted, so those are read and written out again instead.
+ *
+ */
+static void movePage(Table *part, uint partPage, Table *target, uint targetPage)
+{
+    string targetPageName = "../data/temp/" + target->tableName + "_Page" + to_string(targetPage);
+    string partPageName = "../data/temp/" + part->tableName + "_Page" + to_string(partPage);
+    bufferManager.deletePage(targetPageName);
+    if (part->pageLayout != target->pageLayout || target->pageLayout == COLUMN_LAYOUT)
+    {
+        Page page = bufferManager.getPage(part->tableName, partPage);
+        bufferManager.deletePage(partPageName);
+        bufferManager.writePage(target->tableName, targetPage, page.rows, part->rowsPerBlockCount[partPage], target->pageLayout);
+        if (part->pageLayout != COLUMN_LAYOUT)
+            bufferManager.deleteFile(part->tableName, partPage);
+        return;
+    }
+    bufferManager.deletePage(partPageName);
+    rename(partPageName.c_str(), targetPageName.c_str());
+}
+
+/**
+ * @brief Replaces the pages of target by the pages of the scratch tables parts,
+ * one after the other. Page files are renamed rather than copied and any stale
+ * copies are dropped from the pool. The column statistics of target become
+ * the merged statistics of the parts. Parts that kept no sketches (see
+ * Table::isScratch) have their pages read back to build those of target.
+ *
+ */
+void movePages(const vector<Table *> &parts, Table *target)
+{
+    logger.log("movePages");
+    uint oldBlockCount = target->blockCount;
+    target->blockCount = 0;
+    target->rowsPerBlockCount.clear();
+    target->pageZones.clear();
+    target->rowCount = 0;
+    target->columnStatistics.assign(target->columnCount, ColumnStatistics());
+    for (Table *part : parts)
+    {
+        for (uint columnCounter = 0; columnCounter < target->columnCount && columnCounter < part->columnStatistics.size(); columnCounter++)
+            target->columnStatistics[columnCounter].merge(part->columnStatistics[columnCounter]);
+        for (uint pageIndex = 0; pageIndex < part->blockCount; pageIndex++)
+        {
+            if (part->isScratch && !target->isScratch)
+            {
+                Page page = bufferManager.getPage(part->tableName, pageIndex);
+                target->updatePageSketches(target->blockCount, page.rows, page.getrowcount());
+            }
+            else
+                target->pageZones.push_back(pageIndex < part->pageZones.size() ? part->pageZones[pageIndex] : PageZone());
+            movePage(part, pageIndex, target, target->blockCount);
+            target->rowsPerBlockCount.push_back(part->rowsPerBlockCount[pageIndex]);
+            target->blockCount++;
+        }
+        target->rowCount += part->rowCount;
+        part->blockCount = 0;
+        part->rowsPerBlockCount.clear();
+        part->pageZones.clear();
+        part->rowCount = 0;
+    }
+    for (uint pageIndex = target->blockCount; pageIndex < oldBlockCount; pageIndex++)
+    {
+        bufferManager.deletePage("../data/temp/" + target->tableName + "_Page" + to_string(pageIndex));
+        bufferManager.deleteFile(target->tableName, pageIndex);
+    }
+}
+
+/**
+ * @brief Fan-in of every merge when workerCount merges run at once: each one
+ * gets an equal share of the sort buffer, one block of which is its output.
+ *
+ * @param workerCount
+ * @return uint
+ */
+uint getSortMergeWays(uint workerCount)
+{
+    return max(2u, SORT_BUFFER_BLOCKS / workerCount - 1);
+}
+
+/**
+ * @brief Estimated merge passes of externalSort over blockCount pages with
+ * workerCount threads. Replacement selection produces runs of about twice a
+ * worker's buffer and every worker produces at least one run.
+ *
+ * @param blockCount
+ * @param workerCount
+ * @return double
+ */
+double estimateSortMergePasses(double blockCount, uint workerCount)
+{
+    double runCount = max((double)workerCount, ceil(blockCount / (2.0 * SORT_BUFFER_BLOCKS / workerCount)));
+    return runCount > 1 ? ceil(log(runCount) / log(getSortMergeWays(workerCount))) : 0;
+}
+
+/**
+ * @brief Number of threads the external sort of a table of blockCount pages
+ * uses. Threads split the sort buffer, which shortens the runs and lowers the
+ * merge fan-in, so only as many are used as keep the merge passes of a single
+ * threaded sort. Every thread needs at least two blocks of the sort buffer.
+ *
+ * @param blockCount
+ * @return uint
+ */
+uint getSortWorkerCount(uint blockCount)
+{
+    uint workerCount = max(1u, min(min(SORT_THREAD_COUNT, SORT_BUFFER_BLOCKS / 2), blockCount));
+    double passes = estimateSortMergePasses(blockCount, 1);
+    while (workerCount > 1 && estimateSortMergePasses(blockCount, workerCount) > passes)
+        workerCount--;
+    return workerCount;
+}
+
+/**
+ * @brief Estimated block accesses of externalSort on a table of blockCount
+ * pages: every page is read and written once to generate the runs and once
+ * more per merge pass.
+ *
+ * @param blockCount
+ * @return double
+ */
+double estimateSortCost(uint blockCount)
+{
+    return 2.0 * blockCount * (1 + estimateSortMergePasses(blockCount, getSortWorkerCount(blockCount)));
 }
 
 Matrix::Matrix(string matrixname)
@@ -713,11 +1317,7 @@ Table::Table(string tableName, vector<string> columns)
     this->columns = columns;
     this->columnCount = columns.size();
     this->maxRowsPerBlock = (uint)((BLOCK_SIZE * 1000) / (sizeof(int) * columnCount));
-    
-    // Initialize distinctValuesInColumns and distinctValuesPerColumnCount
-    unordered_set<int> dummy;
-    this->distinctValuesInColumns.assign(this->columnCount, dummy);
-    this->distinctValuesPerColumnCount.assign(this->columnCount, 0);
+    this->columnStatistics.assign(this->columnCount, ColumnStatistics());
     
     // Make sure we can open the file for writing
     ofstream testFile(this->sourceFileName);
@@ -836,9 +1436,51 @@ bool Matrix::extractColumnCount(string firstLine)
     return true;
 }
 
+// A compressed page holds at most this many times the rows of a row layout page
+const uint MAX_COMPRESSION_FACTOR = 8;
+
+/**
+ * @brief Rows per block of a table in the compressed layout. The first rows of
+ * the source file (as many as the largest page holds) are encoded the way
+ * pages are, and a block gets as many rows as fit in BLOCK_SIZE at their size
+ * per row; but no fewer than a row layout page holds and no more than
+ * MAX_COMPRESSION_FACTOR times that.
+ *
+ * @return uint
+ */
+uint Table::getCompressedRowsPerBlock()
+{
+    logger.log("Table::getCompressedRowsPerBlock");
+    uint sampleSize = this->maxRowsPerBlock * MAX_COMPRESSION_FACTOR;
+    vector<vector<int>> columnValues(this->columnCount);
+    ifstream fin(this->sourceFileName, ios::in);
+    string line, word;
+    getline(fin, line);
+    uint sampleRows = 0;
+    while (sampleRows < sampleSize && getline(fin, line))
+    {
+        stringstream s(line);
+        for (int columnCounter = 0; columnCounter < this->columnCount && getline(s, word, ','); columnCounter++)
+            columnValues[columnCounter].push_back(stoi(word));
+        sampleRows++;
+    }
+    fin.close();
+    if (sampleRows == 0)
+        return this->maxRowsPerBlock;
+
+    double bytes = (this->columnCount + 3) * sizeof(uint);
+    for (vector<int> &values : columnValues)
+        bytes += getEncodedSize(encodeColumn(values.data(), values.size()));
+    uint rowsPerBlock = (uint)(BLOCK_SIZE * 1000 / (bytes / sampleRows));
+    rowsPerBlock = max(this->maxRowsPerBlock, min(rowsPerBlock, sampleSize));
+    logger.log("Table::getCompressedRowsPerBlock: " + to_string(bytes / sampleRows) + " bytes per row, " + to_string(rowsPerBlock) + " rows per block");
+    return rowsPerBlock;
+}
+
 /**
  * @brief This function splits all the rows and stores them in multiple files of
- * one block size.
+ * one block size. Compressed pages fit more rows in a block than the other
+ * layouts (see getCompressedRowsPerBlock).
  *
  * @return true if successfully blockified
  * @return false otherwise
@@ -846,15 +1488,16 @@ bool Matrix::extractColumnCount(string firstLine)
 bool Table::blockify()
 {
     logger.log("Table::blockify");
+    OperatorScope scope("write " + this->tableName);
+    if (this->pageLayout == COMPRESSED_LAYOUT)
+        this->maxRowsPerBlock = this->getCompressedRowsPerBlock();
     ifstream fin(this->sourceFileName, ios::in);
     string line, word;
     vector<int> row(this->columnCount, 0);
     vector<vector<int>> rowsInPage(this->maxRowsPerBlock, row);
     int pageCounter = 0;
-    unordered_set<int> dummy;
-    dummy.clear();
-    this->distinctValuesInColumns.assign(this->columnCount, dummy);
-    this->distinctValuesPerColumnCount.assign(this->columnCount, 0);
+    this->columnStatistics.assign(this->columnCount, ColumnStatistics());
+    vector<ValueSampler> samplers(this->columnCount);
     getline(fin, line);
     while (getline(fin, line))
     {
@@ -865,12 +1508,13 @@ bool Table::blockify()
                 return false;
             row[columnCounter] = stoi(word);
             rowsInPage[pageCounter][columnCounter] = row[columnCounter];
+            samplers[columnCounter].add(row[columnCounter]);
         }
         pageCounter++;
         this->updateStatistics(row);
         if (pageCounter == this->maxRowsPerBlock)
         {
-            bufferManager.writePage(this->tableName, this->blockCount, rowsInPage, pageCounter);
+            this->writePage(this->blockCount, rowsInPage, pageCounter);
             this->blockCount++;
             this->rowsPerBlockCount.emplace_back(pageCounter);
             pageCounter = 0;
@@ -878,15 +1522,17 @@ bool Table::blockify()
     }
     if (pageCounter)
     {
-        bufferManager.writePage(this->tableName, this->blockCount, rowsInPage, pageCounter);
+        this->writePage(this->blockCount, rowsInPage, pageCounter);
         this->blockCount++;
         this->rowsPerBlockCount.emplace_back(pageCounter);
         pageCounter = 0;
     }
+    for (int columnCounter = 0; columnCounter < this->columnCount; columnCounter++)
+        this->columnStatistics[columnCounter].histogram.build(samplers[columnCounter].values);
+    scope.setRows(this->rowCount);
 
     if (this->rowCount == 0)
         return false;
-    this->distinctValuesInColumns.clear();
     return true;
 }
 
@@ -932,75 +1578,105 @@ bool Matrix::blockify()
     return true;
 }
 /**
- * @brief Given a row of values, this function will update the statistics it
- * stores i.e. it updates the number of rows that are present in the column and
- * the number of distinct values present in each column. These statistics are to
- * be used during optimisation.
+ * @brief Given a row of values read by blockify, this function updates the
+ * number of rows of the table. The statistics of its columns are collected as
+ * the pages are written (see writePage).
  *
  * @param row
  */
 void Table::updateStatistics(vector<int> row)
 {
     this->rowCount++;
-    
-    // Ensure distinctValuesInColumns and distinctValuesPerColumnCount are properly sized
-    if (this->distinctValuesInColumns.size() != this->columnCount) {
-        unordered_set<int> dummy;
-        this->distinctValuesInColumns.assign(this->columnCount, dummy);
-    }
-    
-    if (this->distinctValuesPerColumnCount.size() != this->columnCount) {
-        this->distinctValuesPerColumnCount.assign(this->columnCount, 0);
-    }
-    
-    // Update statistics for each column
-    for (int columnCounter = 0; columnCounter < this->columnCount && columnCounter < row.size(); columnCounter++)
+}
+
+/**
+ * @brief Estimated number of distinct values of a column, from its
+ * HyperLogLog sketch.
+ *
+ * @param columnIndex
+ * @return uint 0 if nothing is known about the column
+ */
+uint Table::getDistinctValueCount(int columnIndex)
+{
+    if (columnIndex < 0 || columnIndex >= (int)this->columnStatistics.size() || this->columnStatistics[columnIndex].isEmpty())
+        return 0;
+    unsigned long long distinctValues = this->columnStatistics[columnIndex].distinctValues.estimate();
+    if (this->rowCount > 0)
+        distinctValues = min(distinctValues, (unsigned long long)this->rowCount);
+    return max(1ULL, distinctValues);
+}
+
+/**
+ * @brief Executes ANALYZE: reads the table once and replaces the statistics
+ * of every column, so that the sketches, ranges and histograms the planner
+ * uses describe the rows as they are now rather than as they were loaded.
+ * Values that were overwritten or deleted since are forgotten as well. The
+ * count of cells INSERT filled in is kept, it can't be told from the pages.
+ *
+ */
+void Table::analyze()
+{
+    logger.log("Table::analyze");
+    vector<ColumnStatistics> statistics(this->columnCount);
+    vector<ValueSampler> samplers(this->columnCount);
+    Cursor cursor = this->getCursor();
+    vector<int> row = cursor.getNext();
+    while (!row.empty())
     {
-        if (!this->distinctValuesInColumns[columnCounter].count(row[columnCounter]))
+        for (uint columnCounter = 0; columnCounter < this->columnCount && columnCounter < row.size(); columnCounter++)
         {
-            this->distinctValuesInColumns[columnCounter].insert(row[columnCounter]);
-            this->distinctValuesPerColumnCount[columnCounter]++;
+            statistics[columnCounter].add(row[columnCounter]);
+            samplers[columnCounter].add(row[columnCounter]);
         }
+        row = cursor.getNext();
+    }
+    for (uint columnCounter = 0; columnCounter < this->columnCount; columnCounter++)
+    {
+        statistics[columnCounter].histogram.build(samplers[columnCounter].values);
+        if (columnCounter < this->columnStatistics.size())
+            statistics[columnCounter].nullCount = this->columnStatistics[columnCounter].nullCount;
     }
+    this->columnStatistics = statistics;
 }
-void Table::sortTable(bool makePermanent)
+/**
+ * @brief Sorts the table in place on parsedQuery.sortColumns in the orders
+ * given by parsedQuery.sortStrategy using externalSort.
+ *
+ * If a combiner is given, rows with equal sort keys are folded into one row
+ * with it while the runs are generated and again during every merge, so the
+ * table may end up with fewer rows (and pages) than it started with. Sort based
+ * GROUP BY uses this to aggregate early.
+ *
+ * If limit is not negative only the first limit rows of the sorted order are
+ * kept, which is done by topK instead of a full sort.
+ *
+ * @param makePermanent
+ * @param combiner
+ * @param limit
+ */
+void Table::sortTable(bool makePermanent, RowCombiner combiner, long long limit)
 {
     logger.log("Table::sortTable");
 
-    // Initialize sorting parameters
-    sortValues.resize(parsedQuery.sortStrategy.size(), 0);
-    columnIndexes.resize(parsedQuery.sortStrategy.size());
-
-    // Store sorting order
-    for (int i = 0; i < parsedQuery.sortStrategy.size(); i++)
-    {
-        if (parsedQuery.sortStrategy[i] == DESC)
-            sortValues[i] = 1;
-    }
-
-    // Store column indices to sort by
+    vector<int> columnIndexes;
+    vector<bool> descending;
     for (int i = 0; i < parsedQuery.sortColumns.size(); i++)
     {
-        columnIndexes[i] = this->getColumnIndex(parsedQuery.sortColumns[i]);
+        columnIndexes.push_back(this->getColumnIndex(parsedQuery.sortColumns[i]));
+        descending.push_back(i < parsedQuery.sortStrategy.size() && parsedQuery.sortStrategy[i] == DESC);
     }
+    SortKeyEncoder encoder(columnIndexes, descending);
 
-    // Sort each page individually first
-    for (int pageIndex = 0; pageIndex < this->blockCount; pageIndex++)
+    if (limit >= 0)
+        this->topK(encoder, limit);
+    else if (combiner || !encoder.isPrefixOf(this->sortedColumnIndexes, this->sortedDescending))
     {
-        Page page = bufferManager.getPage(this->tableName, pageIndex);
-        vector<vector<int>> pageData = page.getAllRows();
-        int rowCount = page.getrowcount();
-
-        // Sort the page data
-        sort(pageData.begin(), pageData.begin() + rowCount, sortComparator);
-
-        // Write back the sorted page
-        bufferManager.writePage(this->tableName, pageIndex, pageData, rowCount);
+        // Perform external merge sort
+        this->externalSort(encoder, combiner);
+        this->sortedColumnIndexes = columnIndexes;
+        this->sortedDescending = descending;
     }
 
-    // Perform external merge sort
-    this->externalSort();
-
     // Make the sorted table permanent only if requested
     if (makePermanent)
     {
@@ -1008,77 +1684,251 @@ void Table::sortTable(bool makePermanent)
     }
 }
 
-void Table::externalSort()
+/**
+ * @brief Keeps the first limit rows of the table in the order of encoder,
+ * sorted, either in resultTable or in place of this table's rows.
+ *
+ * The rows are scanned once through a bounded max-heap of the limit smallest
+ * normalized keys seen so far, so memory is O(limit) rather than a full
+ * external sort. If the catalogue says the table is already sorted on the key
+ * only its first limit rows are read. A limit that doesn't fit in the sort
+ * buffer falls back to externalSort and drops the rows past the limit.
+ *
+ * @param encoder
+ * @param limit
+ * @param resultTable empty table to hold the rows instead of this one
+ */
+void Table::topK(const SortKeyEncoder &encoder, long long limit, Table *resultTable)
 {
-    logger.log("Table::externalSort");
-
-    int K = BLOCK_COUNT - 1; // K-way merge
-    int mergeIterations = ceil(log(this->blockCount) / log(K));
-
-    for (int iteration = 0; iteration < mergeIterations; iteration++)
+    logger.log("Table::topK");
+    OperatorScope scope("top-k " + this->tableName);
+    // Its pages become the result, so they keep their sketches
+    Table *scratchTable = new Table(this->tableName + "_TopK", this->columns, false, 0);
+    tableCatalogue.insertTable(scratchTable);
+    limit = min(limit, this->rowCount);
+    vector<vector<int>> rows;
+
+    if (limit <= 0 || this->blockCount == 0)
+        ;
+    else if (encoder.isPrefixOf(this->sortedColumnIndexes, this->sortedDescending))
     {
-        int size = pow(K, iteration);
-        int clusters = ceil((double)this->blockCount / size);
-
-        for (int cluster = 0; cluster < clusters; cluster++)
+        logger.log("Table::topK: already sorted, reading the first " + to_string(limit) + " rows");
+        for (uint pageIndex = 0; pageIndex < this->blockCount && scratchTable->rowCount + rows.size() < limit; pageIndex++)
         {
-            int start = cluster * size;
-            int end = min(start + size - 1, (int)this->blockCount - 1);
-
-            // Create output buffer for merged data
-            vector<vector<int>> outputBuffer;
-            outputBuffer.reserve(this->maxRowsPerBlock);
-
-            // Create priority queue for K-way merge
-            priority_queue<MyPair, vector<MyPair>, CompareByFirstElement> pq;
-            vector<Cursor> cursors;
-
-            // Initialize cursors for each block in the cluster
-            for (int i = start; i <= end; i++)
+            Page page = bufferManager.getPage(this->tableName, pageIndex);
+            for (int rowIndex = 0; rowIndex < page.getrowcount() && scratchTable->rowCount + rows.size() < limit; rowIndex++)
             {
-                Cursor cursor(this->tableName, i);
-                cursors.push_back(cursor);
-
-                // Get first row from each block
-                vector<int> row = cursor.getNext();
-                if (!row.empty())
-                {
-                    pq.push({row, i, end, cursors.size() - 1});
-                }
+                rows.push_back(page.rows[rowIndex]);
+                if (rows.size() == scratchTable->maxRowsPerBlock)
+                    scratchTable->appendPage(rows);
             }
+        }
+        scratchTable->appendPage(rows);
+    }
+    else if (limit <= (long long)SORT_BUFFER_BLOCKS * this->maxRowsPerBlock)
+    {
+        logger.log("Table::topK: heap of " + to_string(limit) + " rows");
+        uint keyWidth = encoder.keyWidth;
+        vector<vector<int>> slots;
+        vector<unsigned char> slotKeys((limit + 1) * keyWidth);
+        vector<uint> heap;
+        slots.reserve(limit);
+        heap.reserve(limit);
+        // Max-heap on the normalized key, so the top is the row to evict next
+        auto before = [&](uint a, uint b)
+        {
+            return encoder.compare(&slotKeys[a * keyWidth], &slotKeys[b * keyWidth]) < 0;
+        };
+        unsigned char *candidateKey = &slotKeys[limit * keyWidth];
 
-            // Merge blocks
-            int outputPageIndex = 0;
-            while (!pq.empty())
-            {
-                MyPair top = pq.top();
-                pq.pop();
-
-                outputBuffer.push_back(top.row);
-
-                // If output buffer is full, write it to disk
-                if (outputBuffer.size() == this->maxRowsPerBlock)
+        for (uint pageIndex = 0; pageIndex < this->blockCount; pageIndex++)
+        {
+            Page page = bufferManager.getPage(this->tableName, pageIndex);
+            for (int rowIndex = 0; rowIndex < page.getrowcount(); rowIndex++)
+            {
+                encoder.encode(page.rows[rowIndex], candidateKey);
+                uint slot;
+                if (slots.size() < limit)
                 {
-                    bufferManager.writePage(this->tableName, outputPageIndex, outputBuffer, outputBuffer.size());
-                    outputBuffer.clear();
-                    outputPageIndex++;
+                    slot = slots.size();
+                    slots.push_back(page.rows[rowIndex]);
                 }
-
-                // Get next row from the block that provided the top element
-                vector<int> nextRow = cursors[top.cursorIndex].getNext();
-                if (!nextRow.empty())
+                else if (encoder.compare(candidateKey, &slotKeys[heap.front() * keyWidth]) < 0)
                 {
-                    pq.push({nextRow, top.blockNum, top.boundary, top.cursorIndex});
+                    pop_heap(heap.begin(), heap.end(), before);
+                    slot = heap.back();
+                    heap.pop_back();
+                    slots[slot] = page.rows[rowIndex];
                 }
+                else
+                    continue;
+                memcpy(&slotKeys[slot * keyWidth], candidateKey, keyWidth);
+                heap.push_back(slot);
+                push_heap(heap.begin(), heap.end(), before);
             }
+        }
 
-            // Write remaining rows in output buffer
-            if (!outputBuffer.empty())
-            {
-                bufferManager.writePage(this->tableName, outputPageIndex, outputBuffer, outputBuffer.size());
-            }
+        sortByKeys(heap, slotKeys.data(), keyWidth);
+        for (uint slot : heap)
+        {
+            rows.push_back(slots[slot]);
+            if (rows.size() == scratchTable->maxRowsPerBlock)
+                scratchTable->appendPage(rows);
+        }
+        scratchTable->appendPage(rows);
+    }
+    else
+    {
+        logger.log("Table::topK: limit exceeds the sort buffer, sorting");
+        this->externalSort(encoder, nullptr, scratchTable);
+        uint pageCount = 0;
+        long long keptRows = 0;
+        while (pageCount < scratchTable->blockCount && keptRows + scratchTable->rowsPerBlockCount[pageCount] <= limit)
+            keptRows += scratchTable->rowsPerBlockCount[pageCount++];
+        if (keptRows < limit)
+        {
+            Page page = bufferManager.getPage(scratchTable->tableName, pageCount);
+            rows.assign(page.rows.begin(), page.rows.begin() + (limit - keptRows));
+            scratchTable->writePage(pageCount, rows, rows.size());
+            scratchTable->rowsPerBlockCount[pageCount++] = rows.size();
+            keptRows = limit;
         }
+        for (uint pageIndex = pageCount; pageIndex < scratchTable->blockCount; pageIndex++)
+        {
+            bufferManager.deletePage("../data/temp/" + scratchTable->tableName + "_Page" + to_string(pageIndex));
+            bufferManager.deleteFile(scratchTable->tableName, pageIndex);
+        }
+        scratchTable->blockCount = pageCount;
+        scratchTable->rowsPerBlockCount.resize(pageCount);
+        scratchTable->pageZones.resize(min((uint)scratchTable->pageZones.size(), pageCount));
+        scratchTable->rowCount = keptRows;
     }
+
+    Table *target = resultTable ? resultTable : this;
+    movePages({scratchTable}, target);
+    tableCatalogue.deleteTable(scratchTable->tableName);
+    target->sortedColumnIndexes = encoder.getColumnIndexes();
+    target->sortedDescending = encoder.getDescending();
+}
+
+/**
+ * @brief External merge sort of the table on the normalized keys produced by
+ * encoder, spread over getSortWorkerCount() threads that share the
+ * SORT_BUFFER_BLOCKS blocks of sort memory equally.
+ *
+ * Every worker generates runs by replacement selection over its own range of
+ * pages into its own scratch table. The runs are then merged
+ * getSortMergeWays() at a time, the merges of a pass running in parallel, each
+ * into a new scratch table. Once a single merge would be left, its key range
+ * is instead split by sampled splitters and every worker merges one key range
+ * of all runs, so the last pass is parallel too. The final run(s) are moved
+ * under the name of resultTable, or back under this table's name if there is
+ * none.
+ *
+ * @param encoder
+ * @param combiner folds rows with equal sort keys together while sorting
+ * @param resultTable empty table to hold the sorted rows instead of this one
+ */
+void Table::externalSort(const SortKeyEncoder &encoder, RowCombiner combiner, Table *resultTable)
+{
+    logger.log("Table::externalSort");
+    if (this->blockCount == 0)
+        return;
+    logger.log("Table::externalSort: " + this->tableName + " into " + (resultTable ? resultTable->tableName : this->tableName));
+
+    uint workerCount = getSortWorkerCount(this->blockCount);
+    uint mergeWays = getSortMergeWays(workerCount);
+    uint workerCapacity = max(1u, SORT_BUFFER_BLOCKS / workerCount * this->maxRowsPerBlock);
+    uint scratchCount = 0;
+    Table *target = resultTable ? resultTable : this;
+    // Scratch tables are created on this thread since workers read the
+    // catalogue. Only those of the pass expected to produce the result keep
+    // sketches of their pages; movePages builds any that turn out missing.
+    auto newScratchTables = [&](uint count, bool isFinalPass)
+    {
+        vector<Table *> tables;
+        for (uint i = 0; i < count; i++)
+        {
+            tables.push_back(new Table(this->tableName + "_SortRun" + to_string(scratchCount++), this->columns, !isFinalPass || target->isScratch, 0));
+            tableCatalogue.insertTable(tables.back());
+        }
+        return tables;
+    };
+
+    // A single worker writes a single run if the rows fit in its buffer or
+    // are already in order
+    bool isSingleRun = workerCount == 1 && (this->rowCount <= workerCapacity || encoder.isPrefixOf(this->sortedColumnIndexes, this->sortedDescending));
+    vector<Table *> workerTables = newScratchTables(workerCount, isSingleRun);
+    vector<vector<SortRun>> workerRuns(workerCount);
+    vector<SortRun> runs;
+    {
+        OperatorScope scope("sort " + this->tableName + ": run generation");
+        parallelFor(workerCount, workerCount, [&](uint worker)
+                    {
+            uint firstPage = (unsigned long long)this->blockCount * worker / workerCount;
+            uint endPage = (unsigned long long)this->blockCount * (worker + 1) / workerCount;
+            workerRuns[worker] = generateRuns(this, firstPage, endPage, workerTables[worker], workerCapacity, encoder, combiner); });
+        for (auto &generated : workerRuns)
+            runs.insert(runs.end(), generated.begin(), generated.end());
+        scope.setRows(this->rowCount);
+    }
+    logger.log("Table::externalSort: " + to_string(workerCount) + " workers generated " + to_string(runs.size()) + " runs from " + to_string(this->blockCount) + " pages");
+
+    vector<Table *> resultTables;
+    uint mergePass = 0;
+    while (resultTables.empty())
+    {
+        if (runs.size() == 1 && runs[0].startPage == 0 && runs[0].pageCount == runs[0].table->blockCount)
+        {
+            resultTables.push_back(runs[0].table);
+            break;
+        }
+        OperatorScope scope("sort " + this->tableName + ": merge pass " + to_string(++mergePass) + " of " + to_string(runs.size()) + " runs");
+
+        vector<SortRun> mergedRuns;
+        if (runs.size() <= mergeWays && workerCount > 1)
+        {
+            // Final pass: every worker merges one key range of all runs
+            vector<unsigned char> splitters = sampleSplitters(runs, workerCount, encoder);
+            uint partCount = splitters.size() / encoder.keyWidth + 1;
+            resultTables = newScratchTables(partCount, true);
+            parallelFor(partCount, workerCount, [&](uint part)
+                        {
+                const unsigned char *lowerKey = part ? &splitters[(part - 1) * encoder.keyWidth] : nullptr;
+                const unsigned char *upperKey = part + 1 < partCount ? &splitters[part * encoder.keyWidth] : nullptr;
+                mergeRuns(runs, resultTables[part], encoder, combiner, lowerKey, upperKey); });
+        }
+        else
+        {
+            uint groupCount = (runs.size() + mergeWays - 1) / mergeWays;
+            vector<Table *> groupTables = newScratchTables(groupCount, groupCount == 1);
+            mergedRuns.resize(groupCount);
+            parallelFor(groupCount, workerCount, [&](uint group)
+                        {
+                vector<SortRun> groupRuns(runs.begin() + group * mergeWays, runs.begin() + min((group + 1) * mergeWays, (uint)runs.size()));
+                mergedRuns[group] = mergeRuns(groupRuns, groupTables[group], encoder, combiner); });
+        }
+        logger.log("Table::externalSort: merged " + to_string(runs.size()) + " runs into " + to_string(resultTables.empty() ? mergedRuns.size() : resultTables.size()));
+
+        // Every run of the pass has been merged, so its scratch tables can go
+        set<string> mergedTables;
+        for (auto &run : runs)
+            mergedTables.insert(run.table->tableName);
+        for (const string &tableName : mergedTables)
+            tableCatalogue.deleteTable(tableName);
+        runs = mergedRuns;
+    }
+
+    // Sorting without combining rows only reorders them, so the histograms
+    // still describe the result
+    vector<EquiDepthHistogram> histograms;
+    for (const ColumnStatistics &statistics : this->columnStatistics)
+        histograms.push_back(statistics.histogram);
+    movePages(resultTables, target);
+    for (uint columnCounter = 0; !combiner && columnCounter < histograms.size() && columnCounter < target->columnStatistics.size(); columnCounter++)
+        target->columnStatistics[columnCounter].histogram = histograms[columnCounter];
+    for (Table *part : resultTables)
+        tableCatalogue.deleteTable(part->tableName);
 }
 
 void Matrix::updateStatistics(vector<int> row)
@@ -1306,12 +2156,16 @@ void Table::makePermanent()
     // print headings
     this->writeRow(this->columns, fout);
 
-    Cursor cursor(this->tableName, 0);
-    vector<int> row;
-    for (int rowCounter = 0; rowCounter < this->rowCount; rowCounter++)
+    // A table emptied by a LIMIT 0 has no page to open a cursor on
+    if (this->blockCount)
     {
-        row = cursor.getNext();
-        this->writeRow(row, fout);
+        Cursor cursor(this->tableName, 0);
+        vector<int> row;
+        for (int rowCounter = 0; rowCounter < this->rowCount; rowCounter++)
+        {
+            row = cursor.getNext();
+            this->writeRow(row, fout);
+        }
     }
     fout.close();
 }
@@ -1409,6 +2263,20 @@ Cursor Table::getCursor()
     Cursor cursor(this->tableName, 0);
     return cursor;
 }
+
+/**
+ * @brief Function that returns a cursor that only reads the given columns of
+ * the rows of this table; the other values of the rows it returns are 0.
+ *
+ * @param columnIndexes
+ * @return Cursor
+ */
+Cursor Table::getCursor(const vector<int> &columnIndexes)
+{
+    logger.log("Table::getCursor");
+    Cursor cursor(this->tableName, 0, columnIndexes);
+    return cursor;
+}
 /**
  * @brief Function that returns the index of column indicated by columnName
  *
@@ -1438,313 +2306,6 @@ int Table::getColumnIndex(string columnName)
     return -1; // Return -1 if column not found
 }
 
-void Table::groupBy()
-{
-    logger.log("Table::groupBy");
-    string newTableName = parsedQuery.groupByResultRelationName;
-    string groupingAttribute = parsedQuery.groupAttribute;
-    string havingaggregateAttribute = parsedQuery.havingAttribute;
-    Aggregate havingaggregateFunction = parsedQuery.havingAgg;
-    BinaryOperator binOp = parsedQuery.groupBinaryOperator;
-    int attributeValue = parsedQuery.havingValue;
-    string aggregateAttribute = parsedQuery.returnAttribute;
-    Aggregate aggregateFunction = parsedQuery.returnAgg;
-    string stringaggregateFunction = parsedQuery.returnAggregate;
-
-    cout << "\n=== Starting GROUP BY Operation ===" << endl;
-    cout << "Grouping by: " << groupingAttribute << endl;
-    cout << "Aggregating: " << aggregateAttribute << " with function: " << stringaggregateFunction << endl;
-    cout << "Having clause: " << havingaggregateAttribute << " " << (binOp == EQUAL ? "=" : (binOp == GREATER_THAN ? ">" : ">=")) << " " << attributeValue << endl;
-
-    // First sort the table by the grouping attribute
-    logger.log("External sorting for GROUP BY");
-    parsedQuery.sortStrategy.clear();
-    parsedQuery.sortStrategy.push_back(ASC);
-    parsedQuery.sortColumns.clear();
-    parsedQuery.sortColumns.push_back(groupingAttribute);
-
-    cout << "\nSorting table by " << groupingAttribute << "..." << endl;
-    this->sortTable(false); // Don't make sorting permanent
-    this->unload();
-
-    // print the table
-    this->print();
-
-    // Create the result table with appropriate columns
-    vector<string> header = {groupingAttribute, stringaggregateFunction + "(" + aggregateAttribute + ")"};
-    Table *groupedTable = new Table(newTableName, header);
-    logger.log("Created new table for result");
-
-    // Initialize variables for grouping
-    int currentGroupValue = -1;
-    int havingaggregateResult = 0;
-    int havingaggregateCount = 0;
-    int aggregationResult = 0;
-    int aggregateCount = 0;
-    bool isFirstGroup = true;
-
-    // Get column indices for grouping and aggregate attributes
-    int groupIndex = this->getColumnIndex(groupingAttribute);
-    int havingaggregateIndex = this->getColumnIndex(havingaggregateAttribute);
-    int aggregateIndex = this->getColumnIndex(aggregateAttribute);
-
-    cout << "\nColumn indices:" << endl;
-    cout << "Group index: " << groupIndex << endl;
-    cout << "Aggregate index: " << aggregateIndex << endl;
-    cout << "Having aggregate index: " << havingaggregateIndex << endl;
-
-    // Process the sorted data
-    Cursor cursor = this->getCursor();
-    vector<int> row = cursor.getNext();
-    logger.log("Starting GROUP BY processing");
-
-    int currRow = 0;
-    long long totalRow = 0;
-    int pageCounter = 0;
-    vector<vector<int>> pageData;
-
-    cout << "\nProcessing rows..." << endl;
-    while (!row.empty())
-    {
-        int groupValue = row[groupIndex];
-        int aggregateValue = row[aggregateIndex];
-        int havingaggregateValue = row[havingaggregateIndex];
-
-        if (groupValue != currentGroupValue)
-        {
-            // Process the previous group
-            if (!isFirstGroup)
-            {
-                if (havingaggregateFunction == AVG && havingaggregateCount > 0)
-                {
-                    havingaggregateResult = havingaggregateResult / havingaggregateCount;
-                }
-
-                cout << "\nProcessing group with value: " << currentGroupValue << endl;
-                cout << "Having aggregate result: " << havingaggregateResult << endl;
-                cout << "Having aggregate count: " << havingaggregateCount << endl;
-
-                bool havingConditionMet = false;
-                if (havingaggregateCount > 0)
-                {
-                    if (binOp == EQUAL)
-                    {
-                        havingConditionMet = (havingaggregateResult == attributeValue);
-                    }
-                    else if (binOp == GREATER_THAN)
-                    {
-                        havingConditionMet = (havingaggregateResult > attributeValue);
-                    }
-                    else if (binOp == GEQ)
-                    {
-                        havingConditionMet = (havingaggregateResult >= attributeValue);
-                    }
-                }
-
-                if (havingConditionMet)
-                {
-                    cout << "Having condition met for group " << currentGroupValue << endl;
-                    vector<int> resultRow;
-
-                    if (aggregateFunction == MIN || aggregateFunction == MAX || aggregateFunction == SUM)
-                    {
-                        resultRow = {currentGroupValue, aggregationResult};
-                    }
-                    else if (aggregateFunction == COUNT)
-                    {
-                        resultRow = {currentGroupValue, aggregateCount};
-                    }
-                    else if (aggregateFunction == AVG && aggregateCount > 0)
-                    {
-                        resultRow = {currentGroupValue, aggregationResult / aggregateCount};
-                    }
-
-                    cout << "Adding result row: [" << resultRow[0] << ", " << resultRow[1] << "]" << endl;
-                    pageData.push_back(resultRow);
-                    currRow++;
-                    totalRow++;
-                }
-            }
-
-            // Start new group
-            currentGroupValue = groupValue;
-            aggregationResult = aggregateValue; // Initialize with first value
-            aggregateCount = 1;
-            havingaggregateCount = 1;
-            havingaggregateResult = havingaggregateValue;
-            isFirstGroup = false;
-        }
-        else
-        {
-            // Update aggregation results for current group
-            if (aggregateFunction == MIN)
-            {
-                aggregationResult = min(aggregationResult, aggregateValue);
-            }
-            else if (aggregateFunction == MAX)
-            {
-                aggregationResult = max(aggregationResult, aggregateValue);
-            }
-            else if (aggregateFunction == SUM)
-            {
-                aggregationResult += aggregateValue;
-            }
-            else if (aggregateFunction == COUNT)
-            {
-                aggregateCount++;
-            }
-            else if (aggregateFunction == AVG)
-            {
-                aggregationResult += aggregateValue;
-                aggregateCount++;
-            }
-
-            // Update having clause results
-            if (havingaggregateFunction == MIN)
-            {
-                havingaggregateResult = min(havingaggregateResult, havingaggregateValue);
-            }
-            else if (havingaggregateFunction == MAX)
-            {
-                havingaggregateResult = max(havingaggregateResult, havingaggregateValue);
-            }
-            else if (havingaggregateFunction == SUM)
-            {
-                havingaggregateResult += havingaggregateValue;
-            }
-            else if (havingaggregateFunction == COUNT)
-            {
-                havingaggregateCount++;
-            }
-            else if (havingaggregateFunction == AVG)
-            {
-                havingaggregateResult += havingaggregateValue;
-                havingaggregateCount++;
-            }
-        }
-
-        // Write page if full
-        if (currRow == groupedTable->maxRowsPerBlock)
-        {
-            cout << "Writing page " << pageCounter << " with " << currRow << " rows" << endl;
-            bufferManager.writePage(groupedTable->tableName, pageCounter, pageData, currRow);
-            pageCounter++;
-            currRow = 0;
-            pageData.clear();
-        }
-
-        row = cursor.getNext();
-    }
-
-    // Process the last group
-    if (!isFirstGroup)
-    {
-        if (havingaggregateFunction == AVG && havingaggregateCount > 0)
-        {
-            havingaggregateResult = havingaggregateResult / havingaggregateCount;
-        }
-
-        cout << "\nProcessing final group with value: " << currentGroupValue << endl;
-        cout << "Having aggregate result: " << havingaggregateResult << endl;
-        cout << "Having aggregate count: " << havingaggregateCount << endl;
-
-        bool havingConditionMet = false;
-        if (havingaggregateCount > 0)
-        {
-            if (binOp == EQUAL)
-            {
-                havingConditionMet = (havingaggregateResult == attributeValue);
-            }
-            else if (binOp == GREATER_THAN)
-            {
-                havingConditionMet = (havingaggregateResult > attributeValue);
-            }
-            else if (binOp == GEQ)
-            {
-                havingConditionMet = (havingaggregateResult >= attributeValue);
-            }
-        }
-
-        if (havingConditionMet)
-        {
-            cout << "Having condition met for final group " << currentGroupValue << endl;
-            vector<int> resultRow;
-
-            if (aggregateFunction == MIN || aggregateFunction == MAX || aggregateFunction == SUM)
-            {
-                resultRow = {currentGroupValue, aggregationResult};
-            }
-            else if (aggregateFunction == COUNT)
-            {
-                resultRow = {currentGroupValue, aggregateCount};
-            }
-            else if (aggregateFunction == AVG && aggregateCount > 0)
-            {
-                resultRow = {currentGroupValue, aggregationResult / aggregateCount};
-            }
-
-            cout << "Adding final result row: [" << resultRow[0] << ", " << resultRow[1] << "]" << endl;
-            pageData.push_back(resultRow);
-            currRow++;
-            totalRow++;
-        }
-    }
-
-    // Write remaining data
-    if (!pageData.empty())
-    {
-        cout << "Writing final page " << pageCounter << " with " << currRow << " rows" << endl;
-        bufferManager.writePage(groupedTable->tableName, pageCounter, pageData, currRow);
-        pageCounter++;
-    }
-
-    cout << "\nTotal rows in result: " << totalRow << endl;
-    cout << "Total pages: " << pageCounter << endl;
-
-    // Initialize the result table properly
-    groupedTable->rowCount = totalRow;
-    groupedTable->columnCount = 2;
-    groupedTable->blockCount = pageCounter;
-    groupedTable->sourceFileName = "../data/" + groupedTable->tableName + ".csv";
-
-    // Insert the table into the catalog
-    tableCatalogue.insertTable(groupedTable);
-
-    // Write the header to the CSV file
-    ofstream outputFile(groupedTable->sourceFileName, ios::out);
-    outputFile << header[0] << "," << header[1] << endl;
-    outputFile.close();
-
-    // Append the data to the CSV file
-    outputFile.open(groupedTable->sourceFileName, ios::app);
-    for (int i = 0; i < pageCounter; i++)
-    {
-        ifstream inputFile("../data/temp/" + groupedTable->tableName + "_Page" + to_string(i));
-        string line;
-        while (getline(inputFile, line))
-        {
-            istringstream iss(line);
-            string word;
-            bool firstWord = true;
-            while (iss >> word)
-            {
-                if (!firstWord)
-                {
-                    outputFile << ",";
-                }
-                outputFile << word;
-                firstWord = false;
-            }
-            outputFile << endl;
-        }
-        inputFile.close();
-    }
-    outputFile.close();
-
-    cout << "\n=== GROUP BY Operation Completed ===" << endl;
-    logger.log("Table::GroupBy - End");
-}
-
 // join
 
 void Table::joinTables()
@@ -1790,18 +2351,22 @@ void Table::joinTables()
 
     // Step 1: Build hash table on Table 1
     unordered_map<int, vector<vector<int>>> hashTable;
-
-    Cursor cursor1 = table1->getCursor();
-    vector<int> row1 = cursor1.getNext();
-    while (!row1.empty())
     {
-        int key = row1[colIndex1];
-        hashTable[key].push_back(row1);
-        row1 = cursor1.getNext();
+        OperatorScope buildScope("hash join: build on " + tableName1);
+        Cursor cursor1 = table1->getCursor();
+        vector<int> row1 = cursor1.getNext();
+        while (!row1.empty())
+        {
+            int key = row1[colIndex1];
+            hashTable[key].push_back(row1);
+            row1 = cursor1.getNext();
+        }
+        buildScope.setRows(table1->rowCount);
     }
     // cout << "Hash table built on Table 1 with " << hashTable.size() << " unique keys." << endl;
 
     // Step 2: Probe hash table using Table 2
+    OperatorScope probeScope("hash join: probe with " + tableName2);
     Cursor cursor2 = table2->getCursor();
     vector<int> row2 = cursor2.getNext();
 
@@ -1825,7 +2390,7 @@ void Table::joinTables()
 
                 if (currRow == resultTable->maxRowsPerBlock)
                 {
-                    bufferManager.writePage(resultTable->tableName, pageCounter, pageBuffer, currRow);
+                    resultTable->writePage(pageCounter, pageBuffer, currRow);
                     pageCounter++;
                     currRow = 0;
                     pageBuffer.clear();
@@ -1839,21 +2404,35 @@ void Table::joinTables()
     // Flush remaining rows
     if (!pageBuffer.empty())
     {
-        bufferManager.writePage(resultTable->tableName, pageCounter, pageBuffer, currRow);
+        resultTable->writePage(pageCounter, pageBuffer, currRow);
         pageCounter++;
     }
 
     resultTable->rowCount = joinedRows;
     resultTable->columnCount = resultColumns.size();
+    probeScope.setRows(joinedRows);
     tableCatalogue.insertTable(resultTable);
 
     cout << "Hash join complete. Rows joined: " << joinedRows << endl;
     logger.log("Table::joinTables - End");
 }
 
-Table::Table(string tableName, vector<string> columns, bool ORDER_BY_OPERATION, int block_count)
+/**
+ * @brief Construct a new Table:: Table object that only lives in the temp
+ * directory as pages, without a backing csv file. Used for ORDER BY results and
+ * for scratch tables (spill partitions, sort runs) that operators fill with
+ * appendPage and drop from the catalogue once they are done.
+ *
+ * @param tableName
+ * @param columns
+ * @param isScratch true if no page of the table ends up in a result, so its
+ * pages need no zone maps, Bloom filters or statistics
+ * @param block_count
+ */
+Table::Table(string tableName, vector<string> columns, bool isScratch, int block_count)
 {
     logger.log("Table::Table");
+    this->isScratch = isScratch;
     this->indexed = false;
     this->indexedColumn = "";
     this->indexingStrategy = NOTHING;
@@ -1863,90 +2442,194 @@ Table::Table(string tableName, vector<string> columns, bool ORDER_BY_OPERATION,
     this->columnCount = columns.size();
     this->blockCount = block_count;
     this->maxRowsPerBlock = (uint)((BLOCK_SIZE * 1000) / (sizeof(int) * columnCount));
-    this->writeRow<string>(columns);
 }
 
-void Table::orderBy()
+/**
+ * @brief Writes the given rows as a new block at the end of the table and
+ * updates the block bookkeeping. The rows are cleared so the caller can reuse
+ * the vector as its page buffer.
+ *
+ * @param rows
+ */
+void Table::appendPage(vector<vector<int>> &rows)
 {
-    logger.log("Table::orderBy - Start");
-    cout << "ORDER BY STARTED..." << endl;
+    logger.log("Table::appendPage");
+    if (rows.empty())
+        return;
+    this->writePage(this->blockCount, rows, rows.size());
+    this->rowsPerBlockCount.emplace_back(rows.size());
+    this->blockCount++;
+    this->rowCount += rows.size();
+    rows.clear();
+}
 
-    string newTableName = parsedQuery.orderResultRelation;
-    string oldTableName = parsedQuery.orderRelationName;
-    string orderColumn = parsedQuery.orderAttribute;
-    bool isDescending = (parsedQuery.sortingStrategy == SortingStrategy::DESC);
+/**
+ * @brief Writes a page of the table through the buffer manager and, unless the
+ * table is a scratch table, updates its sketches. Every writer of table pages
+ * goes through here so that the zone maps scans rely on are never out of date.
+ *
+ * @param pageIndex
+ * @param rows
+ * @param rowCount number of rows of the page, the first rowCount of rows
+ */
+void Table::writePage(uint pageIndex, const vector<vector<int>> &rows, int rowCount)
+{
+    logger.log("Table::writePage");
+    bufferManager.writePage(this->tableName, pageIndex, rows, rowCount, this->pageLayout);
+    if (!this->isScratch)
+        this->updatePageSketches(pageIndex, rows, rowCount);
+}
 
-    // Retrieve the Table object using oldTableName
-    Table *oldTable = tableCatalogue.getTable(oldTableName);
-    if (!oldTable)
+/**
+ * @brief Records the zone map entry and Bloom filters of a page and adds its
+ * values to the column statistics; adding a value again changes neither the
+ * sketches nor the ranges, so rewriting a page is harmless.
+ *
+ * @param pageIndex
+ * @param rows
+ * @param rowCount number of rows of the page, the first rowCount of rows
+ */
+void Table::updatePageSketches(uint pageIndex, const vector<vector<int>> &rows, int rowCount)
+{
+    logger.log("Table::updatePageSketches");
+    if (this->pageZones.size() <= pageIndex)
+        this->pageZones.resize(pageIndex + 1);
+    PageZone &zone = this->pageZones[pageIndex];
+    zone.rowCount = rowCount;
+    zone.minValues.assign(this->columnCount, INT_MAX);
+    zone.maxValues.assign(this->columnCount, INT_MIN);
+    if (this->columnStatistics.size() != this->columnCount)
+        this->columnStatistics.assign(this->columnCount, ColumnStatistics());
+    for (int rowCounter = 0; rowCounter < rowCount && rowCounter < (int)rows.size(); rowCounter++)
+        for (uint columnCounter = 0; columnCounter < this->columnCount && columnCounter < rows[rowCounter].size(); columnCounter++)
+        {
+            zone.minValues[columnCounter] = min(zone.minValues[columnCounter], rows[rowCounter][columnCounter]);
+            zone.maxValues[columnCounter] = max(zone.maxValues[columnCounter], rows[rowCounter][columnCounter]);
+            this->columnStatistics[columnCounter].distinctValues.add(rows[rowCounter][columnCounter]);
+        }
+    for (uint columnCounter = 0; columnCounter < this->columnCount && rowCount > 0; columnCounter++)
     {
-        cout << "Error: Table not found - " << oldTableName << endl;
-        return;
+        ColumnStatistics &statistics = this->columnStatistics[columnCounter];
+        statistics.minValue = min(statistics.minValue, zone.minValues[columnCounter]);
+        statistics.maxValue = max(statistics.maxValue, zone.maxValues[columnCounter]);
     }
+    zone.bloomFilter.build(rows, rowCount, this->columnCount);
+}
 
-    Table *sortedTable = nullptr;
-    try
-    {
-        sortedTable = new Table(newTableName, oldTable->columns, true, oldTable->columnCount);
-        sortedTable->blockCount = oldTable->blockCount;
-    }
-    catch (exception &e)
-    {
-        cout << "Exception: " << e.what() << endl;
-        return;
-    }
-    catch (...)
-    {
-        cout << "Unknown exception occurred" << endl;
-        return;
-    }
+/**
+ * @brief Returns the zone map entry of a page, or nullptr if the page wasn't
+ * written through writePage or has changed size since.
+ *
+ * @param pageIndex
+ * @return const PageZone*
+ */
+const PageZone *Table::getPageZone(uint pageIndex)
+{
+    if (pageIndex >= this->pageZones.size() || pageIndex >= this->rowsPerBlockCount.size())
+        return nullptr;
+    const PageZone &zone = this->pageZones[pageIndex];
+    if (zone.rowCount != this->rowsPerBlockCount[pageIndex] || zone.minValues.size() != this->columnCount)
+        return nullptr;
+    return &zone;
+}
 
-    vector<vector<int>> allRows;
-    Cursor cursor = oldTable->getCursor();
-    vector<int> row = cursor.getNext();
-    while (!row.empty())
+string getOrderByStrategyName(OrderByStrategy strategy)
+{
+    static const string strategyNames[] = {"index scan", "top-k", "external sort"};
+    return strategyNames[strategy];
+}
+
+/**
+ * @brief Chooses how ORDER BY produces the rows of this table in the order of
+ * encoder. With a LIMIT that fits in the sort buffer topK reads the table once,
+ * or only the first rows if the table is already in order; otherwise the
+ * table is sorted. Reading the rows in key order off a B+ tree index is
+ * chosen instead when that is cheaper, which is always the case for a
+ * clustered index.
+ *
+ * @param index B+ tree index on the ORDER BY column, nullptr if there is none
+ * @param encoder
+ * @param limit -1 if there is no LIMIT
+ * @param estimatedCost set to the estimated block accesses of the strategy
+ * @return OrderByStrategy
+ */
+OrderByStrategy Table::chooseOrderByStrategy(BPlusTree *index, const SortKeyEncoder &encoder, long long limit, double &estimatedCost)
+{
+    logger.log("Table::chooseOrderByStrategy");
+    long long outputRows = limit >= 0 ? min(limit, this->rowCount) : this->rowCount;
+    double outputBlocks = ceil((double)outputRows / this->maxRowsPerBlock);
+    bool sorted = encoder.isPrefixOf(this->sortedColumnIndexes, this->sortedDescending);
+    estimatedCost = estimateSortCost(this->blockCount);
+    if (limit >= 0 && sorted)
+        estimatedCost = 2 * outputBlocks;
+    else if (limit >= 0 && limit <= (long long)SORT_BUFFER_BLOCKS * this->maxRowsPerBlock)
+        estimatedCost = this->blockCount + outputBlocks;
+    if (index && !sorted)
     {
-        allRows.push_back(row);
-        row = cursor.getNext();
+        double indexCost = this->estimateIndexScanCost(index, limit);
+        logger.log("Table::chooseOrderByStrategy: index scan cost " + to_string(indexCost) + ", sort cost " + to_string(estimatedCost));
+        if (indexCost >= 0 && indexCost + outputBlocks <= estimatedCost)
+        {
+            estimatedCost = indexCost + outputBlocks;
+            return INDEX_ORDER_BY;
+        }
     }
+    return limit >= 0 ? TOP_K_ORDER_BY : SORT_ORDER_BY;
+}
+
+/**
+ * @brief Executes ORDER BY: the table is sorted by the external sort straight
+ * into the pages of the result table, so memory use is bounded by the sort
+ * buffer and every result page is written once. With a LIMIT only the first
+ * rows are wanted, which topK finds in a single scan. If the column has a B+
+ * tree index whose ordered scan is estimated to be cheaper, the rows are
+ * instead read in key order off the index. Like other assignment
+ * statements the result lives in temp pages until it is EXPORTed.
+ *
+ */
+void Table::orderBy()
+{
+    logger.log("Table::orderBy - Start");
+    cout << "ORDER BY STARTED..." << endl;
 
-    // Get column index to sort by
-    int columnIndex = oldTable->getColumnIndex(orderColumn);
+    string newTableName = parsedQuery.orderResultRelation;
+    bool isDescending = (parsedQuery.sortingStrategy == SortingStrategy::DESC);
 
-    // Sort rows using the specified column and order
-    sort(allRows.begin(), allRows.end(), [&](const vector<int> &a, const vector<int> &b)
-         { return isDescending ? a[columnIndex] > b[columnIndex] : a[columnIndex] < b[columnIndex]; });
+    Table *sortedTable = new Table(newTableName, this->columns, false, 0);
+    int columnIndex = this->getColumnIndex(parsedQuery.orderAttribute);
+    SortKeyEncoder encoder({columnIndex}, {isDescending});
+    long long limit = parsedQuery.orderLimit;
 
-    // Write sorted data into the new table
-    for (const auto &sortedRow : allRows)
+    BPlusTree *index = this->getBPlusTree(parsedQuery.orderAttribute);
+    double estimatedCost;
+    bool useIndex = this->chooseOrderByStrategy(index, encoder, limit, estimatedCost) == INDEX_ORDER_BY;
+    if (useIndex)
     {
-        sortedTable->writeRow(sortedRow);
-    }
-
-    parsedQuery.loadRelationName = newTableName;
+        OperatorScope scope("index scan " + this->tableName + "." + parsedQuery.orderAttribute);
+        Table *scanTable = new Table(this->tableName + "_IndexScan", this->columns, false, 0);
+        tableCatalogue.insertTable(scanTable);
+        vector<vector<int>> rows;
+        useIndex = this->indexScan(index, columnIndex, isDescending, [&](const vector<int> &row)
+                                   {
+            rows.push_back(row);
+            if (rows.size() == scanTable->maxRowsPerBlock)
+                scanTable->appendPage(rows); }, limit);
+        scanTable->appendPage(rows);
+        if (useIndex)
+            movePages({scanTable}, sortedTable);
+        tableCatalogue.deleteTable(scanTable->tableName);
+    }
+
+    if (useIndex)
+        cout << "Rows read in order from the index on " << parsedQuery.orderAttribute << endl;
+    else if (limit >= 0)
+        this->topK(encoder, limit, sortedTable);
+    else
+        this->externalSort(encoder, nullptr, sortedTable);
+    sortedTable->sortedColumnIndexes = encoder.getColumnIndexes();
+    sortedTable->sortedDescending = encoder.getDescending();
     tableCatalogue.insertTable(sortedTable);
 
-    ofstream csvFile("../data/" + newTableName + ".csv");
-    for (size_t i = 0; i < oldTable->columns.size(); i++)
-    {
-        csvFile << oldTable->columns[i];
-        if (i < oldTable->columns.size() - 1)
-            csvFile << ",";
-    }
-    csvFile << "\n";
-    for (const auto &sortedRow : allRows)
-    {
-        sortedTable->writeRow(sortedRow);
-        for (size_t i = 0; i < sortedRow.size(); i++)
-        {
-            csvFile << sortedRow[i];
-            if (i < sortedRow.size() - 1)
-                csvFile << ",";
-        }
-        csvFile << "\n";
-    }
-    csvFile.close();
-    // sortedTable->makePermanent();
     cout << "ORDER BY COMPLETED" << endl;
     logger.log("Table::orderBy - End");
 }
@@ -1977,6 +2660,9 @@ bool isInteger(const std::string& str) {
 
 void Table::insertRow(const vector<string>& rowStrVec) {
     logger.log("Table::insertRow");
+    // The new row may be out of order
+    this->sortedColumnIndexes.clear();
+    this->sortedDescending.clear();
 
     // Step 1: Parse strings to integers and handle invalid/missing values
     vector<int> row;
@@ -2048,7 +2734,7 @@ void Table::insertRow(const vector<string>& rowStrVec) {
         this->rowsPerBlockCount.push_back(1);
         this->blockCount++;
         vector<vector<int>> newPageData = {row};
-        bufferManager.writePage(this->tableName, lastBlockIndex + 1, newPageData, 1);
+        this->writePage(lastBlockIndex + 1, newPageData, 1);
         // cout << "New page written to block index: " << (lastBlockIndex + 1) << "\n";
     } else {
         // Step 7B: Insert into current block
@@ -2076,7 +2762,7 @@ void Table::insertRow(const vector<string>& rowStrVec) {
         this->rowsPerBlockCount[lastBlockIndex]++;
 
         // Write back to buffer
-        bufferManager.writePage(this->tableName, lastBlockIndex, pageData, validRows + 1);
+        this->writePage(lastBlockIndex, pageData, validRows + 1);
         // cout << "Page written back to buffer manager.\n";
     }
 
@@ -2098,20 +2784,34 @@ void Table::insertRow(const vector<string>& rowStrVec) {
                 cout << "Inserted into B+ Tree Index for " << colName << ": key=" << key << ", row=" << this->rowCount - 1 << "\n";
             }
         }
+        if (indexInfo->strategy == BITMAP && indexInfo->bitmapIndex != nullptr) {
+            int colIdx = this->getColumnIndex(colName);
+            if (colIdx >= 0 && colIdx < (int)row.size() && indexInfo->bitmapIndex->rowCount == this->rowCount - 1) {
+                indexInfo->bitmapIndex->add(row[colIdx], this->rowCount - 1);
+                indexInfo->bitmapIndex->rowCount = this->rowCount;
+            }
+        }
     }
 
     // Step 10: Final operations
     cout << "Calling makePermanent...\n";
     // this->makePermanent();
 
+    // The row was counted in step 2 and its values went into the column
+    // statistics with its page; only the values that weren't given are left
     cout << "Updating statistics...\n";
-    this->updateStatistics(row);
+    for (int columnCounter = 0; columnCounter < (int)rowStrVec.size() && columnCounter < (int)this->columnStatistics.size(); columnCounter++)
+        if (!isInteger(rowStrVec[columnCounter]))
+            this->columnStatistics[columnCounter].nullCount++;
 
     cout << "INSERTION SUCCESS ✅\n";
 }
 
 void Table::updateRow(const vector<string>& rowStrVec) {
     logger.log("Table::insertRow");
+    // The new row may be out of order
+    this->sortedColumnIndexes.clear();
+    this->sortedDescending.clear();
 
     // Step 1: Parse strings to integers and handle invalid/missing values
     vector<int> row;
@@ -2171,7 +2871,7 @@ void Table::updateRow(const vector<string>& rowStrVec) {
                     pageData[offsetInBlock] = row;
     
                     // Step 4: Write updated page back
-                    bufferManager.writePage(this->tableName, blockIndex, pageData, pageData.size());
+                    this->writePage(blockIndex, pageData, pageData.size());
     
                     cout << "Updated rowId " << rowId << " with new values.\n";
                 }
@@ -2180,14 +2880,21 @@ void Table::updateRow(const vector<string>& rowStrVec) {
         }
     }
     
+    // Bitmap indexes are rebuilt from the updated rows when next used
+    for (auto& [colName, indexInfo] : this->indices) {
+        if (indexInfo->strategy == BITMAP) {
+            delete indexInfo->bitmapIndex;
+            indexInfo->bitmapIndex = nullptr;
+        }
+    }
+    
 
     // Step 10: Final operations
     // cout << "Calling makePermanent...\n";
     // this->makePermanent();
 
-    cout << "Updating statistics...\n";
-    this->updateStatistics(row);
-
+    // The column statistics took in the new values with the pages, and an
+    // update doesn't change the number of rows
     cout << "UPDATE OPERATION done.";
 }
 
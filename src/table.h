@@ -1,11 +1,18 @@
 #include "cursor.h"
 #include "enums.h"
 #include "bplustree.h"
+#include "sortKey.h"
+#include "condition.h"
+#include "bloomFilter.h"
+#include "bitmapIndex.h"
+#include "catalogFile.h"
+#include "hyperLogLog.h"
 
 enum IndexingStrategy
 {
     BTREE,
     HASH,
+    BITMAP,
     NOTHING
 };
 
@@ -23,15 +30,111 @@ struct IndexInfo {
     string columnName;
     IndexingStrategy strategy;
     BPlusTree* bPlusTreeIndex;
+    BitmapIndex* bitmapIndex = nullptr;
     
     IndexInfo(string colName, IndexingStrategy strat, BPlusTree* index = nullptr) 
         : columnName(colName), strategy(strat), bPlusTreeIndex(index) {}
 };
 
+/**
+ * @brief Folds row into into, where both rows have equal sort keys. Passed to
+ * Table::sortTable to collapse such rows while sorting.
+ *
+ */
+typedef function<void(vector<int> &into, const vector<int> &row)> RowCombiner;
+
+/**
+ * @brief Receives the rows of a scan one at a time, e.g. Table::indexScan.
+ *
+ */
+typedef function<void(const vector<int> &row)> RowConsumer;
+
+/**
+ * @brief Zone map entry of a page: the smallest and largest value of every
+ * column among its rows, and a Bloom filter of every column's values. Scans
+ * skip pages whose ranges can't satisfy their condition, or whose filters
+ * rule out the value of an equality.
+ *
+ */
+struct PageZone
+{
+    uint rowCount = 0;
+    vector<int> minValues;
+    vector<int> maxValues;
+    PageBloomFilter bloomFilter;
+};
+
+/**
+ * @brief How the rows satisfying a condition are found (see
+ * Table::chooseAccessPath): reading every page, reading the pages whose zone
+ * maps don't rule them out, or looking the rows up in B+ tree or bitmap
+ * indexes and reading only the pages that hold them.
+ *
+ */
+enum AccessMethod
+{
+    FULL_SCAN,
+    ZONE_MAP_SCAN,
+    INDEX_SCAN,
+    BITMAP_SCAN
+};
+
+/**
+ * @brief The access method chosen for a condition, with the estimated number
+ * of qualifying rows and the estimated cost, in blocks read, of every method
+ * (-1 for index lookups if no index applies).
+ *
+ */
+struct AccessPath
+{
+    AccessMethod method = FULL_SCAN;
+    double estimatedRows = 0;
+    double fullScanCost = 0;
+    double zoneMapScanCost = 0;
+    double indexScanCost = -1;
+
+    double getCost() const;
+    string toString() const;
+};
+
+/**
+ * @brief Physical GROUP BY operators (see table_groupby.cpp).
+ *
+ */
+enum GroupByStrategy
+{
+    BITMAP_GROUP_BY,
+    INDEX_GROUP_BY,
+    HASH_GROUP_BY,
+    SORT_GROUP_BY
+};
+
+/**
+ * @brief Ways ORDER BY produces its rows: off a B+ tree index in key order,
+ * through the bounded heap of topK when there is a LIMIT, or by the external
+ * sort.
+ *
+ */
+enum OrderByStrategy
+{
+    INDEX_ORDER_BY,
+    TOP_K_ORDER_BY,
+    SORT_ORDER_BY
+};
+
+string getAccessMethodName(AccessMethod method);
+string getGroupByStrategyName(GroupByStrategy strategy);
+string getOrderByStrategyName(OrderByStrategy strategy);
+uint getSortWorkerCount(uint blockCount);
+uint getSortMergeWays(uint workerCount);
+double estimateSortMergePasses(double blockCount, uint workerCount);
+double estimateSortCost(uint blockCount);
+
+class Table;
+void movePages(const vector<Table *> &parts, Table *target);
+
 class Table
 {
-    vector<unordered_set<int>> distinctValuesInColumns;
-    
     // Map to store multiple indices (column name -> index info)
     unordered_map<string, IndexInfo*> indices;
     
@@ -42,13 +145,26 @@ public:
     string sourceFileName = "";
     string tableName = "";
     vector<string> columns;
-    vector<uint> distinctValuesPerColumnCount;
+    // One per column, filled in as pages are written (see writePage)
+    vector<ColumnStatistics> columnStatistics;
     uint columnCount = 0;
     long long int rowCount = 0;
     uint blockCount = 0;
     uint maxRowsPerBlock = 0;
     vector<uint> rowsPerBlockCount;
+    vector<PageZone> pageZones;
+    // Set by LOAD ... USING COLUMNAR | COMPRESSED; pages of derived tables
+    // are row layout
+    PageLayout pageLayout = ROW_LAYOUT;
+    // Pages of scratch tables are only read back by the operator that wrote
+    // them, so no zone maps, Bloom filters or statistics are kept for them
+    bool isScratch = false;
     
+    // Key the rows are known to be ordered on (set by SORT, ORDER BY and
+    // Top-K, cleared when rows are inserted or updated); empty if unknown
+    vector<int> sortedColumnIndexes;
+    vector<bool> sortedDescending;
+
     // Keep these for backward compatibility
     bool indexed = false;
     string indexedColumn = "";
@@ -56,11 +172,12 @@ public:
 
     bool extractColumnNames(string firstLine);
     bool blockify();
+    uint getCompressedRowsPerBlock();
     void updateStatistics(vector<int> row);
     Table();
     Table(string tableName);
     Table(string tableName, vector<string> columns);
-    Table(string tableName, vector<string> columns, bool ORDER_BY_OPERATION, int block_count);
+    Table(string tableName, vector<string> columns, bool isScratch, int block_count);
     ~Table();
     bool load();
     bool isColumn(string columnName);
@@ -70,23 +187,60 @@ public:
     bool isPermanent();
     void getNextPage(Cursor *cursor);
     Cursor getCursor();
-    void sortTable(bool makePermanent = true);
-    void externalSort();
+    Cursor getCursor(const vector<int> &columnIndexes);
+    void sortTable(bool makePermanent = true, RowCombiner combiner = nullptr, long long limit = -1);
+    void externalSort(const SortKeyEncoder &encoder, RowCombiner combiner = nullptr, Table *resultTable = nullptr);
+    void topK(const SortKeyEncoder &encoder, long long limit, Table *resultTable = nullptr);
     int getColumnIndex(string columnName);
     void unload();
     void groupBy();
+    GroupByStrategy chooseGroupByStrategy(double &estimatedGroups, double &estimatedCost, bool useIndexes = true);
+    bool hashGroupBy(Table *resultTable);
+    void sortGroupBy(Table *resultTable);
+    bool indexGroupBy(Table *resultTable, BPlusTree *index);
+    bool bitmapGroupBy(Table *resultTable, BitmapIndex *index);
     void deleteTable();
     void joinTables();
     void orderBy();
+    OrderByStrategy chooseOrderByStrategy(BPlusTree *index, const SortKeyEncoder &encoder, long long limit, double &estimatedCost);
     void insertRow(const vector<string>& row);
     void updateRow(const vector<string>& row);
     void deleteRows(const vector<int>& rowIndices);
     void rebalanceBlocks();
+    void appendPage(vector<vector<int>> &rows);
+    void writePage(uint pageIndex, const vector<vector<int>> &rows, int rowCount);
+    void updatePageSketches(uint pageIndex, const vector<vector<int>> &rows, int rowCount);
+    const PageZone *getPageZone(uint pageIndex);
+    uint getDistinctValueCount(int columnIndex);
+    void analyze();
     
     // Index related functions
     bool buildIndex(string columnName);
+    bool rebuildIndex(string columnName);
     vector<int> searchIndexed(string columnName, int value, BinaryOperator op);
     bool isIndexed(string columnName);
+    IndexingStrategy getIndexingStrategy(string columnName);
+    BPlusTree *getBPlusTree(string columnName);
+    bool buildBitmapIndex(string columnName);
+    BitmapIndex *getBitmapIndex(string columnName);
+    void updateIndexScanStatistics(BPlusTree *index);
+    double estimateIndexScanCost(BPlusTree *index, long long limit = -1);
+    bool indexScan(BPlusTree *index, int columnIndex, bool descending, const RowConsumer &consumer, long long limit = -1);
+    vector<long long> getPageStarts();
+
+    // Warm restart (see TableCatalogue::checkpoint)
+    void saveMetadata(ostream &fout);
+    bool restoreMetadata(istream &fin);
+    bool hasPageFiles();
+
+    // Condition evaluation of SELECT, SEARCH and DELETE
+    double estimateSelectivity(const Comparison &comparison);
+    double estimateIndexLookupCost(string columnName, double selectivity, bool &isBitmap);
+    AccessPath chooseAccessPath(const Condition &condition, bool fetchRows = true);
+    double estimatePagesHolding(double rows);
+    void filterRows(const Condition &condition, const RowConsumer &consumer, AccessPath *accessPath = nullptr);
+    vector<int> findRows(const Condition &condition, AccessPath *accessPath = nullptr);
+    void fetchRows(vector<int> rowIds, const RowConsumer &consumer);
 
     /**
      * @brief Static function that takes a vector of valued and prints them out in a
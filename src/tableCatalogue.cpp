@@ -80,10 +80,134 @@ void TableCatalogue::print()
     printRowCount(rowCount);
 }
 
+// Catalog of the last checkpoint and the format it is written in
+static const string CATALOG_FILE_NAME = "../data/temp/catalog";
+static const uint CATALOG_MAGIC = 0x52414354;
+static const uint CATALOG_VERSION = 3;
+
+/**
+ * @brief Writes the catalog: a header with the format version and the block
+ * size the pages were written with, then the entry of every table (see
+ * Table::saveMetadata). It is written to a temporary file first and renamed
+ * over the old one, so a crash leaves either catalog intact.
+ *
+ * @return true if the catalog was written
+ */
+bool TableCatalogue::checkpoint()
+{
+    logger.log("TableCatalogue::checkpoint");
+    vector<Table *> tables;
+    for (auto table : this->tables)
+        if (table.second != nullptr)
+            tables.push_back(table.second);
+
+    string tempFileName = CATALOG_FILE_NAME + ".tmp";
+    ofstream fout(tempFileName, ios::out | ios::trunc | ios::binary);
+    writeCatalogValue(fout, CATALOG_MAGIC);
+    writeCatalogValue(fout, CATALOG_VERSION);
+    writeCatalogValue(fout, BLOCK_SIZE);
+    writeCatalogValue<uint>(fout, tables.size());
+    for (Table *table : tables)
+        table->saveMetadata(fout);
+    fout.close();
+    if (!fout || rename(tempFileName.c_str(), CATALOG_FILE_NAME.c_str()) != 0)
+    {
+        cout << "Error: Could not write the catalog" << endl;
+        remove(tempFileName.c_str());
+        return false;
+    }
+    this->checkpointed = true;
+    return true;
+}
+
+/**
+ * @brief Reattaches the tables of the last checkpoint at startup. Only the
+ * catalog is read; pages, B+ trees and column segments are used where they
+ * are. A table whose pages have gone missing is left out.
+ *
+ * @return false if there is no usable catalog, in which case the caller
+ * starts from an empty temp directory
+ */
+bool TableCatalogue::restore()
+{
+    logger.log("TableCatalogue::restore");
+    ifstream fin(CATALOG_FILE_NAME, ios::in | ios::binary);
+    if (!fin)
+        return false;
+    uint magic, version, tableCount;
+    float blockSize;
+    if (!readCatalogValue(fin, magic) || magic != CATALOG_MAGIC || !readCatalogValue(fin, version) ||
+        version != CATALOG_VERSION || !readCatalogValue(fin, blockSize) || blockSize != BLOCK_SIZE ||
+        !readCatalogValue(fin, tableCount))
+    {
+        cout << "Catalog was written by another version or block size, starting empty" << endl;
+        return false;
+    }
+
+    vector<Table *> tables;
+    bool restored = true;
+    try
+    {
+        for (uint tableCounter = 0; restored && tableCounter < tableCount; tableCounter++)
+        {
+            tables.push_back(new Table());
+            restored = tables.back()->restoreMetadata(fin);
+        }
+    }
+    catch (const exception &e)
+    {
+        restored = false;
+    }
+    if (!restored)
+    {
+        cout << "Catalog is corrupt, starting empty" << endl;
+        for (Table *table : tables)
+            delete table;
+        return false;
+    }
+
+    for (Table *table : tables)
+    {
+        if (!table->hasPageFiles())
+        {
+            cout << "Pages of " << table->tableName << " are missing, leaving it out" << endl;
+            delete table;
+            continue;
+        }
+        this->insertTable(table);
+    }
+    this->checkpointed = true;
+    cout << "Restored " << this->tables.size() << " tables from the last checkpoint" << endl;
+    return true;
+}
+
+/**
+ * @brief Deletes the catalog once the tables have changed since it was
+ * written, so that a crash before the next checkpoint can't reattach pages
+ * the catalog doesn't describe.
+ *
+ */
+void TableCatalogue::invalidateCheckpoint()
+{
+    if (!this->checkpointed)
+        return;
+    logger.log("TableCatalogue::invalidateCheckpoint");
+    remove(CATALOG_FILE_NAME.c_str());
+    this->checkpointed = false;
+}
+
+/**
+ * @brief Tables described by the catalog keep their files for the next start,
+ * all others are unloaded.
+ *
+ */
 TableCatalogue::~TableCatalogue(){
     logger.log("TableCatalogue::~TableCatalogue"); 
     for(auto table: this->tables){
-        table.second->unload();
+        if (table.second == nullptr)
+            continue;
+        if (!this->checkpointed)
+            table.second->unload();
         delete table.second;
     }
 }
@@ -10,6 +10,8 @@ class TableCatalogue
 {
 
     unordered_map<string, Table*> tables;
+    // Set while the catalog file describes the tables as they are
+    bool checkpointed = false;
 
 public:
     TableCatalogue() {}
@@ -19,6 +21,9 @@ public:
     bool isTable(string tableName);
     bool isColumnFromTable(string columnName, string tableName);
     void print();
+    bool checkpoint();
+    bool restore();
+    void invalidateCheckpoint();
     ~TableCatalogue();
 };
 
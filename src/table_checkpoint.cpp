@@ -0,0 +1,156 @@
+#include "global.h"
+
+/**
+ * @brief File contains what the Table class writes to and reads from the
+ * catalog (see TableCatalogue::checkpoint): the schema, the block bookkeeping,
+ * the column statistics and histograms, the zone maps and the index
+ * descriptors. The pages stay where they are in ../data/temp, so reattaching a
+ * table reads none of them.
+ *
+ * Only the descriptors of indexes are written: B+ trees are already in their
+ * own files and are loaded from there when they are first searched, bitmap
+ * indexes are rebuilt from the table the first time they are used.
+ */
+
+/**
+ * @brief Writes the table's entry of the catalog. B+ trees in memory are saved
+ * to their files as well, INSERT changes them without doing so.
+ *
+ * @param fout
+ */
+void Table::saveMetadata(ostream &fout)
+{
+    logger.log("Table::saveMetadata");
+    writeCatalogString(fout, this->tableName);
+    writeCatalogString(fout, this->sourceFileName);
+    writeCatalogValue<uint>(fout, this->columnCount);
+    for (const string &columnName : this->columns)
+        writeCatalogString(fout, columnName);
+    writeCatalogValue(fout, this->rowCount);
+    writeCatalogValue(fout, this->blockCount);
+    writeCatalogValue(fout, this->maxRowsPerBlock);
+    writeCatalogVector(fout, this->rowsPerBlockCount);
+    for (const ColumnStatistics &statistics : this->columnStatistics)
+    {
+        statistics.distinctValues.save(fout);
+        writeCatalogValue(fout, statistics.minValue);
+        writeCatalogValue(fout, statistics.maxValue);
+        writeCatalogValue(fout, statistics.nullCount);
+        statistics.histogram.save(fout);
+    }
+    writeCatalogValue<int>(fout, this->pageLayout);
+    writeCatalogVector(fout, this->sortedColumnIndexes);
+    writeCatalogVector(fout, vector<uint8_t>(this->sortedDescending.begin(), this->sortedDescending.end()));
+
+    writeCatalogValue<unsigned long long>(fout, this->pageZones.size());
+    for (const PageZone &zone : this->pageZones)
+    {
+        writeCatalogValue(fout, zone.rowCount);
+        writeCatalogVector(fout, zone.minValues);
+        writeCatalogVector(fout, zone.maxValues);
+        zone.bloomFilter.save(fout);
+    }
+
+    vector<IndexInfo *> indexes;
+    for (auto &index : this->indices)
+        if (index.second != nullptr)
+            indexes.push_back(index.second);
+    writeCatalogValue<uint>(fout, indexes.size());
+    for (IndexInfo *indexInfo : indexes)
+    {
+        writeCatalogString(fout, indexInfo->columnName);
+        writeCatalogValue<int>(fout, indexInfo->strategy);
+        if (indexInfo->bPlusTreeIndex != nullptr && !indexInfo->bPlusTreeIndex->saveToDisk())
+            cout << "Error: Could not save the B+ tree index on " << this->tableName << "." << indexInfo->columnName << endl;
+    }
+    writeCatalogValue(fout, this->indexed);
+    writeCatalogString(fout, this->indexedColumn);
+    writeCatalogValue<int>(fout, this->indexingStrategy);
+}
+
+/**
+ * @brief Reads an entry written by saveMetadata into a table made with the
+ * default constructor.
+ *
+ * @param fin
+ * @return false if the entry is truncated or inconsistent
+ */
+bool Table::restoreMetadata(istream &fin)
+{
+    logger.log("Table::restoreMetadata");
+    int pageLayout, indexingStrategy;
+    uint indexCount;
+    unsigned long long zoneCount;
+    vector<uint8_t> sortedDescending;
+    if (!readCatalogString(fin, this->tableName) || !readCatalogString(fin, this->sourceFileName) ||
+        !readCatalogValue(fin, this->columnCount))
+        return false;
+    this->columns.assign(this->columnCount, "");
+    for (string &columnName : this->columns)
+        if (!readCatalogString(fin, columnName))
+            return false;
+    if (!readCatalogValue(fin, this->rowCount) || !readCatalogValue(fin, this->blockCount) ||
+        !readCatalogValue(fin, this->maxRowsPerBlock) || !readCatalogVector(fin, this->rowsPerBlockCount))
+        return false;
+    this->columnStatistics.assign(this->columnCount, ColumnStatistics());
+    for (ColumnStatistics &statistics : this->columnStatistics)
+        if (!statistics.distinctValues.restore(fin) || !readCatalogValue(fin, statistics.minValue) ||
+            !readCatalogValue(fin, statistics.maxValue) || !readCatalogValue(fin, statistics.nullCount) ||
+            !statistics.histogram.restore(fin))
+            return false;
+    if (!readCatalogValue(fin, pageLayout) || !readCatalogVector(fin, this->sortedColumnIndexes) ||
+        !readCatalogVector(fin, sortedDescending) || !readCatalogValue(fin, zoneCount))
+        return false;
+    if (this->rowsPerBlockCount.size() != this->blockCount || pageLayout < ROW_LAYOUT || pageLayout > COMPRESSED_LAYOUT)
+        return false;
+    this->pageLayout = (PageLayout)pageLayout;
+    this->sortedDescending.assign(sortedDescending.begin(), sortedDescending.end());
+
+    this->pageZones.resize(min(zoneCount, (unsigned long long)this->blockCount));
+    for (unsigned long long zoneCounter = 0; zoneCounter < zoneCount; zoneCounter++)
+    {
+        PageZone zone;
+        if (!readCatalogValue(fin, zone.rowCount) || !readCatalogVector(fin, zone.minValues) ||
+            !readCatalogVector(fin, zone.maxValues) || !zone.bloomFilter.restore(fin))
+            return false;
+        if (zoneCounter < this->pageZones.size())
+            this->pageZones[zoneCounter] = zone;
+    }
+
+    if (!readCatalogValue(fin, indexCount))
+        return false;
+    for (uint indexCounter = 0; indexCounter < indexCount; indexCounter++)
+    {
+        string columnName;
+        int strategy;
+        if (!readCatalogString(fin, columnName) || !readCatalogValue(fin, strategy))
+            return false;
+        if (find(this->columns.begin(), this->columns.end(), columnName) == this->columns.end() || this->indices.count(columnName))
+            return false;
+        this->indices[columnName] = new IndexInfo(columnName, (IndexingStrategy)strategy);
+    }
+    if (!readCatalogValue(fin, this->indexed) || !readCatalogString(fin, this->indexedColumn) ||
+        !readCatalogValue(fin, indexingStrategy))
+        return false;
+    this->indexingStrategy = (IndexingStrategy)indexingStrategy;
+    return true;
+}
+
+/**
+ * @brief Checks that the files holding the table's pages are still there.
+ *
+ * @return true if the table can be read
+ */
+bool Table::hasPageFiles()
+{
+    logger.log("Table::hasPageFiles");
+    struct stat info;
+    if (this->blockCount == 0)
+        return true;
+    if (this->pageLayout != COLUMN_LAYOUT)
+        return stat(("../data/temp/" + this->tableName + "_Page" + to_string(this->blockCount - 1)).c_str(), &info) == 0;
+    for (int columnCounter = 0; columnCounter < this->columnCount; columnCounter++)
+        if (stat(getColumnFileName(this->tableName, columnCounter).c_str(), &info) != 0)
+            return false;
+    return true;
+}
@@ -0,0 +1,739 @@
+#include "global.h"
+
+/**
+ * @brief File contains the evaluation of the conditions of SELECT, SEARCH and
+ * DELETE over a table. A condition is planned before any page is read:
+ *
+ * - every comparison gets its filter kernel and its estimated selectivity,
+ *   and the children of AND and OR nodes are ordered by it.
+ * - the access path is chosen by its estimated cost in blocks read (see
+ *   Table::chooseAccessPath). If looking rows up in indexes is cheapest,
+ *   every comparison of an indexed column with a literal is looked up in its
+ *   index and its rows turned into a bitmap: the union of the value bitmaps
+ *   of a bitmap index, or the row numbers searchIndexed finds in a B+ tree. The
+ *   bitmaps of an AND are intersected and those of an OR united, so a
+ *   condition on indexed columns only is answered without reading the table
+ *   and otherwise narrows down the pages that have to be read.
+ *
+ * The table is then scanned a page at a time. Pages whose zone map (the range
+ * and a Bloom filter of every column, see Table::writePage) shows that none of
+ * their rows can qualify are skipped without being read, so range conditions
+ * on roughly ordered columns and equalities on any column read few pages even
+ * without an index. A page is evaluated
+ * on a list of row positions: an AND hands the positions that survive its
+ * most selective child on to the next one, an OR only evaluates its next
+ * child on the positions no earlier child matched, so every comparison looks
+ * at as few rows as possible and no intermediate result is materialised.
+ * A comparison of a column of a compressed page with a literal that looks at
+ * every row of the page is evaluated on the encoded column instead (see
+ * filterEncodedColumn).
+ */
+
+/**
+ * @brief One bit per row of a table.
+ *
+ */
+class RowBitmap
+{
+    vector<unsigned long long> words;
+
+public:
+    RowBitmap(long long rowCount = 0) : words((rowCount + 63) / 64, 0) {}
+
+    void set(long long row)
+    {
+        this->words[row >> 6] |= 1ULL << (row & 63);
+    }
+
+    bool test(long long row) const
+    {
+        return (this->words[row >> 6] >> (row & 63)) & 1;
+    }
+
+    void intersect(const RowBitmap &other)
+    {
+        for (uint word = 0; word < this->words.size(); word++)
+            this->words[word] &= other.words[word];
+    }
+
+    void unite(const RowBitmap &other)
+    {
+        for (uint word = 0; word < this->words.size(); word++)
+            this->words[word] |= other.words[word];
+    }
+
+    long long count() const
+    {
+        long long count = 0;
+        for (unsigned long long word : this->words)
+            count += __builtin_popcountll(word);
+        return count;
+    }
+
+    void addRows(const CompressedBitmap &rows)
+    {
+        rows.orInto(this->words.data(), this->words.size());
+    }
+
+    bool anyInRange(long long first, long long last) const
+    {
+        for (long long row = first; row < last; row++)
+        {
+            if ((row & 63) == 0 && row + 64 <= last)
+            {
+                if (this->words[row >> 6])
+                    return true;
+                row += 63;
+            }
+            else if (this->test(row))
+                return true;
+        }
+        return false;
+    }
+};
+
+/**
+ * @brief A node of a condition prepared for one table. If hasRows is set,
+ * rows holds every row that satisfies the node, or a superset of them if
+ * exact isn't set.
+ *
+ */
+struct ConditionPlan
+{
+    ConditionType type = COMPARISON_CONDITION;
+    ScanFilterFunction filter = nullptr;
+    BinaryOperator binaryOperator = NO_BINOP_CLAUSE;
+    int firstColumnIndex = -1;
+    int secondColumnIndex = -1;
+    int intLiteral = 0;
+    double selectivity = 1;
+    bool hasRows = false;
+    bool exact = false;
+    RowBitmap rows;
+    vector<ConditionPlan> children;
+};
+
+/**
+ * @brief Estimated fraction of the rows of the table that satisfy a
+ * comparison, from the column statistics. Equality selects one distinct value
+ * of the column, or more if the histogram shows the value to be frequent. A
+ * range comparison with a literal selects the rows the histogram puts on its
+ * side of the literal, or without a histogram the part of the column's range
+ * of values it covers, taking the values to be spread evenly; a literal
+ * outside the range selects all rows or none. Range comparisons of two
+ * columns select a third of the rows.
+ *
+ * @param comparison
+ * @return double
+ */
+double Table::estimateSelectivity(const Comparison &comparison)
+{
+    logger.log("Table::estimateSelectivity");
+    double equalSelectivity = 0.1;
+    int firstColumnIndex = this->getColumnIndex(comparison.firstColumnName);
+    uint distinctValues = this->getDistinctValueCount(firstColumnIndex);
+    if (comparison.compareColumns)
+        distinctValues = max(distinctValues, this->getDistinctValueCount(this->getColumnIndex(comparison.secondColumnName)));
+    if (distinctValues > 0)
+        equalSelectivity = 1.0 / distinctValues;
+
+    const ColumnStatistics *statistics = nullptr;
+    if (!comparison.compareColumns && firstColumnIndex >= 0 && firstColumnIndex < (int)this->columnStatistics.size() &&
+        !this->columnStatistics[firstColumnIndex].isEmpty())
+        statistics = &this->columnStatistics[firstColumnIndex];
+    if (statistics)
+    {
+        double lowest = statistics->minValue, highest = statistics->maxValue, literal = comparison.intLiteral;
+        double width = highest - lowest + 1;
+        bool outside = literal < lowest || literal > highest;
+        const EquiDepthHistogram &histogram = statistics->histogram;
+        if (!histogram.isEmpty())
+            equalSelectivity = max(equalSelectivity, histogram.fractionEqual(comparison.intLiteral));
+        if (!histogram.isEmpty() && !outside)
+            switch (comparison.binaryOperator)
+            {
+            case LESS_THAN:
+                return histogram.fractionBelow(comparison.intLiteral, false);
+            case LEQ:
+                return histogram.fractionBelow(comparison.intLiteral, true);
+            case GREATER_THAN:
+                return 1 - histogram.fractionBelow(comparison.intLiteral, true);
+            case GEQ:
+                return 1 - histogram.fractionBelow(comparison.intLiteral, false);
+            default:
+                break;
+            }
+        switch (comparison.binaryOperator)
+        {
+        case EQUAL:
+            return outside ? 0 : equalSelectivity;
+        case NOT_EQUAL:
+            return outside ? 1 : 1 - equalSelectivity;
+        case LESS_THAN:
+            return min(1.0, max(0.0, (literal - lowest) / width));
+        case LEQ:
+            return min(1.0, max(0.0, (literal - lowest + 1) / width));
+        case GREATER_THAN:
+            return min(1.0, max(0.0, (highest - literal) / width));
+        case GEQ:
+            return min(1.0, max(0.0, (highest - literal + 1) / width));
+        default:
+            break;
+        }
+    }
+
+    switch (comparison.binaryOperator)
+    {
+    case EQUAL:
+        return equalSelectivity;
+    case NOT_EQUAL:
+        return 1 - equalSelectivity;
+    default:
+        return 1.0 / 3;
+    }
+}
+
+/**
+ * @brief Prepares a condition for evaluation. Comparisons are only looked up
+ * in the indexes of their columns if lookUpIndexes is set.
+ *
+ */
+static void planCondition(Table *table, const Condition &condition, ConditionPlan &plan, bool lookUpIndexes)
+{
+    plan.type = condition.type;
+    if (condition.type == COMPARISON_CONDITION)
+    {
+        const Comparison &comparison = condition.comparison;
+        plan.firstColumnIndex = table->getColumnIndex(comparison.firstColumnName);
+        if (comparison.compareColumns)
+            plan.secondColumnIndex = table->getColumnIndex(comparison.secondColumnName);
+        plan.intLiteral = comparison.intLiteral;
+        plan.binaryOperator = comparison.binaryOperator;
+        plan.filter = getScanFilter(comparison.binaryOperator, comparison.compareColumns);
+        plan.selectivity = table->estimateSelectivity(comparison);
+        if (!lookUpIndexes || comparison.compareColumns)
+            return;
+        BitmapIndex *bitmapIndex = table->getBitmapIndex(comparison.firstColumnName);
+        if (bitmapIndex)
+        {
+            // The union of the bitmaps of the qualifying values, a word at a time
+            plan.rows = RowBitmap(table->rowCount);
+            for (const CompressedBitmap *bitmap : bitmapIndex->lookup(comparison.binaryOperator, comparison.intLiteral))
+                plan.rows.addRows(*bitmap);
+            plan.hasRows = plan.exact = true;
+            if (table->rowCount > 0)
+                plan.selectivity = (double)plan.rows.count() / table->rowCount;
+        }
+        else if (table->isIndexed(comparison.firstColumnName))
+        {
+            plan.rows = RowBitmap(table->rowCount);
+            for (int rowId : table->searchIndexed(comparison.firstColumnName, comparison.intLiteral, comparison.binaryOperator))
+                if (rowId >= 0 && rowId < table->rowCount)
+                    plan.rows.set(rowId);
+            plan.hasRows = plan.exact = true;
+            if (table->rowCount > 0)
+                plan.selectivity = (double)plan.rows.count() / table->rowCount;
+        }
+        return;
+    }
+
+    plan.children.resize(condition.children.size());
+    bool isAnd = condition.type == AND_CONDITION;
+    double selectivity = 1;
+    plan.exact = true;
+    plan.hasRows = !isAnd;
+    for (uint childIndex = 0; childIndex < condition.children.size(); childIndex++)
+    {
+        ConditionPlan &child = plan.children[childIndex];
+        planCondition(table, condition.children[childIndex], child, lookUpIndexes);
+        selectivity *= isAnd ? child.selectivity : 1 - child.selectivity;
+        plan.exact = plan.exact && child.exact;
+        if (!isAnd)
+            plan.hasRows = plan.hasRows && child.hasRows;
+        else if (child.hasRows && !plan.hasRows)
+        {
+            plan.rows = child.rows;
+            plan.hasRows = true;
+        }
+        else if (child.hasRows)
+            plan.rows.intersect(child.rows);
+    }
+    plan.selectivity = isAnd ? selectivity : 1 - selectivity;
+    if (!isAnd && plan.hasRows)
+    {
+        plan.rows = RowBitmap(table->rowCount);
+        for (const ConditionPlan &child : plan.children)
+            plan.rows.unite(child.rows);
+    }
+    if (plan.hasRows && table->rowCount > 0)
+        plan.selectivity = min(plan.selectivity, (double)plan.rows.count() / table->rowCount);
+
+    // An AND hands its rows to the most selective child first, an OR to the
+    // child that matches the most rows
+    stable_sort(plan.children.begin(), plan.children.end(), [isAnd](const ConditionPlan &a, const ConditionPlan &b)
+                { return isAnd ? a.selectivity < b.selectivity : a.selectivity > b.selectivity; });
+}
+
+/**
+ * @brief Whether any row of a page with the given zone map entry may satisfy
+ * the condition, judging by the ranges of the compared columns and, for an
+ * equality with a literal, the column's Bloom filter.
+ *
+ */
+static bool zoneMayMatch(const ConditionPlan &plan, const PageZone &zone)
+{
+    if (plan.type != COMPARISON_CONDITION)
+    {
+        bool isAnd = plan.type == AND_CONDITION;
+        for (const ConditionPlan &child : plan.children)
+            if (zoneMayMatch(child, zone) != isAnd)
+                return !isAnd;
+        return isAnd;
+    }
+    int low = zone.minValues[plan.firstColumnIndex];
+    int high = zone.maxValues[plan.firstColumnIndex];
+    int otherLow = plan.intLiteral, otherHigh = plan.intLiteral;
+    if (plan.secondColumnIndex >= 0)
+    {
+        otherLow = zone.minValues[plan.secondColumnIndex];
+        otherHigh = zone.maxValues[plan.secondColumnIndex];
+    }
+    switch (plan.binaryOperator)
+    {
+    case LESS_THAN:
+        return low < otherHigh;
+    case GREATER_THAN:
+        return high > otherLow;
+    case LEQ:
+        return low <= otherHigh;
+    case GEQ:
+        return high >= otherLow;
+    case EQUAL:
+        if (plan.secondColumnIndex < 0 && (plan.intLiteral < low || plan.intLiteral > high))
+            return false;
+        if (plan.secondColumnIndex < 0)
+            return zone.bloomFilter.mayContain(plan.firstColumnIndex, plan.intLiteral);
+        return low <= otherHigh && otherLow <= high;
+    case NOT_EQUAL:
+        return !(low == high && otherLow == otherHigh && low == otherLow);
+    default:
+        return true;
+    }
+}
+
+/**
+ * @brief Evaluates a planned condition on the rows of one page.
+ *
+ */
+class ConditionEvaluator
+{
+    const vector<vector<int>> *rows = nullptr;
+    const vector<EncodedColumn> *encodedColumns = nullptr;
+    long long pageStart = 0;
+    vector<int> firstValues, secondValues;
+    vector<uint> selection;
+
+    void evaluateComparison(const ConditionPlan &plan, vector<uint> &positions)
+    {
+        uint count = positions.size();
+        if (plan.secondColumnIndex < 0 && this->encodedColumns && !this->encodedColumns->empty())
+        {
+            const EncodedColumn &column = (*this->encodedColumns)[plan.firstColumnIndex];
+            if (column.count > 0 && column.count == count)
+            {
+                // Positions are ascending, so all of them means all rows
+                positions.resize(filterEncodedColumn(column, plan.binaryOperator, plan.intLiteral, positions.data()));
+                return;
+            }
+        }
+        for (uint position = 0; position < count; position++)
+        {
+            const vector<int> &row = (*this->rows)[positions[position]];
+            this->firstValues[position] = row[plan.firstColumnIndex];
+            if (plan.secondColumnIndex >= 0)
+                this->secondValues[position] = row[plan.secondColumnIndex];
+        }
+        uint selected = plan.filter(this->firstValues.data(), this->secondValues.data(), plan.intLiteral, count, this->selection.data());
+        for (uint position = 0; position < selected; position++)
+            positions[position] = positions[this->selection[position]];
+        positions.resize(selected);
+    }
+
+    void evaluateDisjunction(const ConditionPlan &plan, vector<uint> &positions)
+    {
+        vector<uint> remaining = positions, matched, childPositions, unmatched;
+        for (const ConditionPlan &child : plan.children)
+        {
+            if (remaining.empty())
+                break;
+            childPositions = remaining;
+            this->evaluate(child, childPositions);
+            matched.insert(matched.end(), childPositions.begin(), childPositions.end());
+            unmatched.clear();
+            set_difference(remaining.begin(), remaining.end(), childPositions.begin(), childPositions.end(), back_inserter(unmatched));
+            remaining.swap(unmatched);
+        }
+        sort(matched.begin(), matched.end());
+        positions.swap(matched);
+    }
+
+public:
+    ConditionEvaluator(uint maxRowsPerBlock) : firstValues(maxRowsPerBlock), secondValues(maxRowsPerBlock), selection(maxRowsPerBlock) {}
+
+    void setPage(const vector<vector<int>> &rows, long long pageStart, const vector<EncodedColumn> *encodedColumns = nullptr)
+    {
+        this->rows = &rows;
+        this->pageStart = pageStart;
+        this->encodedColumns = encodedColumns;
+    }
+
+    /**
+     * @brief Keeps the positions (ascending row positions within the page)
+     * that satisfy the condition.
+     *
+     */
+    void evaluate(const ConditionPlan &plan, vector<uint> &positions)
+    {
+        if (plan.hasRows)
+        {
+            uint kept = 0;
+            for (uint position : positions)
+                if (plan.rows.test(this->pageStart + position))
+                    positions[kept++] = position;
+            positions.resize(kept);
+            if (plan.exact)
+                return;
+        }
+        if (plan.type == COMPARISON_CONDITION)
+            this->evaluateComparison(plan, positions);
+        else if (plan.type == OR_CONDITION)
+            this->evaluateDisjunction(plan, positions);
+        else
+            for (const ConditionPlan &child : plan.children)
+            {
+                if (positions.empty())
+                    break;
+                if (!child.exact)
+                    this->evaluate(child, positions);
+            }
+    }
+};
+
+double AccessPath::getCost() const
+{
+    switch (this->method)
+    {
+    case ZONE_MAP_SCAN:
+        return this->zoneMapScanCost;
+    case INDEX_SCAN:
+    case BITMAP_SCAN:
+        return this->indexScanCost;
+    default:
+        return this->fullScanCost;
+    }
+}
+
+string getAccessMethodName(AccessMethod method)
+{
+    static const string methodNames[] = {"full scan", "zone-map scan", "index scan", "bitmap scan"};
+    return methodNames[method];
+}
+
+string AccessPath::toString() const
+{
+    return getAccessMethodName(this->method) + ", about " + to_string((long long)ceil(this->getCost())) + " of " +
+           to_string((long long)this->fullScanCost) + " blocks read, about " + to_string(llround(this->estimatedRows)) + " rows";
+}
+
+/**
+ * @brief Estimated blocks read to look up the rows of a column that satisfy a
+ * comparison of the given selectivity in its index. A B+ tree is descended
+ * and the leaf entries (a key and a row number) of the rows read, after the
+ * tree is read from its file if it isn't in memory. The bitmaps of the
+ * qualifying values of a bitmap index are read, after the index is built
+ * with a scan of the table if it is missing or stale.
+ *
+ * @param columnName
+ * @param selectivity
+ * @param isBitmap set if the index is a bitmap index
+ * @return double -1 if the column has no index
+ */
+double Table::estimateIndexLookupCost(string columnName, double selectivity, bool &isBitmap)
+{
+    logger.log("Table::estimateIndexLookupCost");
+    auto it = this->indices.find(columnName);
+    bool hasIndexInfo = it != this->indices.end() && it->second != nullptr;
+    if (!hasIndexInfo && !(this->indexed && this->indexedColumn == columnName))
+        return -1;
+    double blockBytes = BLOCK_SIZE * 1000;
+    double rows = selectivity * this->rowCount;
+    isBitmap = hasIndexInfo && it->second->strategy == BITMAP;
+    if (isBitmap)
+    {
+        BitmapIndex *index = it->second->bitmapIndex;
+        if (index == nullptr || index->rowCount != this->rowCount)
+            return this->blockCount + ceil(rows / 8 / blockBytes);
+        return ceil(index->sizeInBytes() * selectivity / blockBytes);
+    }
+    double entryBytes = 2 * sizeof(int);
+    double loadCost = hasIndexInfo && it->second->bPlusTreeIndex != nullptr ? 0 : ceil(this->rowCount * entryBytes / blockBytes);
+    return loadCost + 1 + ceil(rows * entryBytes / blockBytes);
+}
+
+/**
+ * @brief Expected number of pages holding at least one of the given number of
+ * rows, if they are spread at random over the pages (Cardenas' formula).
+ *
+ * @param rows
+ * @return double
+ */
+double Table::estimatePagesHolding(double rows)
+{
+    double pages = this->blockCount;
+    if (pages == 0 || rows <= 0)
+        return 0;
+    return pages * (1 - pow(1 - 1 / pages, rows));
+}
+
+/**
+ * @brief Estimated fraction of the rows that the indexes narrow a planned
+ * condition down to: the comparisons of indexed columns with a literal, the
+ * indexed children of an AND, an OR only if all of its children are. The
+ * cost of every lookup planCondition would make is added to lookupCost.
+ *
+ * @return double -1 if the indexes don't narrow the condition down
+ */
+static double estimateIndexedSelectivity(Table *table, const ConditionPlan &plan, double &lookupCost, bool &usesBPlusTree, bool &exact)
+{
+    if (plan.type == COMPARISON_CONDITION)
+    {
+        bool isBitmap = false;
+        double cost = plan.secondColumnIndex >= 0 ? -1 : table->estimateIndexLookupCost(table->columns[plan.firstColumnIndex], plan.selectivity, isBitmap);
+        if (cost < 0)
+        {
+            exact = false;
+            return -1;
+        }
+        lookupCost += cost;
+        usesBPlusTree = usesBPlusTree || !isBitmap;
+        return plan.selectivity;
+    }
+    bool isAnd = plan.type == AND_CONDITION;
+    bool narrowed = !isAnd;
+    double selectivity = 1;
+    for (const ConditionPlan &child : plan.children)
+    {
+        double childSelectivity = estimateIndexedSelectivity(table, child, lookupCost, usesBPlusTree, exact);
+        if (childSelectivity < 0)
+            narrowed = narrowed && isAnd;
+        else
+        {
+            narrowed = narrowed || isAnd;
+            selectivity *= isAnd ? childSelectivity : 1 - childSelectivity;
+        }
+    }
+    if (!narrowed)
+        return -1;
+    return isAnd ? selectivity : 1 - selectivity;
+}
+
+/**
+ * @brief Plans the condition and chooses how to find its rows by the blocks
+ * each way is estimated to read:
+ *
+ * - a full scan reads every page.
+ * - a zone-map scan reads the pages whose zone maps don't rule the condition
+ *   out, which needs no I/O to count.
+ * - an index or bitmap scan pays for its lookups (see
+ *   estimateIndexLookupCost), then reads the pages holding the rows they
+ *   find: of the qualifying rows spread at random over the pages, the number
+ *   of pages expected to hold at least one (Cardenas' formula), but never
+ *   more than the zone maps leave. If the indexes answer the condition on
+ *   their own and the rows themselves aren't wanted, no page is read.
+ *
+ * A scan wins ties, so the indexes are only used if they read fewer blocks.
+ * plan is then planned again with the lookups if lookUpIndexes is set.
+ *
+ */
+static AccessPath planAccessPath(Table *table, const Condition &condition, bool fetchRows, ConditionPlan &plan, bool lookUpIndexes)
+{
+    planCondition(table, condition, plan, false);
+    AccessPath path;
+    path.estimatedRows = plan.selectivity * table->rowCount;
+    path.fullScanCost = table->blockCount;
+    for (uint pageIndex = 0; pageIndex < table->blockCount; pageIndex++)
+    {
+        const PageZone *zone = table->getPageZone(pageIndex);
+        if (!zone || (zone->rowCount > 0 && zoneMayMatch(plan, *zone)))
+            path.zoneMapScanCost++;
+    }
+    path.method = path.zoneMapScanCost < path.fullScanCost ? ZONE_MAP_SCAN : FULL_SCAN;
+
+    double lookupCost = 0;
+    bool usesBPlusTree = false, exact = true;
+    double indexedSelectivity = estimateIndexedSelectivity(table, plan, lookupCost, usesBPlusTree, exact);
+    if (indexedSelectivity < 0)
+        return path;
+    double dataPages = min(table->estimatePagesHolding(indexedSelectivity * table->rowCount), path.zoneMapScanCost);
+    path.indexScanCost = lookupCost + (exact && !fetchRows ? 0 : dataPages);
+    if (path.indexScanCost >= path.zoneMapScanCost)
+        return path;
+    path.method = usesBPlusTree ? INDEX_SCAN : BITMAP_SCAN;
+    if (lookUpIndexes)
+    {
+        plan = ConditionPlan();
+        planCondition(table, condition, plan, true);
+        path.estimatedRows = plan.selectivity * table->rowCount;
+    }
+    return path;
+}
+
+/**
+ * @brief Chooses the access path filterRows, or findRows if fetchRows isn't
+ * set, would take for the condition, without looking anything up in the
+ * indexes.
+ *
+ * @param condition
+ * @param fetchRows
+ * @return AccessPath
+ */
+AccessPath Table::chooseAccessPath(const Condition &condition, bool fetchRows)
+{
+    logger.log("Table::chooseAccessPath");
+    ConditionPlan plan;
+    return planAccessPath(this, condition, fetchRows, plan, false);
+}
+
+/**
+ * @brief Plans the condition and passes the number of every qualifying row
+ * to consumer in ascending order, along with the row itself if fetchRows is
+ * set. Without it, a condition answered by indexes alone reads no page. The
+ * chosen access path is stored in accessPath if it is given.
+ *
+ */
+static void scanCondition(Table *table, const Condition &condition, bool fetchRows, const function<void(int rowId, const vector<int> &row)> &consumer, AccessPath *accessPath)
+{
+    OperatorScope scope("filter " + table->tableName);
+    ConditionPlan plan;
+    AccessPath path = planAccessPath(table, condition, fetchRows, plan, true);
+    if (accessPath)
+        *accessPath = path;
+    logger.log("scanCondition: " + path.toString() + (plan.hasRows ? (plan.exact ? ", answered by indexes" : ", narrowed by indexes") : ""));
+
+    static const vector<int> noRow;
+    vector<int> conditionColumns;
+    vector<string> conditionColumnNames;
+    getConditionColumns(condition, conditionColumnNames);
+    for (const string &columnName : conditionColumnNames)
+        conditionColumns.push_back(table->getColumnIndex(columnName));
+    ConditionEvaluator evaluator(table->maxRowsPerBlock);
+    vector<uint> positions;
+    long long pageStart = 0, matchedRows = 0;
+    uint skippedPages = 0;
+    for (uint pageIndex = 0; pageIndex < table->blockCount; pageIndex++)
+    {
+        long long pageEnd = pageStart + table->rowsPerBlockCount[pageIndex];
+        if (plan.hasRows && !plan.rows.anyInRange(pageStart, pageEnd))
+        {
+            pageStart = pageEnd;
+            continue;
+        }
+        const PageZone *zone = plan.exact ? nullptr : table->getPageZone(pageIndex);
+        if (zone && (zone->rowCount == 0 || !zoneMayMatch(plan, *zone)))
+        {
+            skippedPages++;
+            pageStart = pageEnd;
+            continue;
+        }
+        if (plan.exact && !fetchRows)
+        {
+            for (long long row = pageStart; row < pageEnd; row++)
+                if (plan.rows.test(row))
+                {
+                    consumer(row, noRow);
+                    matchedRows++;
+                }
+            pageStart = pageEnd;
+            continue;
+        }
+
+        // Pages in the column and compressed layouts only read the columns of
+        // the condition, and the rest of the page only if a row qualifies
+        Page page = bufferManager.getPage(table->tableName, pageIndex, conditionColumns);
+        uint rowCount = min((uint)page.getrowcount(), (uint)(pageEnd - pageStart));
+        positions.resize(rowCount);
+        for (uint position = 0; position < rowCount; position++)
+            positions[position] = position;
+        evaluator.setPage(page.rows, pageStart, &page.encodedColumns);
+        evaluator.evaluate(plan, positions);
+        if (fetchRows && !positions.empty() && table->pageLayout != ROW_LAYOUT)
+            page = bufferManager.getPage(table->tableName, pageIndex);
+        for (uint position : positions)
+            consumer(pageStart + position, page.rows[position]);
+        matchedRows += positions.size();
+        pageStart = pageEnd;
+    }
+    scope.setRows(matchedRows);
+    logger.log("scanCondition: zone maps skipped " + to_string(skippedPages) + " of " + to_string(table->blockCount) + " pages");
+}
+
+/**
+ * @brief Passes the rows of the table that satisfy condition to consumer, in
+ * table order.
+ *
+ * @param condition
+ * @param consumer
+ * @param accessPath set to the access path taken, if given
+ */
+void Table::filterRows(const Condition &condition, const RowConsumer &consumer, AccessPath *accessPath)
+{
+    logger.log("Table::filterRows");
+    scanCondition(this, condition, true, [&](int rowId, const vector<int> &row)
+                  { consumer(row); }, accessPath);
+}
+
+/**
+ * @brief Returns the numbers of the rows that satisfy condition, ascending.
+ *
+ * @param condition
+ * @param accessPath set to the access path taken, if given
+ * @return vector<int>
+ */
+vector<int> Table::findRows(const Condition &condition, AccessPath *accessPath)
+{
+    logger.log("Table::findRows");
+    vector<int> rowIds;
+    scanCondition(this, condition, false, [&](int rowId, const vector<int> &row)
+                  { rowIds.push_back(rowId); }, accessPath);
+    return rowIds;
+}
+
+/**
+ * @brief Passes the rows with the given numbers to consumer in table order,
+ * reading every page that holds one of them once.
+ *
+ * @param rowIds
+ * @param consumer
+ */
+void Table::fetchRows(vector<int> rowIds, const RowConsumer &consumer)
+{
+    logger.log("Table::fetchRows");
+    sort(rowIds.begin(), rowIds.end());
+    long long pageStart = 0;
+    uint pageIndex = 0;
+    Page page;
+    uint loadedPage = UINT_MAX;
+    for (int rowId : rowIds)
+    {
+        while (pageIndex < this->blockCount && rowId >= pageStart + this->rowsPerBlockCount[pageIndex])
+            pageStart += this->rowsPerBlockCount[pageIndex++];
+        if (rowId < pageStart || pageIndex >= this->blockCount)
+            continue;
+        if (loadedPage != pageIndex)
+        {
+            page = bufferManager.getPage(this->tableName, pageIndex);
+            loadedPage = pageIndex;
+        }
+        consumer(page.rows[rowId - pageStart]);
+    }
+}
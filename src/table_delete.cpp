@@ -7,6 +7,8 @@
  */
 void Table::deleteRows(const vector<int>& rowIndices) {
     logger.log("Table::deleteRows");
+    OperatorScope scope("delete from " + this->tableName);
+    scope.setRows(rowIndices.size());
     
     if (rowIndices.empty()) {
         cout << "No rows to delete" << endl;
@@ -54,6 +56,8 @@ void Table::deleteRows(const vector<int>& rowIndices) {
         // Load the block
         Page page = bufferManager.getPage(this->tableName, blockIndex);
         vector<vector<int>> rows = page.getAllRows();
+        // Pages read from disk are padded to maxRowsPerBlock rows
+        rows.resize(page.getrowcount());
         
         // Delete rows from this block
         for (int localRowIndex : localRowIndices) {
@@ -64,7 +68,7 @@ void Table::deleteRows(const vector<int>& rowIndices) {
         
         // Update the block
         this->rowsPerBlockCount[blockIndex] = rows.size();
-        bufferManager.writePage(this->tableName, blockIndex, rows, rows.size());
+        this->writePage(blockIndex, rows, rows.size());
     }
     
     // Update the total row count
@@ -96,6 +100,8 @@ void Table::rebalanceBlocks() {
     for (int blockIndex = 0; blockIndex < this->blockCount; blockIndex++) {
         Page page = bufferManager.getPage(this->tableName, blockIndex);
         vector<vector<int>> rows = page.getAllRows();
+        // Pages read from disk are padded to maxRowsPerBlock rows
+        rows.resize(page.getrowcount());
         allRows.insert(allRows.end(), rows.begin(), rows.end());
         totalRows += rows.size();
     }
@@ -105,7 +111,9 @@ void Table::rebalanceBlocks() {
     if (newBlockCount == 0) newBlockCount = 1;  // Always have at least one block
     
     // Redistribute rows across blocks
+    int oldBlockCount = this->blockCount;
     this->rowsPerBlockCount.clear();
+    this->pageZones.clear();
     this->blockCount = newBlockCount;
     
     for (int blockIndex = 0; blockIndex < newBlockCount; blockIndex++) {
@@ -116,7 +124,7 @@ void Table::rebalanceBlocks() {
         if (rowsInBlock <= 0) {
             // Empty block, just create an empty one
             vector<vector<int>> emptyBlock;
-            bufferManager.writePage(this->tableName, blockIndex, emptyBlock, 0);
+            this->writePage(blockIndex, emptyBlock, 0);
             this->rowsPerBlockCount.push_back(0);
             continue;
         }
@@ -125,9 +133,16 @@ void Table::rebalanceBlocks() {
         vector<vector<int>> blockRows(allRows.begin() + startRow, allRows.begin() + endRow);
         
         // Write the block
-        bufferManager.writePage(this->tableName, blockIndex, blockRows, rowsInBlock);
+        this->writePage(blockIndex, blockRows, rowsInBlock);
         this->rowsPerBlockCount.push_back(rowsInBlock);
     }
     
+    // Drop the pages that are no longer used (every column file of a column
+    // layout page)
+    for (int blockIndex = newBlockCount; blockIndex < oldBlockCount; blockIndex++) {
+        bufferManager.deletePage("../data/temp/" + this->tableName + "_Page" + to_string(blockIndex));
+        bufferManager.deleteFile(this->tableName, blockIndex);
+    }
+    
     cout << "Rebalanced table into " << newBlockCount << " blocks" << endl;
 }
\ No newline at end of file
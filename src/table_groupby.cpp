@@ -0,0 +1,559 @@
+#include "global.h"
+
+/**
+ * @brief File contains the physical GROUP BY operators of the Table class.
+ *
+ * Two strategies are available:
+ * - sort aggregation: externally sort the table on the grouping attributes,
+ *   combining rows of the same group into partial aggregates while sorting,
+ *   and stream the groups.
+ * - hash aggregation: keep per-group accumulators in a GroupHashTable sized to
+ *   the sort buffer and read the table once. Rows of groups that don't fit are
+ *   spilled to hash partitions on disk and aggregated recursively.
+ *
+ * - index aggregation: when grouping by a single column that has a B+ tree
+ *   index, read the rows in key order off the index and stream the groups
+ *   without writing anything but the result.
+ * - bitmap aggregation: when grouping by a single column that has a bitmap
+ *   index and every aggregate is a COUNT or over the grouping column itself,
+ *   every group follows from the cardinality of one bitmap and no row is read.
+ *
+ * Table::chooseGroupByStrategy picks the cheapest one from the distinct value
+ * statistics of the grouping columns and the layout of the index.
+ */
+
+string getGroupByStrategyName(GroupByStrategy strategy)
+{
+    static const string strategyNames[] = {"bitmap aggregate", "index aggregate", "hash aggregate", "sort aggregate"};
+    return strategyNames[strategy];
+}
+
+/**
+ * @brief Column positions and clauses of a GROUP BY query. A group is keyed by
+ * the values of all grouping columns and carries one AggregateState per
+ * aggregate; when there is a HAVING clause its aggregate comes first, followed
+ * by the RETURN aggregates. Spill partitions only keep the referenced columns,
+ * so queries over a partition use a remapped copy of this.
+ *
+ */
+struct GroupByQuery
+{
+    vector<int> groupIndexes;
+    vector<int> aggregateIndexes;
+    vector<Aggregate> aggregates;
+    bool hasHaving = false;
+    BinaryOperator binaryOperator;
+    long long havingValue;
+};
+
+// Partitioning is given up after this many levels (e.g. heavy skew)
+const uint MAX_PARTITION_DEPTH = 4;
+
+static GroupByQuery getGroupByQuery(Table *table)
+{
+    GroupByQuery query;
+    for (const string &groupAttribute : parsedQuery.groupAttributes)
+        query.groupIndexes.push_back(table->getColumnIndex(groupAttribute));
+    query.hasHaving = parsedQuery.havingAgg != NO_AGGREGATE_FUNCTION;
+    if (query.hasHaving)
+    {
+        query.aggregateIndexes.push_back(table->getColumnIndex(parsedQuery.havingAttribute));
+        query.aggregates.push_back(parsedQuery.havingAgg);
+    }
+    for (int i = 0; i < parsedQuery.returnAttributes.size(); i++)
+    {
+        query.aggregateIndexes.push_back(table->getColumnIndex(parsedQuery.returnAttributes[i]));
+        query.aggregates.push_back(parsedQuery.returnAggs[i]);
+    }
+    query.binaryOperator = parsedQuery.groupBinaryOperator;
+    query.havingValue = parsedQuery.havingValue;
+    return query;
+}
+
+/**
+ * @brief Columns a GROUP BY query reads; the only ones read from pages in the
+ * column layout.
+ *
+ */
+static vector<int> getReferencedColumns(const GroupByQuery &query)
+{
+    vector<int> columnIndexes = query.groupIndexes;
+    columnIndexes.insert(columnIndexes.end(), query.aggregateIndexes.begin(), query.aggregateIndexes.end());
+    return columnIndexes;
+}
+
+static void accumulateRow(AggregateState *states, const vector<int> &row, const GroupByQuery &query)
+{
+    for (int i = 0; i < query.aggregates.size(); i++)
+        accumulate(states[i], query.aggregates[i], row[query.aggregateIndexes[i]]);
+}
+
+/**
+ * @brief Applies the HAVING clause to a finished group and, if it qualifies,
+ * adds the result row (grouping values followed by the RETURN aggregates) to
+ * the page buffer of the result table. HAVING is compared on the 64-bit value.
+ *
+ */
+static void emitGroup(Table *resultTable, vector<vector<int>> &pageData, const int *key, const AggregateState *states, const GroupByQuery &query)
+{
+    if (states[0].count == 0)
+        return;
+    int firstReturn = 0;
+    if (query.hasHaving)
+    {
+        if (!evaluateBinOp(finalizeAggregate(states[0], query.aggregates[0]), query.havingValue, query.binaryOperator))
+            return;
+        firstReturn = 1;
+    }
+    vector<int> resultRow(key, key + query.groupIndexes.size());
+    for (int i = firstReturn; i < query.aggregates.size(); i++)
+        resultRow.push_back(narrowAggregate(finalizeAggregate(states[i], query.aggregates[i])));
+    pageData.push_back(resultRow);
+    if (pageData.size() == resultTable->maxRowsPerBlock)
+        resultTable->appendPage(pageData);
+}
+
+/**
+ * @brief Estimated block accesses of sort aggregation: reading the table,
+ * writing it out as partial aggregate rows, generating the sorted runs and the
+ * K-way merge passes. Since rows of a group are combined while sorting, a page
+ * holds at most estimatedGroups rows after run generation.
+ *
+ * @param table
+ * @param estimatedGroups
+ * @param query
+ * @return double
+ */
+static double estimateSortAggregateCost(Table *table, double estimatedGroups, const GroupByQuery &query)
+{
+    double partialRowSize = sizeof(int) * (query.groupIndexes.size() + query.aggregates.size() * PACKED_STATE_WIDTH);
+    double partialRowsPerBlock = max(1.0, floor(BLOCK_SIZE * 1000 / partialRowSize));
+    double partialBlocks = ceil(table->rowCount / partialRowsPerBlock);
+    double combinedBlocks = partialBlocks;
+    if (estimatedGroups > 0)
+        combinedBlocks *= min(1.0, estimatedGroups / partialRowsPerBlock);
+    double passes = estimateSortMergePasses(partialBlocks, getSortWorkerCount(max(1.0, partialBlocks)));
+    return table->blockCount + 3.0 * partialBlocks + 2.0 * combinedBlocks * passes + combinedBlocks;
+}
+
+/**
+ * @brief Estimated block accesses of hash aggregation. Groups are assumed to be
+ * uniformly distributed, so the fraction of rows that doesn't fit in the hash
+ * table is written out and read back once per partitioning level.
+ *
+ * @param blockCount
+ * @param estimatedGroups
+ * @param query
+ * @return double
+ */
+static double estimateHashAggregateCost(uint blockCount, double estimatedGroups, const GroupByQuery &query)
+{
+    double maxGroups = maxGroupsInBuffer(query.groupIndexes.size(), query.aggregates.size());
+    if (estimatedGroups <= maxGroups)
+        return blockCount;
+    double partitionCount = getHashPartitionCount();
+    double spilledFraction = 1.0 - maxGroups / estimatedGroups;
+    double levels = ceil(log(estimatedGroups / maxGroups) / log(partitionCount));
+    return blockCount + 2.0 * blockCount * spilledFraction * levels;
+}
+
+/**
+ * @brief One pass of hash aggregation over input. Groups that fit in the hash
+ * table are aggregated in memory; rows of any other group are projected to the
+ * grouping and aggregated columns and written to one of the hash partitions,
+ * which are aggregated recursively afterwards with a fresh hash seed.
+ *
+ * The groups held in memory are emitted in order of their keys, followed by
+ * those of each partition in turn, so the output is only in key order as a
+ * whole if nothing spilled.
+ *
+ * @return true if some rows were written to a partition
+ */
+static bool hashAggregate(Table *input, const GroupByQuery &query, Table *resultTable, vector<vector<int>> &pageData, uint depth)
+{
+    logger.log("hashAggregate");
+    if (input->blockCount == 0)
+        return false;
+
+    uint keyWidth = query.groupIndexes.size();
+    uint stateWidth = query.aggregates.size();
+    // The hash table and the partitioning of every level get seeds of their
+    // own: were a partition's table hashed like its rows were routed, all of
+    // its keys would share their low bits and fill a fraction of the slots
+    GroupHashTable groups(maxGroupsInBuffer(keyWidth, stateWidth), keyWidth, stateWidth, 2 * depth);
+    bool canSpill = depth < MAX_PARTITION_DEPTH;
+    uint partitionCount = getHashPartitionCount();
+    vector<Table *> partitions(partitionCount, nullptr);
+    vector<vector<vector<int>>> partitionPages(partitionCount);
+    vector<int> key(keyWidth);
+    bool spilled = false;
+
+    Cursor cursor = input->getCursor(getReferencedColumns(query));
+    vector<int> row = cursor.getNext();
+    while (!row.empty())
+    {
+        for (uint column = 0; column < keyWidth; column++)
+            key[column] = row[query.groupIndexes[column]];
+        AggregateState *states = groups.find(key.data());
+        if (!states && (!canSpill || !groups.isFull()))
+            states = groups.insert(key.data());
+
+        if (states)
+            accumulateRow(states, row, query);
+        else
+        {
+            spilled = true;
+            uint partition = hashGroupKey(key.data(), keyWidth, 2 * depth + 1) % partitionCount;
+            if (!partitions[partition])
+            {
+                string partitionName = input->tableName + "_HashPartition" + to_string(partition);
+                vector<string> partitionColumns;
+                for (int index : query.groupIndexes)
+                    partitionColumns.push_back(input->columns[index]);
+                for (int i = 0; i < stateWidth; i++)
+                    partitionColumns.push_back("a" + to_string(i));
+                partitions[partition] = new Table(partitionName, partitionColumns, true, 0);
+                tableCatalogue.insertTable(partitions[partition]);
+            }
+            vector<int> partitionRow = key;
+            for (int index : query.aggregateIndexes)
+                partitionRow.push_back(row[index]);
+            partitionPages[partition].push_back(partitionRow);
+            if (partitionPages[partition].size() == partitions[partition]->maxRowsPerBlock)
+                partitions[partition]->appendPage(partitionPages[partition]);
+        }
+        row = cursor.getNext();
+    }
+
+    for (uint slot : groups.getSortedSlots())
+        emitGroup(resultTable, pageData, groups.getKey(slot), groups.getStates(slot), query);
+
+    GroupByQuery partitionQuery = query;
+    for (int i = 0; i < keyWidth; i++)
+        partitionQuery.groupIndexes[i] = i;
+    for (int i = 0; i < stateWidth; i++)
+        partitionQuery.aggregateIndexes[i] = keyWidth + i;
+    for (uint partition = 0; partition < partitionCount; partition++)
+    {
+        if (!partitions[partition])
+            continue;
+        partitions[partition]->appendPage(partitionPages[partition]);
+        logger.log("hashAggregate: partition " + partitions[partition]->tableName + " has " + to_string(partitions[partition]->rowCount) + " rows");
+        hashAggregate(partitions[partition], partitionQuery, resultTable, pageData, depth + 1);
+        tableCatalogue.deleteTable(partitions[partition]->tableName);
+    }
+    return spilled;
+}
+
+/**
+ * @brief GROUP BY using hash aggregation. The table is read once; only the rows
+ * of groups that don't fit in the buffer are written to disk.
+ *
+ * @param resultTable
+ * @return true if the groups were written in ascending order of their keys,
+ * i.e. none were spilled to partitions
+ */
+bool Table::hashGroupBy(Table *resultTable)
+{
+    logger.log("Table::hashGroupBy");
+    GroupByQuery query = getGroupByQuery(this);
+    vector<vector<int>> pageData;
+    bool spilled = hashAggregate(this, query, resultTable, pageData, 0);
+    resultTable->appendPage(pageData);
+    return !spilled;
+}
+
+/**
+ * @brief Combine hook for sortTable: folds the partial aggregate states of row
+ * into those of into. Both rows hold the grouping key followed by one packed
+ * state per aggregate.
+ *
+ */
+static void combinePartialRows(vector<int> &into, const vector<int> &row, const GroupByQuery &query)
+{
+    uint keyWidth = query.groupIndexes.size();
+    for (int i = 0; i < query.aggregates.size(); i++)
+    {
+        int offset = keyWidth + i * PACKED_STATE_WIDTH;
+        AggregateState state = unpackAggregateState(&into[offset]);
+        mergeAggregateState(state, unpackAggregateState(&row[offset]), query.aggregates[i]);
+        packAggregateState(state, &into[offset]);
+    }
+}
+
+/**
+ * @brief GROUP BY using sort aggregation. Every row is projected to its
+ * grouping key and a partial aggregate state per aggregate, and the projected
+ * table is externally sorted on the key with combinePartialRows as the combine
+ * hook. Rows of a group are therefore collapsed as soon as they meet, during
+ * run generation or any merge, and the sorted output holds one row per group.
+ *
+ * @param resultTable
+ */
+void Table::sortGroupBy(Table *resultTable)
+{
+    logger.log("Table::sortGroupBy");
+    if (this->blockCount == 0)
+        return;
+
+    GroupByQuery query = getGroupByQuery(this);
+    uint keyWidth = query.groupIndexes.size();
+    uint stateWidth = query.aggregates.size();
+
+    vector<string> partialColumns = parsedQuery.groupAttributes;
+    for (uint i = 0; i < stateWidth * PACKED_STATE_WIDTH; i++)
+        partialColumns.push_back("s" + to_string(i));
+    Table *partials = new Table(this->tableName + "_GroupBySort", partialColumns, true, 0);
+    tableCatalogue.insertTable(partials);
+
+    vector<vector<int>> pageData;
+    vector<int> partialRow(partialColumns.size());
+    Cursor cursor = this->getCursor(getReferencedColumns(query));
+    vector<int> row = cursor.getNext();
+    while (!row.empty())
+    {
+        for (uint column = 0; column < keyWidth; column++)
+            partialRow[column] = row[query.groupIndexes[column]];
+        for (uint i = 0; i < stateWidth; i++)
+        {
+            AggregateState state;
+            accumulate(state, query.aggregates[i], row[query.aggregateIndexes[i]]);
+            packAggregateState(state, &partialRow[keyWidth + i * PACKED_STATE_WIDTH]);
+        }
+        pageData.push_back(partialRow);
+        if (pageData.size() == partials->maxRowsPerBlock)
+            partials->appendPage(pageData);
+        row = cursor.getNext();
+    }
+    partials->appendPage(pageData);
+
+    parsedQuery.sortColumns = parsedQuery.groupAttributes;
+    parsedQuery.sortStrategy.assign(parsedQuery.groupAttributes.size(), ASC);
+    partials->sortTable(false, [&query](vector<int> &into, const vector<int> &row)
+                        { combinePartialRows(into, row, query); });
+    logger.log("Table::sortGroupBy: " + to_string(this->rowCount) + " rows combined into " + to_string(partials->rowCount) + " groups");
+
+    vector<AggregateState> states(stateWidth);
+    Cursor partialCursor = partials->getCursor();
+    row = partialCursor.getNext();
+    while (!row.empty())
+    {
+        for (uint i = 0; i < stateWidth; i++)
+            states[i] = unpackAggregateState(&row[keyWidth + i * PACKED_STATE_WIDTH]);
+        emitGroup(resultTable, pageData, row.data(), states.data(), query);
+        row = partialCursor.getNext();
+    }
+    resultTable->appendPage(pageData);
+    tableCatalogue.deleteTable(partials->tableName);
+}
+
+/**
+ * @brief GROUP BY on a single column using its B+ tree index. The rows arrive
+ * in key order from indexScan, so a group is complete as soon as the key
+ * changes and only one group's accumulators are held in memory.
+ *
+ * @param resultTable
+ * @param index B+ tree index on the grouping column
+ * @return false if the index was out of date, in which case resultTable is
+ * left empty
+ */
+bool Table::indexGroupBy(Table *resultTable, BPlusTree *index)
+{
+    logger.log("Table::indexGroupBy");
+    GroupByQuery query = getGroupByQuery(this);
+    int groupIndex = query.groupIndexes[0];
+    vector<AggregateState> states(query.aggregates.size());
+    vector<vector<int>> pageData;
+    bool inGroup = false;
+    int key = 0;
+    bool scanned = this->indexScan(index, groupIndex, false, [&](const vector<int> &row)
+                                   {
+        if (inGroup && row[groupIndex] != key)
+        {
+            emitGroup(resultTable, pageData, &key, states.data(), query);
+            states.assign(query.aggregates.size(), AggregateState());
+        }
+        key = row[groupIndex];
+        inGroup = true;
+        accumulateRow(states.data(), row, query); });
+    if (!scanned)
+    {
+        movePages({}, resultTable);
+        return false;
+    }
+    if (inGroup)
+        emitGroup(resultTable, pageData, &key, states.data(), query);
+    resultTable->appendPage(pageData);
+    return true;
+}
+
+/**
+ * @brief Whether the aggregates can be computed from a value and its row count
+ * alone: COUNT of any column, or any aggregate of the grouping column.
+ *
+ */
+static bool isCountedByBitmap(const GroupByQuery &query)
+{
+    for (int i = 0; i < query.aggregates.size(); i++)
+        if (query.aggregates[i] != COUNT && query.aggregateIndexes[i] != query.groupIndexes[0])
+            return false;
+    return true;
+}
+
+/**
+ * @brief GROUP BY on a single column using its bitmap index. Only applies when
+ * the aggregates can be computed from a value and its row count alone: COUNT
+ * of any column, or any aggregate of the grouping column.
+ *
+ * @param resultTable
+ * @param index bitmap index on the grouping column
+ * @return false if the query needs other columns, in which case resultTable is
+ * left untouched
+ */
+bool Table::bitmapGroupBy(Table *resultTable, BitmapIndex *index)
+{
+    logger.log("Table::bitmapGroupBy");
+    GroupByQuery query = getGroupByQuery(this);
+    if (!isCountedByBitmap(query))
+        return false;
+    vector<AggregateState> states(query.aggregates.size());
+    vector<vector<int>> pageData;
+    for (const auto &valueBitmap : index->getBitmaps())
+    {
+        int key = valueBitmap.first;
+        long long count = valueBitmap.second.cardinality();
+        for (int i = 0; i < query.aggregates.size(); i++)
+        {
+            states[i].count = count;
+            if (query.aggregates[i] == COUNT)
+                states[i].result = 0;
+            else if (query.aggregates[i] == SUM || query.aggregates[i] == AVG)
+                states[i].result = key * count;
+            else
+                states[i].result = key;
+        }
+        emitGroup(resultTable, pageData, &key, states.data(), query);
+    }
+    resultTable->appendPage(pageData);
+    return true;
+}
+
+/**
+ * @brief Chooses how the GROUP BY query in parsedQuery is evaluated. Hash
+ * aggregation is chosen when the distinct value counts of the grouping columns
+ * make it cheaper than sorting; the number of groups is estimated as the
+ * product of those counts, capped at the row count. When no statistics are
+ * available hash aggregation is used since it degrades gracefully by spilling.
+ * A usable B+ tree index on a single grouping column is preferred whenever its
+ * ordered scan reads no more blocks than the cheaper of the two, and a bitmap
+ * index that answers the query on its own over everything else.
+ *
+ * @param estimatedGroups set to the estimated number of groups, 0 if unknown
+ * @param estimatedCost set to the estimated block accesses of the strategy
+ * @param useIndexes whether the indexes of the grouping column may be used
+ * @return GroupByStrategy
+ */
+GroupByStrategy Table::chooseGroupByStrategy(double &estimatedGroups, double &estimatedCost, bool useIndexes)
+{
+    logger.log("Table::chooseGroupByStrategy");
+    GroupByQuery query = getGroupByQuery(this);
+    estimatedGroups = 1;
+    for (int groupIndex : query.groupIndexes)
+    {
+        uint distinctValues = this->getDistinctValueCount(groupIndex);
+        if (distinctValues == 0)
+        {
+            estimatedGroups = 0;
+            break;
+        }
+        estimatedGroups = min(estimatedGroups * distinctValues, (double)max(1LL, this->rowCount));
+    }
+
+    double hashCost = estimateHashAggregateCost(this->blockCount, estimatedGroups, query);
+    double sortCost = estimateSortAggregateCost(this, estimatedGroups, query);
+    string groupColumn = query.groupIndexes.size() == 1 && useIndexes ? parsedQuery.groupAttributes[0] : "";
+    BPlusTree *index = groupColumn.empty() ? nullptr : this->getBPlusTree(groupColumn);
+    double indexCost = index ? this->estimateIndexScanCost(index) : -1;
+    logger.log("Table::chooseGroupByStrategy: estimated groups " + to_string(estimatedGroups) + ", hash cost " + to_string(hashCost) + ", sort cost " + to_string(sortCost) + ", index cost " + to_string(indexCost));
+
+    auto it = groupColumn.empty() ? this->indices.end() : this->indices.find(groupColumn);
+    if (it != this->indices.end() && it->second != nullptr && it->second->strategy == BITMAP && isCountedByBitmap(query))
+    {
+        // Counting a bitmap reads no page, unless the index has to be built
+        BitmapIndex *bitmapIndex = it->second->bitmapIndex;
+        estimatedCost = bitmapIndex && bitmapIndex->rowCount == this->rowCount ? 0 : this->blockCount;
+        return BITMAP_GROUP_BY;
+    }
+    if (indexCost >= 0 && (estimatedGroups == 0 || indexCost <= min(hashCost, sortCost)))
+    {
+        estimatedCost = indexCost;
+        return INDEX_GROUP_BY;
+    }
+    if (estimatedGroups == 0 || hashCost <= sortCost)
+    {
+        estimatedCost = hashCost;
+        return HASH_GROUP_BY;
+    }
+    estimatedCost = sortCost;
+    return SORT_GROUP_BY;
+}
+
+/**
+ * @brief Executes the GROUP BY query in parsedQuery on this table with the
+ * strategy chooseGroupByStrategy picks. If an index turns out not to answer
+ * the query, e.g. because it is out of date or a bitmap index is asked for
+ * aggregates other than COUNT, hash or sort aggregation is chosen instead.
+ *
+ */
+void Table::groupBy()
+{
+    logger.log("Table::groupBy");
+    string newTableName = parsedQuery.groupByResultRelationName;
+    vector<string> header = parsedQuery.groupAttributes;
+    for (int i = 0; i < parsedQuery.returnAttributes.size(); i++)
+        header.push_back(parsedQuery.returnAggregates[i] + "(" + parsedQuery.returnAttributes[i] + ")");
+    Table *groupedTable = new Table(newTableName, header);
+
+    GroupByQuery query = getGroupByQuery(this);
+    double estimatedGroups, estimatedCost;
+    GroupByStrategy strategy = this->chooseGroupByStrategy(estimatedGroups, estimatedCost);
+    OperatorScope scope(getGroupByStrategyName(strategy) + " " + this->tableName);
+    BitmapIndex *bitmapIndex = strategy == BITMAP_GROUP_BY ? this->getBitmapIndex(parsedQuery.groupAttributes[0]) : nullptr;
+    BPlusTree *index = strategy == INDEX_GROUP_BY ? this->getBPlusTree(parsedQuery.groupAttributes[0]) : nullptr;
+    bool inKeyOrder = true;
+    if (bitmapIndex && this->bitmapGroupBy(groupedTable, bitmapIndex))
+        cout << "Groups counted from the bitmap index on " << parsedQuery.groupAttributes[0] << endl;
+    else if (index && this->indexGroupBy(groupedTable, index))
+        cout << "Groups read in order from the index on " << parsedQuery.groupAttributes[0] << endl;
+    else
+    {
+        if (strategy == BITMAP_GROUP_BY || strategy == INDEX_GROUP_BY)
+            strategy = this->chooseGroupByStrategy(estimatedGroups, estimatedCost, false);
+        if (strategy == HASH_GROUP_BY)
+            inKeyOrder = this->hashGroupBy(groupedTable);
+        else
+            this->sortGroupBy(groupedTable);
+    }
+    scope.setRows(groupedTable->rowCount);
+    // The sort, index and bitmap paths emit the groups in ascending order of
+    // their keys; hash aggregation only does if it did not spill
+    if (inKeyOrder)
+        for (int i = 0; i < query.groupIndexes.size(); i++)
+        {
+            groupedTable->sortedColumnIndexes.push_back(i);
+            groupedTable->sortedDescending.push_back(false);
+        }
+
+    tableCatalogue.insertTable(groupedTable);
+    if (groupedTable->rowCount)
+        groupedTable->makePermanent();
+    else
+    {
+        bufferManager.deleteFile(groupedTable->sourceFileName);
+        ofstream fout("../data/" + newTableName + ".csv", ios::out);
+        groupedTable->writeRow(header, fout);
+        fout.close();
+    }
+    groupedTable->sourceFileName = "../data/" + newTableName + ".csv";
+    logger.log("Table::groupBy - End");
+}
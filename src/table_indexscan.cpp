@@ -0,0 +1,289 @@
+#include "global.h"
+
+/**
+ * @brief File contains the ordered index scan of the Table class. The leaves of
+ * a B+ tree are chained (BPlusTreeNode::next) in key order and hold the row
+ * numbers of every key, so walking the chain yields the rows of the table in
+ * key order without sorting. ORDER BY and GROUP BY use it when it is estimated
+ * to be cheaper than sorting or hashing the table.
+ */
+
+/**
+ * @brief Walks the leaf chain of a B+ tree and returns its (key, row number)
+ * entries in ascending or descending key order. The chain only links forward,
+ * so a descending walk first collects the leaves and visits them backwards.
+ *
+ */
+class IndexEntryReader
+{
+    vector<BPlusTreeNode *> leaves;
+    BPlusTreeNode *leaf = nullptr;
+    bool descending = false;
+    int leafIndex = 0;
+    int keyIndex = 0;
+    int rowIdIndex = 0;
+
+    void moveToLeaf(BPlusTreeNode *leaf)
+    {
+        this->leaf = leaf;
+        this->keyIndex = (leaf && this->descending) ? (int)leaf->keys.size() - 1 : 0;
+        this->rowIdIndex = 0;
+    }
+
+public:
+    IndexEntryReader(BPlusTree *index, bool descending)
+    {
+        this->descending = descending;
+        BPlusTreeNode *first = index->getFirstLeaf();
+        if (!descending)
+        {
+            this->moveToLeaf(first);
+            return;
+        }
+        for (BPlusTreeNode *node = first; node; node = node->next)
+            this->leaves.push_back(node);
+        this->leafIndex = (int)this->leaves.size() - 1;
+        this->moveToLeaf(this->leafIndex >= 0 ? this->leaves[this->leafIndex] : nullptr);
+    }
+
+    bool next(int &key, int &rowId)
+    {
+        while (this->leaf)
+        {
+            if (this->keyIndex >= 0 && this->keyIndex < this->leaf->keys.size())
+            {
+                if (this->keyIndex < this->leaf->rowIds.size() && this->rowIdIndex < this->leaf->rowIds[this->keyIndex].size())
+                {
+                    key = this->leaf->keys[this->keyIndex];
+                    rowId = this->leaf->rowIds[this->keyIndex][this->rowIdIndex++];
+                    return true;
+                }
+                this->keyIndex += this->descending ? -1 : 1;
+                this->rowIdIndex = 0;
+                continue;
+            }
+            if (this->descending)
+            {
+                this->leafIndex--;
+                this->moveToLeaf(this->leafIndex >= 0 ? this->leaves[this->leafIndex] : nullptr);
+            }
+            else
+                this->moveToLeaf(this->leaf->next);
+        }
+        return false;
+    }
+};
+
+/**
+ * @brief Number of rows before every page of the table, i.e. the row number of
+ * its first row, used to find the page of an indexed row number.
+ *
+ */
+vector<long long> Table::getPageStarts()
+{
+    vector<long long> pageStarts(this->blockCount);
+    long long rowCount = 0;
+    for (uint pageIndex = 0; pageIndex < this->blockCount; pageIndex++)
+    {
+        pageStarts[pageIndex] = rowCount;
+        rowCount += this->rowsPerBlockCount[pageIndex];
+    }
+    return pageStarts;
+}
+
+static uint getPageOfRow(const vector<long long> &pageStarts, int rowId)
+{
+    return upper_bound(pageStarts.begin(), pageStarts.end(), (long long)rowId) - pageStarts.begin() - 1;
+}
+
+/**
+ * @brief Rows an index scan fetches per batch. A batch is held in memory, so
+ * it gets the same budget as the external sort.
+ *
+ */
+static uint getIndexScanBatchSize(Table *table)
+{
+    return max(1u, SORT_BUFFER_BLOCKS * table->maxRowsPerBlock);
+}
+
+/**
+ * @brief Returns the B+ tree index on a column, loading it from disk if it
+ * isn't in memory.
+ *
+ * @param columnName
+ * @return BPlusTree* nullptr if the column has no B+ tree index
+ */
+BPlusTree *Table::getBPlusTree(string columnName)
+{
+    logger.log("Table::getBPlusTree");
+    auto it = this->indices.find(columnName);
+    if (it != this->indices.end() && it->second != nullptr)
+    {
+        IndexInfo *indexInfo = it->second;
+        if (indexInfo->strategy != BTREE)
+            return nullptr;
+        if (indexInfo->bPlusTreeIndex == nullptr)
+        {
+            indexInfo->bPlusTreeIndex = new BPlusTree(4, this->tableName, columnName);
+            if (!indexInfo->bPlusTreeIndex->loadFromDisk())
+            {
+                delete indexInfo->bPlusTreeIndex;
+                indexInfo->bPlusTreeIndex = nullptr;
+            }
+        }
+        return indexInfo->bPlusTreeIndex;
+    }
+    if (this->indexed && this->indexedColumn == columnName && this->indexingStrategy == BTREE)
+        return this->bPlusTreeIndex;
+    return nullptr;
+}
+
+/**
+ * @brief Walks the leaf chain of index once and records on it the distinct
+ * pages referenced by every batch of row numbers an index scan takes off it.
+ * This is computed exactly from the index, which is in memory, without
+ * reading any page. It is about the table's block count for a clustered index
+ * and grows towards one access per row as the index order and the page order
+ * diverge.
+ *
+ * The walk also checks that the index covers every row of the table exactly
+ * once in non-decreasing key order, since an index that is out of date can't
+ * be scanned.
+ *
+ * @param index
+ */
+void Table::updateIndexScanStatistics(BPlusTree *index)
+{
+    logger.log("Table::updateIndexScanStatistics");
+    vector<long long> pageStarts = this->getPageStarts();
+    uint batchSize = getIndexScanBatchSize(this);
+    vector<bool> seen(this->rowCount, false);
+    vector<long long> lastBatchOfPage(this->blockCount, -1);
+    IndexEntryReader reader(index, false);
+    long long entryCount = 0;
+    int key, rowId, previousKey = INT_MIN;
+    index->scanRowCount = this->rowCount;
+    index->scanBatchSize = batchSize;
+    index->scanCoversTable = false;
+    index->scanBatchPageReads.clear();
+    while (reader.next(key, rowId))
+    {
+        if (rowId < 0 || rowId >= this->rowCount || seen[rowId] || key < previousKey)
+            return;
+        seen[rowId] = true;
+        previousKey = key;
+        uint pageIndex = getPageOfRow(pageStarts, rowId);
+        long long batch = entryCount / batchSize;
+        if (batch == (long long)index->scanBatchPageReads.size())
+            index->scanBatchPageReads.push_back(0);
+        if (lastBatchOfPage[pageIndex] != batch)
+        {
+            lastBatchOfPage[pageIndex] = batch;
+            index->scanBatchPageReads[batch]++;
+        }
+        entryCount++;
+    }
+    index->scanCoversTable = entryCount == this->rowCount;
+}
+
+/**
+ * @brief Estimated block accesses of indexScan, from the page reads per batch
+ * recorded by updateIndexScanStatistics. They are recorded again first if the
+ * index or the row count of the table changed since.
+ *
+ * @param index
+ * @param limit only the first limit rows are read if not negative
+ * @return double -1 if the index can't be used
+ */
+double Table::estimateIndexScanCost(BPlusTree *index, long long limit)
+{
+    logger.log("Table::estimateIndexScanCost");
+    if (index->scanRowCount != this->rowCount || index->scanBatchSize != getIndexScanBatchSize(this))
+        this->updateIndexScanStatistics(index);
+    if (!index->scanCoversTable)
+        return -1;
+    long long scannedRows = limit >= 0 ? min(limit, this->rowCount) : this->rowCount;
+    long long fullBatches = scannedRows / index->scanBatchSize;
+    double pageReads = 0;
+    for (long long batch = 0; batch < fullBatches; batch++)
+        pageReads += index->scanBatchPageReads[batch];
+    // Pages of a batch that is only partly scanned are assumed to be spread
+    // evenly over its rows
+    if (scannedRows % index->scanBatchSize && fullBatches < (long long)index->scanBatchPageReads.size())
+    {
+        long long batchRows = min((long long)index->scanBatchSize, this->rowCount - fullBatches * index->scanBatchSize);
+        pageReads += ceil(index->scanBatchPageReads[fullBatches] * (double)(scannedRows % index->scanBatchSize) / batchRows);
+    }
+    return pageReads;
+}
+
+/**
+ * @brief Passes the rows of the table to consumer in the order of the indexed
+ * column. Row numbers are taken off the leaf chain of index in batches of the
+ * sort buffer's size; the rows of a batch are fetched page by page, so every
+ * page is read at most once per batch, and then handed on in key order.
+ *
+ * Every fetched row is checked against its index key. If the index turns out
+ * to be out of date the scan stops and returns false, after some rows may
+ * already have been consumed.
+ *
+ * @param index B+ tree index on the column at columnIndex
+ * @param columnIndex
+ * @param descending
+ * @param consumer
+ * @param limit only the first limit rows are read if not negative
+ * @return true if all rows were scanned
+ */
+bool Table::indexScan(BPlusTree *index, int columnIndex, bool descending, const RowConsumer &consumer, long long limit)
+{
+    logger.log("Table::indexScan");
+    vector<long long> pageStarts = this->getPageStarts();
+    uint batchSize = getIndexScanBatchSize(this);
+    IndexEntryReader reader(index, descending);
+    vector<int> keys, rowIds;
+    vector<uint> fetchOrder;
+    vector<vector<int>> rows(batchSize);
+    long long scannedRows = 0;
+    int key, rowId;
+    while (limit < 0 || scannedRows < limit)
+    {
+        keys.clear();
+        rowIds.clear();
+        while (rowIds.size() < batchSize && (limit < 0 || scannedRows + (long long)rowIds.size() < limit) && reader.next(key, rowId))
+        {
+            if (rowId < 0 || rowId >= this->rowCount)
+                return false;
+            keys.push_back(key);
+            rowIds.push_back(rowId);
+        }
+        if (rowIds.empty())
+            break;
+
+        fetchOrder.resize(rowIds.size());
+        for (uint position = 0; position < rowIds.size(); position++)
+            fetchOrder[position] = position;
+        sort(fetchOrder.begin(), fetchOrder.end(), [&](uint a, uint b)
+             { return rowIds[a] < rowIds[b]; });
+        Page page;
+        uint loadedPage = UINT_MAX;
+        for (uint position : fetchOrder)
+        {
+            uint pageIndex = getPageOfRow(pageStarts, rowIds[position]);
+            if (pageIndex != loadedPage)
+            {
+                page = bufferManager.getPage(this->tableName, pageIndex);
+                loadedPage = pageIndex;
+            }
+            rows[position] = page.rows[rowIds[position] - pageStarts[pageIndex]];
+            if (rows[position][columnIndex] != keys[position])
+            {
+                logger.log("Table::indexScan: index on column " + to_string(columnIndex) + " is out of date");
+                return false;
+            }
+        }
+        for (uint position = 0; position < rowIds.size(); position++)
+            consumer(rows[position]);
+        scannedRows += rowIds.size();
+    }
+    return true;
+}
@@ -0,0 +1,116 @@
+#include "global.h"
+
+/**
+ * @brief Forgets the spans of the last trace and starts recording the ones
+ * that are written to fileName when the trace is stopped.
+ *
+ * @param fileName
+ */
+void QueryTracer::start(const string &fileName)
+{
+    logger.log("QueryTracer::start");
+    lock_guard<mutex> lock(this->eventMutex);
+    this->fileName = fileName;
+    this->events.clear();
+    this->threadIds.assign(1, this_thread::get_id());
+    this->startTime = chrono::steady_clock::now();
+    this->enabled = true;
+}
+
+/**
+ * @brief Microseconds since the trace started.
+ *
+ */
+long long QueryTracer::now() const
+{
+    return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - this->startTime).count();
+}
+
+/**
+ * @brief Records a span that started at start and ends now. Threads are
+ * numbered in the order they record their first span, the server's own
+ * thread being 0.
+ *
+ * @param name
+ * @param category
+ * @param start microseconds since the trace started, see now()
+ * @param detail shown with the span in the viewer
+ */
+void QueryTracer::record(const string &name, const string &category, long long start, const string &detail)
+{
+    long long end = this->now();
+    lock_guard<mutex> lock(this->eventMutex);
+    if (!this->enabled)
+        return;
+    thread::id id = this_thread::get_id();
+    uint threadId = find(this->threadIds.begin(), this->threadIds.end(), id) - this->threadIds.begin();
+    if (threadId == this->threadIds.size())
+        this->threadIds.push_back(id);
+    this->events.push_back({name, category, threadId, start, end - start, detail});
+}
+
+static string escapeJSON(const string &value)
+{
+    string escaped;
+    for (char c : value)
+    {
+        if (c == '"' || c == '\\')
+            escaped += '\\';
+        if ((unsigned char)c < 0x20)
+            escaped += ' ';
+        else
+            escaped += c;
+    }
+    return escaped;
+}
+
+/**
+ * @brief Stops recording and writes the trace to its file.
+ *
+ * @return true if the file was written
+ */
+bool QueryTracer::stop()
+{
+    logger.log("QueryTracer::stop");
+    lock_guard<mutex> lock(this->eventMutex);
+    if (!this->enabled)
+        return false;
+    this->enabled = false;
+    ofstream fout(this->fileName, ios::trunc);
+    if (!fout.is_open())
+        return false;
+    fout << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [" << endl;
+    fout << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 0, \"args\": {\"name\": \"server\"}}";
+    for (uint threadId = 1; threadId < this->threadIds.size(); threadId++)
+        fout << "," << endl
+             << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << threadId << ", \"args\": {\"name\": \"worker " << threadId << "\"}}";
+    for (const TraceEvent &event : this->events)
+    {
+        fout << "," << endl
+             << "{\"name\": \"" << escapeJSON(event.name) << "\", \"cat\": \"" << event.category << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": "
+             << event.threadId << ", \"ts\": " << event.start << ", \"dur\": " << event.duration;
+        if (!event.detail.empty())
+            fout << ", \"args\": {\"detail\": \"" << escapeJSON(event.detail) << "\"}";
+        fout << "}";
+    }
+    fout << endl << "]}" << endl;
+    fout.close();
+    this->events.clear();
+    return (bool)fout;
+}
+
+TraceSpan::TraceSpan(const string &name, const string &category, const string &detail)
+{
+    if (!queryTracer.isEnabled())
+        return;
+    this->name = name;
+    this->category = category;
+    this->detail = detail;
+    this->start = queryTracer.now();
+}
+
+TraceSpan::~TraceSpan()
+{
+    if (this->start >= 0)
+        queryTracer.record(this->name, this->category, this->start, this->detail);
+}
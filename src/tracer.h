@@ -0,0 +1,75 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief One span of a trace: what ran, on which thread, from when and for
+ * how long, in microseconds since the trace started.
+ *
+ */
+struct TraceEvent
+{
+    string name;
+    string category;
+    uint threadId;
+    long long start;
+    long long duration;
+    string detail;
+};
+
+/**
+ * @brief Records spans while TRACE ON is in effect and writes them in the
+ * Chrome trace-event format (complete "X" events), which chrome://tracing and
+ * Perfetto open. The commands are spanned by their parse, semantic check and
+ * execution, the operators by their OperatorScope and every page read from or
+ * written to disk by the buffer manager. Spans may be recorded from the sort
+ * workers, so recording is locked; while tracing is off it costs a check of a
+ * flag.
+ *
+ */
+class QueryTracer
+{
+    atomic<bool> enabled{false};
+    string fileName;
+    chrono::steady_clock::time_point startTime;
+    vector<TraceEvent> events;
+    vector<thread::id> threadIds;
+    mutex eventMutex;
+
+public:
+    void start(const string &fileName);
+    bool stop();
+    bool isEnabled() const { return this->enabled; }
+    const string &getFileName() const { return this->fileName; }
+    long long now() const;
+    void record(const string &name, const string &category, long long start, const string &detail = "");
+};
+
+/**
+ * @brief Records the enclosing block as a span if tracing is on, e.g.
+ * TraceSpan span("parse", "command"). The name and detail are only copied
+ * when it is.
+ *
+ */
+class TraceSpan
+{
+    string name;
+    string category;
+    long long start = -1;
+
+public:
+    string detail;
+
+    TraceSpan(const string &name, const string &category, const string &detail = "");
+    ~TraceSpan();
+};
+
+#endif // TRACER_H